@@ -0,0 +1,317 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "class Tree {\n"
+    "  init(item, depth) {\n"
+    "    this.item = item;\n"
+    "    this.depth = depth;\n"
+    "    if (depth > 0) {\n"
+    "      var item2 = item + item;\n"
+    "      depth = depth - 1;\n"
+    "      this.left = Tree(item2 - 1, depth);\n"
+    "      this.right = Tree(item2, depth);\n"
+    "    } else {\n"
+    "      this.left = nil;\n"
+    "      this.right = nil;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  check() {\n"
+    "    if (this.left == nil) {\n"
+    "      return this.item;\n"
+    "    }\n"
+    "\n"
+    "    return this.item + this.left.check() - this.right.check();\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "var minDepth = 4;\n"
+    "var maxDepth = 14;\n"
+    "var stretchDepth = maxDepth + 1;\n"
+    "\n"
+    "var start = clock();\n"
+    "\n"
+    "print \"stretch tree of depth:\";\n"
+    "print stretchDepth;\n"
+    "print \"check:\";\n"
+    "print Tree(0, stretchDepth).check();\n"
+    "\n"
+    "var longLivedTree = Tree(0, maxDepth);\n"
+    "\n"
+    "// iterations = 2 ** maxDepth\n"
+    "var iterations = 1;\n"
+    "var d = 0;\n"
+    "while (d < maxDepth) {\n"
+    "  iterations = iterations * 2;\n"
+    "  d = d + 1;\n"
+    "}\n"
+    "\n"
+    "var depth = minDepth;\n"
+    "while (depth < stretchDepth) {\n"
+    "  var check = 0;\n"
+    "  var i = 1;\n"
+    "  while (i <= iterations) {\n"
+    "    check = check + Tree(i, depth).check() + Tree(-i, depth).check();\n"
+    "    i = i + 1;\n"
+    "  }\n"
+    "\n"
+    "  print \"num trees:\";\n"
+    "  print iterations * 2;\n"
+    "  print \"depth:\";\n"
+    "  print depth;\n"
+    "  print \"check:\";\n"
+    "  print check;\n"
+    "\n"
+    "  iterations = iterations / 4;\n"
+    "  depth = depth + 2;\n"
+    "}\n"
+    "\n"
+    "print \"long lived tree of depth:\";\n"
+    "print maxDepth;\n"
+    "print \"check:\";\n"
+    "print longLivedTree.check();\n"
+    "print \"elapsed:\";\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  sp--;
+  *sp++ = constants[7];
+  AOT_RUN(19, jitDefineGlobal(AOT_STRING(6)));
+  *sp++ = constants[9];
+  AOT_RUN(23, jitDefineGlobal(AOT_STRING(8)));
+  AOT_CHECK(25, jitGetGlobal(AOT_STRING(11)));
+  *sp++ = constants[12];
+  AOT_BINARY_OP(28, NUMBER_VAL, +, OP_ADD);
+  AOT_RUN(30, jitDefineGlobal(AOT_STRING(10)));
+  AOT_CHECK(32, jitGetGlobal(AOT_STRING(14)));
+  AOT_CHECK(34, aotCall(0));
+  AOT_RUN(36, jitDefineGlobal(AOT_STRING(13)));
+  *sp++ = constants[15];
+  AOT_RUN(39, jitPrint());
+  AOT_CHECK(41, jitGetGlobal(AOT_STRING(16)));
+  AOT_RUN(42, jitPrint());
+  *sp++ = constants[17];
+  AOT_RUN(45, jitPrint());
+  AOT_CHECK(47, jitGetGlobal(AOT_STRING(18)));
+  *sp++ = constants[19];
+  AOT_CHECK(51, jitGetGlobal(AOT_STRING(20)));
+  AOT_CHECK(53, aotCall(2));
+  AOT_CHECK(56, aotInvoke(AOT_STRING(21), 0));
+  AOT_RUN(57, jitPrint());
+  AOT_CHECK(59, jitGetGlobal(AOT_STRING(23)));
+  *sp++ = constants[24];
+  AOT_CHECK(63, jitGetGlobal(AOT_STRING(25)));
+  AOT_CHECK(65, aotCall(2));
+  AOT_RUN(67, jitDefineGlobal(AOT_STRING(22)));
+  *sp++ = constants[27];
+  AOT_RUN(71, jitDefineGlobal(AOT_STRING(26)));
+  *sp++ = constants[29];
+  AOT_RUN(75, jitDefineGlobal(AOT_STRING(28)));
+l75:
+  AOT_CHECK(77, jitGetGlobal(AOT_STRING(30)));
+  AOT_CHECK(79, jitGetGlobal(AOT_STRING(31)));
+  AOT_JUMP_UNLESS(82, <, l102);
+  AOT_CHECK(84, jitGetGlobal(AOT_STRING(33)));
+  *sp++ = constants[34];
+  AOT_BINARY_OP(87, NUMBER_VAL, *, OP_MULTIPLY);
+  AOT_CHECK(89, jitSetGlobal(AOT_STRING(32)));
+  sp--;
+  AOT_CHECK(92, jitGetGlobal(AOT_STRING(36)));
+  *sp++ = constants[37];
+  AOT_BINARY_OP(95, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(97, jitSetGlobal(AOT_STRING(35)));
+  sp--;
+  goto l75;
+l102:
+  sp--;
+  AOT_CHECK(105, jitGetGlobal(AOT_STRING(39)));
+  AOT_RUN(107, jitDefineGlobal(AOT_STRING(38)));
+l107:
+  AOT_CHECK(109, jitGetGlobal(AOT_STRING(40)));
+  AOT_CHECK(111, jitGetGlobal(AOT_STRING(41)));
+  AOT_JUMP_UNLESS(114, <, l214);
+  *sp++ = constants[42];
+  *sp++ = constants[43];
+l118:
+  *sp++ = slots[2];
+  AOT_CHECK(122, jitGetGlobal(AOT_STRING(44)));
+  AOT_BINARY_OP(123, BOOL_VAL, >, OP_GREATER);
+  sp[-1] = BOOL_VAL(AOT_FALSEY(sp[-1]));
+  if (AOT_FALSEY(sp[-1])) goto l170;
+  sp--;
+  *sp++ = slots[1];
+  AOT_CHECK(132, jitGetGlobal(AOT_STRING(45)));
+  *sp++ = slots[2];
+  AOT_CHECK(136, jitGetGlobal(AOT_STRING(46)));
+  AOT_CHECK(138, aotCall(2));
+  AOT_CHECK(141, aotInvoke(AOT_STRING(47), 0));
+  AOT_BINARY_OP(142, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(144, jitGetGlobal(AOT_STRING(48)));
+  *sp++ = slots[2];
+  AOT_NEGATE(147);
+  AOT_CHECK(149, jitGetGlobal(AOT_STRING(49)));
+  AOT_CHECK(151, aotCall(2));
+  AOT_CHECK(154, aotInvoke(AOT_STRING(50), 0));
+  AOT_BINARY_OP(155, NUMBER_VAL, +, OP_ADD);
+  slots[1] = sp[-1];
+  sp--;
+  *sp++ = slots[2];
+  *sp++ = constants[51];
+  AOT_BINARY_OP(163, NUMBER_VAL, +, OP_ADD);
+  slots[2] = sp[-1];
+  sp--;
+  goto l118;
+l170:
+  sp--;
+  *sp++ = constants[52];
+  AOT_RUN(174, jitPrint());
+  AOT_CHECK(176, jitGetGlobal(AOT_STRING(53)));
+  *sp++ = constants[54];
+  AOT_BINARY_OP(179, NUMBER_VAL, *, OP_MULTIPLY);
+  AOT_RUN(180, jitPrint());
+  *sp++ = constants[55];
+  AOT_RUN(183, jitPrint());
+  AOT_CHECK(185, jitGetGlobal(AOT_STRING(56)));
+  AOT_RUN(186, jitPrint());
+  *sp++ = constants[57];
+  AOT_RUN(189, jitPrint());
+  *sp++ = slots[1];
+  AOT_RUN(192, jitPrint());
+  AOT_CHECK(194, jitGetGlobal(AOT_STRING(59)));
+  *sp++ = constants[60];
+  AOT_BINARY_OP(197, NUMBER_VAL, /, OP_DIVIDE);
+  AOT_CHECK(199, jitSetGlobal(AOT_STRING(58)));
+  sp--;
+  AOT_CHECK(202, jitGetGlobal(AOT_STRING(62)));
+  *sp++ = constants[63];
+  AOT_BINARY_OP(205, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(207, jitSetGlobal(AOT_STRING(61)));
+  sp--;
+  sp--;
+  sp--;
+  goto l107;
+l214:
+  sp--;
+  *sp++ = constants[64];
+  AOT_RUN(218, jitPrint());
+  AOT_CHECK(220, jitGetGlobal(AOT_STRING(65)));
+  AOT_RUN(221, jitPrint());
+  *sp++ = constants[66];
+  AOT_RUN(224, jitPrint());
+  AOT_CHECK(226, jitGetGlobal(AOT_STRING(67)));
+  AOT_CHECK(229, aotInvoke(AOT_STRING(68), 0));
+  AOT_RUN(230, jitPrint());
+  *sp++ = constants[69];
+  AOT_RUN(233, jitPrint());
+  AOT_CHECK(235, jitGetGlobal(AOT_STRING(70)));
+  AOT_CHECK(237, aotCall(0));
+  AOT_CHECK(239, jitGetGlobal(AOT_STRING(71)));
+  AOT_BINARY_OP(240, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(241, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[1];
+  AOT_CHECK(6, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = slots[2];
+  AOT_CHECK(13, jitSetProperty(AOT_STRING(1)));
+  sp--;
+  *sp++ = slots[2];
+  *sp++ = constants[2];
+  AOT_JUMP_UNLESS(21, >, l65);
+  *sp++ = slots[1];
+  *sp++ = slots[1];
+  AOT_BINARY_OP(26, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[2];
+  *sp++ = constants[3];
+  AOT_BINARY_OP(30, NUMBER_VAL, -, OP_SUBTRACT);
+  slots[2] = sp[-1];
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(37, jitGetGlobal(AOT_STRING(5)));
+  *sp++ = slots[3];
+  *sp++ = constants[6];
+  AOT_BINARY_OP(41, NUMBER_VAL, -, OP_SUBTRACT);
+  *sp++ = slots[2];
+  AOT_CHECK(45, aotCall(2));
+  AOT_CHECK(47, jitSetProperty(AOT_STRING(4)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(52, jitGetGlobal(AOT_STRING(8)));
+  *sp++ = slots[3];
+  *sp++ = slots[2];
+  AOT_CHECK(58, aotCall(2));
+  AOT_CHECK(60, jitSetProperty(AOT_STRING(7)));
+  sp--;
+  sp--;
+  goto l78;
+l65:
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = NIL_VAL;
+  AOT_CHECK(71, jitSetProperty(AOT_STRING(9)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = NIL_VAL;
+  AOT_CHECK(77, jitSetProperty(AOT_STRING(10)));
+  sp--;
+l78:
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// check
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  *sp++ = NIL_VAL;
+  AOT_JUMP_UNLESS_EQUAL(l14);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(10, AOT_STRING(1));
+  AOT_RETURN();
+  goto l15;
+l14:
+  sp--;
+l15:
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(18, AOT_STRING(2));
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(21, AOT_STRING(3));
+  AOT_CHECK(24, aotInvoke(AOT_STRING(4), 0));
+  AOT_BINARY_OP(25, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(28, AOT_STRING(5));
+  AOT_CHECK(31, aotInvoke(AOT_STRING(6), 0));
+  AOT_BINARY_OP(32, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 243 },
+  { function1, 81 },
+  { function2, 35 },
+};
+
+int main() {
+  return aotMain(source, functions, 3);
+}
@@ -0,0 +1,264 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "var i = 0;\n"
+    "\n"
+    "var loopStart = clock();\n"
+    "\n"
+    "while (i < 10000000) {\n"
+    "  i = i + 1;\n"
+    "\n"
+    "  1; 1; 1; 2; 1; nil; 1; \"str\"; 1; true;\n"
+    "  nil; nil; nil; 1; nil; \"str\"; nil; true;\n"
+    "  true; true; true; 1; true; false; true; \"str\"; true; nil;\n"
+    "  \"str\"; \"str\"; \"str\"; \"stru\"; \"str\"; 1; \"str\"; nil; \"str\"; true;\n"
+    "}\n"
+    "\n"
+    "var loopTime = clock() - loopStart;\n"
+    "\n"
+    "var start = clock();\n"
+    "\n"
+    "i = 0;\n"
+    "while (i < 10000000) {\n"
+    "  i = i + 1;\n"
+    "\n"
+    "  1 == 1; 1 == 2; 1 == nil; 1 == \"str\"; 1 == true;\n"
+    "  nil == nil; nil == 1; nil == \"str\"; nil == true;\n"
+    "  true == true; true == 1; true == false; true == \"str\"; true == nil;\n"
+    "  \"str\" == \"str\"; \"str\" == \"stru\"; \"str\" == 1; \"str\" == nil; \"str\" == true;\n"
+    "}\n"
+    "\n"
+    "var elapsed = clock() - start;\n"
+    "print \"loop\";\n"
+    "print loopTime;\n"
+    "print \"elapsed\";\n"
+    "print elapsed;\n"
+    "print \"equals\";\n"
+    "print elapsed - loopTime;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  *sp++ = constants[1];
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(3)));
+  AOT_CHECK(8, aotCall(0));
+  AOT_RUN(10, jitDefineGlobal(AOT_STRING(2)));
+l10:
+  AOT_CHECK(12, jitGetGlobal(AOT_STRING(4)));
+  *sp++ = constants[5];
+  AOT_JUMP_UNLESS(17, <, l125);
+  AOT_CHECK(19, jitGetGlobal(AOT_STRING(7)));
+  *sp++ = constants[8];
+  AOT_BINARY_OP(22, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(24, jitSetGlobal(AOT_STRING(6)));
+  sp--;
+  *sp++ = constants[9];
+  sp--;
+  *sp++ = constants[10];
+  sp--;
+  *sp++ = constants[11];
+  sp--;
+  *sp++ = constants[12];
+  sp--;
+  *sp++ = constants[13];
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = constants[14];
+  sp--;
+  *sp++ = constants[15];
+  sp--;
+  *sp++ = constants[16];
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = constants[17];
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = constants[18];
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = constants[19];
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = BOOL_VAL(false);
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = constants[20];
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = constants[21];
+  sp--;
+  *sp++ = constants[22];
+  sp--;
+  *sp++ = constants[23];
+  sp--;
+  *sp++ = constants[24];
+  sp--;
+  *sp++ = constants[25];
+  sp--;
+  *sp++ = constants[26];
+  sp--;
+  *sp++ = constants[27];
+  sp--;
+  *sp++ = NIL_VAL;
+  sp--;
+  *sp++ = constants[28];
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  sp--;
+  goto l10;
+l125:
+  sp--;
+  AOT_CHECK(128, jitGetGlobal(AOT_STRING(30)));
+  AOT_CHECK(130, aotCall(0));
+  AOT_CHECK(132, jitGetGlobal(AOT_STRING(31)));
+  AOT_BINARY_OP(133, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(135, jitDefineGlobal(AOT_STRING(29)));
+  AOT_CHECK(137, jitGetGlobal(AOT_STRING(33)));
+  AOT_CHECK(139, aotCall(0));
+  AOT_RUN(141, jitDefineGlobal(AOT_STRING(32)));
+  *sp++ = constants[35];
+  AOT_CHECK(145, jitSetGlobal(AOT_STRING(34)));
+  sp--;
+l146:
+  AOT_CHECK(148, jitGetGlobal(AOT_STRING(36)));
+  *sp++ = constants[37];
+  AOT_JUMP_UNLESS(153, <, l261);
+  AOT_CHECK(155, jitGetGlobal(AOT_STRING(39)));
+  *sp++ = constants[40];
+  AOT_BINARY_OP(158, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(160, jitSetGlobal(AOT_STRING(38)));
+  sp--;
+  *sp++ = constants[41];
+  *sp++ = constants[42];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[43];
+  *sp++ = constants[44];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[45];
+  *sp++ = NIL_VAL;
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[46];
+  *sp++ = constants[47];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[48];
+  *sp++ = BOOL_VAL(true);
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = NIL_VAL;
+  *sp++ = NIL_VAL;
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = NIL_VAL;
+  *sp++ = constants[49];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = NIL_VAL;
+  *sp++ = constants[50];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = NIL_VAL;
+  *sp++ = BOOL_VAL(true);
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  *sp++ = BOOL_VAL(true);
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  *sp++ = constants[51];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  *sp++ = BOOL_VAL(false);
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  *sp++ = constants[52];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = BOOL_VAL(true);
+  *sp++ = NIL_VAL;
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[53];
+  *sp++ = constants[54];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[55];
+  *sp++ = constants[56];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[57];
+  *sp++ = constants[58];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[59];
+  *sp++ = NIL_VAL;
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  *sp++ = constants[60];
+  *sp++ = BOOL_VAL(true);
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp--;
+  goto l146;
+l261:
+  sp--;
+  AOT_CHECK(264, jitGetGlobal(AOT_STRING(62)));
+  AOT_CHECK(266, aotCall(0));
+  AOT_CHECK(268, jitGetGlobal(AOT_STRING(63)));
+  AOT_BINARY_OP(269, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(271, jitDefineGlobal(AOT_STRING(61)));
+  *sp++ = constants[64];
+  AOT_RUN(274, jitPrint());
+  AOT_CHECK(276, jitGetGlobal(AOT_STRING(65)));
+  AOT_RUN(277, jitPrint());
+  *sp++ = constants[66];
+  AOT_RUN(280, jitPrint());
+  AOT_CHECK(282, jitGetGlobal(AOT_STRING(67)));
+  AOT_RUN(283, jitPrint());
+  *sp++ = constants[68];
+  AOT_RUN(286, jitPrint());
+  AOT_CHECK(288, jitGetGlobal(AOT_STRING(69)));
+  AOT_CHECK(290, jitGetGlobal(AOT_STRING(70)));
+  AOT_BINARY_OP(291, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(292, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 294 },
+};
+
+int main() {
+  return aotMain(source, functions, 1);
+}
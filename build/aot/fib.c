@@ -0,0 +1,72 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "fun fib(n) {\n"
+    "  if (n < 2) return n;\n"
+    "  return fib(n - 2) + fib(n - 1);\n"
+    "}\n"
+    "\n"
+    "var start = clock();\n"
+    "print fib(35) == 9227465;\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClosure(AS_FUNCTION(constants[1]), code + 2));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(3)));
+  AOT_CHECK(8, aotCall(0));
+  AOT_RUN(10, jitDefineGlobal(AOT_STRING(2)));
+  AOT_CHECK(12, jitGetGlobal(AOT_STRING(4)));
+  *sp++ = constants[5];
+  AOT_CHECK(16, aotCall(1));
+  *sp++ = constants[6];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  AOT_RUN(20, jitPrint());
+  AOT_CHECK(22, jitGetGlobal(AOT_STRING(7)));
+  AOT_CHECK(24, aotCall(0));
+  AOT_CHECK(26, jitGetGlobal(AOT_STRING(8)));
+  AOT_BINARY_OP(27, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(28, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// fib
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[1];
+  *sp++ = constants[0];
+  AOT_JUMP_UNLESS(7, <, l13);
+  *sp++ = slots[1];
+  AOT_RETURN();
+  goto l14;
+l13:
+  sp--;
+l14:
+  AOT_CHECK(16, jitGetGlobal(AOT_STRING(1)));
+  *sp++ = slots[1];
+  *sp++ = constants[2];
+  AOT_BINARY_OP(20, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(22, aotCall(1));
+  AOT_CHECK(24, jitGetGlobal(AOT_STRING(3)));
+  *sp++ = slots[1];
+  *sp++ = constants[4];
+  AOT_BINARY_OP(28, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(30, aotCall(1));
+  AOT_BINARY_OP(31, NUMBER_VAL, +, OP_ADD);
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 30 },
+  { function1, 34 },
+};
+
+int main() {
+  return aotMain(source, functions, 2);
+}
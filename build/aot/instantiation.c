@@ -0,0 +1,188 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "// This benchmark stresses instance creation and initializer calling.\n"
+    "\n"
+    "class Foo {\n"
+    "  init() {}\n"
+    "}\n"
+    "\n"
+    "var start = clock();\n"
+    "var i = 0;\n"
+    "while (i < 500000) {\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  Foo();\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  sp--;
+  AOT_CHECK(13, jitGetGlobal(AOT_STRING(5)));
+  AOT_CHECK(15, aotCall(0));
+  AOT_RUN(17, jitDefineGlobal(AOT_STRING(4)));
+  *sp++ = constants[7];
+  AOT_RUN(21, jitDefineGlobal(AOT_STRING(6)));
+l21:
+  AOT_CHECK(23, jitGetGlobal(AOT_STRING(8)));
+  *sp++ = constants[9];
+  AOT_JUMP_UNLESS(28, <, l190);
+  AOT_CHECK(30, jitGetGlobal(AOT_STRING(10)));
+  AOT_CHECK(32, aotCall(0));
+  sp--;
+  AOT_CHECK(35, jitGetGlobal(AOT_STRING(11)));
+  AOT_CHECK(37, aotCall(0));
+  sp--;
+  AOT_CHECK(40, jitGetGlobal(AOT_STRING(12)));
+  AOT_CHECK(42, aotCall(0));
+  sp--;
+  AOT_CHECK(45, jitGetGlobal(AOT_STRING(13)));
+  AOT_CHECK(47, aotCall(0));
+  sp--;
+  AOT_CHECK(50, jitGetGlobal(AOT_STRING(14)));
+  AOT_CHECK(52, aotCall(0));
+  sp--;
+  AOT_CHECK(55, jitGetGlobal(AOT_STRING(15)));
+  AOT_CHECK(57, aotCall(0));
+  sp--;
+  AOT_CHECK(60, jitGetGlobal(AOT_STRING(16)));
+  AOT_CHECK(62, aotCall(0));
+  sp--;
+  AOT_CHECK(65, jitGetGlobal(AOT_STRING(17)));
+  AOT_CHECK(67, aotCall(0));
+  sp--;
+  AOT_CHECK(70, jitGetGlobal(AOT_STRING(18)));
+  AOT_CHECK(72, aotCall(0));
+  sp--;
+  AOT_CHECK(75, jitGetGlobal(AOT_STRING(19)));
+  AOT_CHECK(77, aotCall(0));
+  sp--;
+  AOT_CHECK(80, jitGetGlobal(AOT_STRING(20)));
+  AOT_CHECK(82, aotCall(0));
+  sp--;
+  AOT_CHECK(85, jitGetGlobal(AOT_STRING(21)));
+  AOT_CHECK(87, aotCall(0));
+  sp--;
+  AOT_CHECK(90, jitGetGlobal(AOT_STRING(22)));
+  AOT_CHECK(92, aotCall(0));
+  sp--;
+  AOT_CHECK(95, jitGetGlobal(AOT_STRING(23)));
+  AOT_CHECK(97, aotCall(0));
+  sp--;
+  AOT_CHECK(100, jitGetGlobal(AOT_STRING(24)));
+  AOT_CHECK(102, aotCall(0));
+  sp--;
+  AOT_CHECK(105, jitGetGlobal(AOT_STRING(25)));
+  AOT_CHECK(107, aotCall(0));
+  sp--;
+  AOT_CHECK(110, jitGetGlobal(AOT_STRING(26)));
+  AOT_CHECK(112, aotCall(0));
+  sp--;
+  AOT_CHECK(115, jitGetGlobal(AOT_STRING(27)));
+  AOT_CHECK(117, aotCall(0));
+  sp--;
+  AOT_CHECK(120, jitGetGlobal(AOT_STRING(28)));
+  AOT_CHECK(122, aotCall(0));
+  sp--;
+  AOT_CHECK(125, jitGetGlobal(AOT_STRING(29)));
+  AOT_CHECK(127, aotCall(0));
+  sp--;
+  AOT_CHECK(130, jitGetGlobal(AOT_STRING(30)));
+  AOT_CHECK(132, aotCall(0));
+  sp--;
+  AOT_CHECK(135, jitGetGlobal(AOT_STRING(31)));
+  AOT_CHECK(137, aotCall(0));
+  sp--;
+  AOT_CHECK(140, jitGetGlobal(AOT_STRING(32)));
+  AOT_CHECK(142, aotCall(0));
+  sp--;
+  AOT_CHECK(145, jitGetGlobal(AOT_STRING(33)));
+  AOT_CHECK(147, aotCall(0));
+  sp--;
+  AOT_CHECK(150, jitGetGlobal(AOT_STRING(34)));
+  AOT_CHECK(152, aotCall(0));
+  sp--;
+  AOT_CHECK(155, jitGetGlobal(AOT_STRING(35)));
+  AOT_CHECK(157, aotCall(0));
+  sp--;
+  AOT_CHECK(160, jitGetGlobal(AOT_STRING(36)));
+  AOT_CHECK(162, aotCall(0));
+  sp--;
+  AOT_CHECK(165, jitGetGlobal(AOT_STRING(37)));
+  AOT_CHECK(167, aotCall(0));
+  sp--;
+  AOT_CHECK(170, jitGetGlobal(AOT_STRING(38)));
+  AOT_CHECK(172, aotCall(0));
+  sp--;
+  AOT_CHECK(175, jitGetGlobal(AOT_STRING(39)));
+  AOT_CHECK(177, aotCall(0));
+  sp--;
+  AOT_CHECK(180, jitGetGlobal(AOT_STRING(41)));
+  *sp++ = constants[42];
+  AOT_BINARY_OP(183, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(185, jitSetGlobal(AOT_STRING(40)));
+  sp--;
+  goto l21;
+l190:
+  sp--;
+  AOT_CHECK(193, jitGetGlobal(AOT_STRING(43)));
+  AOT_CHECK(195, aotCall(0));
+  AOT_CHECK(197, jitGetGlobal(AOT_STRING(44)));
+  AOT_BINARY_OP(198, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(199, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 201 },
+  { function1, 3 },
+};
+
+int main() {
+  return aotMain(source, functions, 2);
+}
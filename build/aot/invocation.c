@@ -0,0 +1,511 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "// This benchmark stresses just method invocation.\n"
+    "\n"
+    "class Foo {\n"
+    "  method0() {}\n"
+    "  method1() {}\n"
+    "  method2() {}\n"
+    "  method3() {}\n"
+    "  method4() {}\n"
+    "  method5() {}\n"
+    "  method6() {}\n"
+    "  method7() {}\n"
+    "  method8() {}\n"
+    "  method9() {}\n"
+    "  method10() {}\n"
+    "  method11() {}\n"
+    "  method12() {}\n"
+    "  method13() {}\n"
+    "  method14() {}\n"
+    "  method15() {}\n"
+    "  method16() {}\n"
+    "  method17() {}\n"
+    "  method18() {}\n"
+    "  method19() {}\n"
+    "  method20() {}\n"
+    "  method21() {}\n"
+    "  method22() {}\n"
+    "  method23() {}\n"
+    "  method24() {}\n"
+    "  method25() {}\n"
+    "  method26() {}\n"
+    "  method27() {}\n"
+    "  method28() {}\n"
+    "  method29() {}\n"
+    "}\n"
+    "\n"
+    "var foo = Foo();\n"
+    "var start = clock();\n"
+    "var i = 0;\n"
+    "while (i < 500000) {\n"
+    "  foo.method0();\n"
+    "  foo.method1();\n"
+    "  foo.method2();\n"
+    "  foo.method3();\n"
+    "  foo.method4();\n"
+    "  foo.method5();\n"
+    "  foo.method6();\n"
+    "  foo.method7();\n"
+    "  foo.method8();\n"
+    "  foo.method9();\n"
+    "  foo.method10();\n"
+    "  foo.method11();\n"
+    "  foo.method12();\n"
+    "  foo.method13();\n"
+    "  foo.method14();\n"
+    "  foo.method15();\n"
+    "  foo.method16();\n"
+    "  foo.method17();\n"
+    "  foo.method18();\n"
+    "  foo.method19();\n"
+    "  foo.method20();\n"
+    "  foo.method21();\n"
+    "  foo.method22();\n"
+    "  foo.method23();\n"
+    "  foo.method24();\n"
+    "  foo.method25();\n"
+    "  foo.method26();\n"
+    "  foo.method27();\n"
+    "  foo.method28();\n"
+    "  foo.method29();\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  AOT_RUN(16, jitClosure(AS_FUNCTION(constants[7]), code + 16));
+  AOT_RUN(18, jitMethod(AOT_STRING(6)));
+  AOT_RUN(20, jitClosure(AS_FUNCTION(constants[9]), code + 20));
+  AOT_RUN(22, jitMethod(AOT_STRING(8)));
+  AOT_RUN(24, jitClosure(AS_FUNCTION(constants[11]), code + 24));
+  AOT_RUN(26, jitMethod(AOT_STRING(10)));
+  AOT_RUN(28, jitClosure(AS_FUNCTION(constants[13]), code + 28));
+  AOT_RUN(30, jitMethod(AOT_STRING(12)));
+  AOT_RUN(32, jitClosure(AS_FUNCTION(constants[15]), code + 32));
+  AOT_RUN(34, jitMethod(AOT_STRING(14)));
+  AOT_RUN(36, jitClosure(AS_FUNCTION(constants[17]), code + 36));
+  AOT_RUN(38, jitMethod(AOT_STRING(16)));
+  AOT_RUN(40, jitClosure(AS_FUNCTION(constants[19]), code + 40));
+  AOT_RUN(42, jitMethod(AOT_STRING(18)));
+  AOT_RUN(44, jitClosure(AS_FUNCTION(constants[21]), code + 44));
+  AOT_RUN(46, jitMethod(AOT_STRING(20)));
+  AOT_RUN(48, jitClosure(AS_FUNCTION(constants[23]), code + 48));
+  AOT_RUN(50, jitMethod(AOT_STRING(22)));
+  AOT_RUN(52, jitClosure(AS_FUNCTION(constants[25]), code + 52));
+  AOT_RUN(54, jitMethod(AOT_STRING(24)));
+  AOT_RUN(56, jitClosure(AS_FUNCTION(constants[27]), code + 56));
+  AOT_RUN(58, jitMethod(AOT_STRING(26)));
+  AOT_RUN(60, jitClosure(AS_FUNCTION(constants[29]), code + 60));
+  AOT_RUN(62, jitMethod(AOT_STRING(28)));
+  AOT_RUN(64, jitClosure(AS_FUNCTION(constants[31]), code + 64));
+  AOT_RUN(66, jitMethod(AOT_STRING(30)));
+  AOT_RUN(68, jitClosure(AS_FUNCTION(constants[33]), code + 68));
+  AOT_RUN(70, jitMethod(AOT_STRING(32)));
+  AOT_RUN(72, jitClosure(AS_FUNCTION(constants[35]), code + 72));
+  AOT_RUN(74, jitMethod(AOT_STRING(34)));
+  AOT_RUN(76, jitClosure(AS_FUNCTION(constants[37]), code + 76));
+  AOT_RUN(78, jitMethod(AOT_STRING(36)));
+  AOT_RUN(80, jitClosure(AS_FUNCTION(constants[39]), code + 80));
+  AOT_RUN(82, jitMethod(AOT_STRING(38)));
+  AOT_RUN(84, jitClosure(AS_FUNCTION(constants[41]), code + 84));
+  AOT_RUN(86, jitMethod(AOT_STRING(40)));
+  AOT_RUN(88, jitClosure(AS_FUNCTION(constants[43]), code + 88));
+  AOT_RUN(90, jitMethod(AOT_STRING(42)));
+  AOT_RUN(92, jitClosure(AS_FUNCTION(constants[45]), code + 92));
+  AOT_RUN(94, jitMethod(AOT_STRING(44)));
+  AOT_RUN(96, jitClosure(AS_FUNCTION(constants[47]), code + 96));
+  AOT_RUN(98, jitMethod(AOT_STRING(46)));
+  AOT_RUN(100, jitClosure(AS_FUNCTION(constants[49]), code + 100));
+  AOT_RUN(102, jitMethod(AOT_STRING(48)));
+  AOT_RUN(104, jitClosure(AS_FUNCTION(constants[51]), code + 104));
+  AOT_RUN(106, jitMethod(AOT_STRING(50)));
+  AOT_RUN(108, jitClosure(AS_FUNCTION(constants[53]), code + 108));
+  AOT_RUN(110, jitMethod(AOT_STRING(52)));
+  AOT_RUN(112, jitClosure(AS_FUNCTION(constants[55]), code + 112));
+  AOT_RUN(114, jitMethod(AOT_STRING(54)));
+  AOT_RUN(116, jitClosure(AS_FUNCTION(constants[57]), code + 116));
+  AOT_RUN(118, jitMethod(AOT_STRING(56)));
+  AOT_RUN(120, jitClosure(AS_FUNCTION(constants[59]), code + 120));
+  AOT_RUN(122, jitMethod(AOT_STRING(58)));
+  AOT_RUN(124, jitClosure(AS_FUNCTION(constants[61]), code + 124));
+  AOT_RUN(126, jitMethod(AOT_STRING(60)));
+  sp--;
+  AOT_CHECK(129, jitGetGlobal(AOT_STRING(63)));
+  AOT_CHECK(131, aotCall(0));
+  AOT_RUN(133, jitDefineGlobal(AOT_STRING(62)));
+  AOT_CHECK(135, jitGetGlobal(AOT_STRING(65)));
+  AOT_CHECK(137, aotCall(0));
+  AOT_RUN(139, jitDefineGlobal(AOT_STRING(64)));
+  *sp++ = constants[67];
+  AOT_RUN(143, jitDefineGlobal(AOT_STRING(66)));
+l143:
+  AOT_CHECK(145, jitGetGlobal(AOT_STRING(68)));
+  *sp++ = constants[69];
+  AOT_JUMP_UNLESS(150, <, l342);
+  AOT_CHECK(152, jitGetGlobal(AOT_STRING(70)));
+  AOT_CHECK(155, aotInvoke(AOT_STRING(71), 0));
+  sp--;
+  AOT_CHECK(158, jitGetGlobal(AOT_STRING(72)));
+  AOT_CHECK(161, aotInvoke(AOT_STRING(73), 0));
+  sp--;
+  AOT_CHECK(164, jitGetGlobal(AOT_STRING(74)));
+  AOT_CHECK(167, aotInvoke(AOT_STRING(75), 0));
+  sp--;
+  AOT_CHECK(170, jitGetGlobal(AOT_STRING(76)));
+  AOT_CHECK(173, aotInvoke(AOT_STRING(77), 0));
+  sp--;
+  AOT_CHECK(176, jitGetGlobal(AOT_STRING(78)));
+  AOT_CHECK(179, aotInvoke(AOT_STRING(79), 0));
+  sp--;
+  AOT_CHECK(182, jitGetGlobal(AOT_STRING(80)));
+  AOT_CHECK(185, aotInvoke(AOT_STRING(81), 0));
+  sp--;
+  AOT_CHECK(188, jitGetGlobal(AOT_STRING(82)));
+  AOT_CHECK(191, aotInvoke(AOT_STRING(83), 0));
+  sp--;
+  AOT_CHECK(194, jitGetGlobal(AOT_STRING(84)));
+  AOT_CHECK(197, aotInvoke(AOT_STRING(85), 0));
+  sp--;
+  AOT_CHECK(200, jitGetGlobal(AOT_STRING(86)));
+  AOT_CHECK(203, aotInvoke(AOT_STRING(87), 0));
+  sp--;
+  AOT_CHECK(206, jitGetGlobal(AOT_STRING(88)));
+  AOT_CHECK(209, aotInvoke(AOT_STRING(89), 0));
+  sp--;
+  AOT_CHECK(212, jitGetGlobal(AOT_STRING(90)));
+  AOT_CHECK(215, aotInvoke(AOT_STRING(91), 0));
+  sp--;
+  AOT_CHECK(218, jitGetGlobal(AOT_STRING(92)));
+  AOT_CHECK(221, aotInvoke(AOT_STRING(93), 0));
+  sp--;
+  AOT_CHECK(224, jitGetGlobal(AOT_STRING(94)));
+  AOT_CHECK(227, aotInvoke(AOT_STRING(95), 0));
+  sp--;
+  AOT_CHECK(230, jitGetGlobal(AOT_STRING(96)));
+  AOT_CHECK(233, aotInvoke(AOT_STRING(97), 0));
+  sp--;
+  AOT_CHECK(236, jitGetGlobal(AOT_STRING(98)));
+  AOT_CHECK(239, aotInvoke(AOT_STRING(99), 0));
+  sp--;
+  AOT_CHECK(242, jitGetGlobal(AOT_STRING(100)));
+  AOT_CHECK(245, aotInvoke(AOT_STRING(101), 0));
+  sp--;
+  AOT_CHECK(248, jitGetGlobal(AOT_STRING(102)));
+  AOT_CHECK(251, aotInvoke(AOT_STRING(103), 0));
+  sp--;
+  AOT_CHECK(254, jitGetGlobal(AOT_STRING(104)));
+  AOT_CHECK(257, aotInvoke(AOT_STRING(105), 0));
+  sp--;
+  AOT_CHECK(260, jitGetGlobal(AOT_STRING(106)));
+  AOT_CHECK(263, aotInvoke(AOT_STRING(107), 0));
+  sp--;
+  AOT_CHECK(266, jitGetGlobal(AOT_STRING(108)));
+  AOT_CHECK(269, aotInvoke(AOT_STRING(109), 0));
+  sp--;
+  AOT_CHECK(272, jitGetGlobal(AOT_STRING(110)));
+  AOT_CHECK(275, aotInvoke(AOT_STRING(111), 0));
+  sp--;
+  AOT_CHECK(278, jitGetGlobal(AOT_STRING(112)));
+  AOT_CHECK(281, aotInvoke(AOT_STRING(113), 0));
+  sp--;
+  AOT_CHECK(284, jitGetGlobal(AOT_STRING(114)));
+  AOT_CHECK(287, aotInvoke(AOT_STRING(115), 0));
+  sp--;
+  AOT_CHECK(290, jitGetGlobal(AOT_STRING(116)));
+  AOT_CHECK(293, aotInvoke(AOT_STRING(117), 0));
+  sp--;
+  AOT_CHECK(296, jitGetGlobal(AOT_STRING(118)));
+  AOT_CHECK(299, aotInvoke(AOT_STRING(119), 0));
+  sp--;
+  AOT_CHECK(302, jitGetGlobal(AOT_STRING(120)));
+  AOT_CHECK(305, aotInvoke(AOT_STRING(121), 0));
+  sp--;
+  AOT_CHECK(308, jitGetGlobal(AOT_STRING(122)));
+  AOT_CHECK(311, aotInvoke(AOT_STRING(123), 0));
+  sp--;
+  AOT_CHECK(314, jitGetGlobal(AOT_STRING(124)));
+  AOT_CHECK(317, aotInvoke(AOT_STRING(125), 0));
+  sp--;
+  AOT_CHECK(320, jitGetGlobal(AOT_STRING(126)));
+  AOT_CHECK(323, aotInvoke(AOT_STRING(127), 0));
+  sp--;
+  AOT_CHECK(326, jitGetGlobal(AOT_STRING(128)));
+  AOT_CHECK(329, aotInvoke(AOT_STRING(129), 0));
+  sp--;
+  AOT_CHECK(332, jitGetGlobal(AOT_STRING(131)));
+  *sp++ = constants[132];
+  AOT_BINARY_OP(335, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(337, jitSetGlobal(AOT_STRING(130)));
+  sp--;
+  goto l143;
+l342:
+  sp--;
+  AOT_CHECK(345, jitGetGlobal(AOT_STRING(133)));
+  AOT_CHECK(347, aotCall(0));
+  AOT_CHECK(349, jitGetGlobal(AOT_STRING(134)));
+  AOT_BINARY_OP(350, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(351, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method0
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method1
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method2
+static bool function3() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method3
+static bool function4() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method4
+static bool function5() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method5
+static bool function6() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method6
+static bool function7() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method7
+static bool function8() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method8
+static bool function9() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method9
+static bool function10() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method10
+static bool function11() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method11
+static bool function12() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method12
+static bool function13() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method13
+static bool function14() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method14
+static bool function15() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method15
+static bool function16() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method16
+static bool function17() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method17
+static bool function18() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method18
+static bool function19() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method19
+static bool function20() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method20
+static bool function21() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method21
+static bool function22() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method22
+static bool function23() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method23
+static bool function24() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method24
+static bool function25() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method25
+static bool function26() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method26
+static bool function27() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method27
+static bool function28() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method28
+static bool function29() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method29
+static bool function30() {
+  AOT_ENTER();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 353 },
+  { function1, 2 },
+  { function2, 2 },
+  { function3, 2 },
+  { function4, 2 },
+  { function5, 2 },
+  { function6, 2 },
+  { function7, 2 },
+  { function8, 2 },
+  { function9, 2 },
+  { function10, 2 },
+  { function11, 2 },
+  { function12, 2 },
+  { function13, 2 },
+  { function14, 2 },
+  { function15, 2 },
+  { function16, 2 },
+  { function17, 2 },
+  { function18, 2 },
+  { function19, 2 },
+  { function20, 2 },
+  { function21, 2 },
+  { function22, 2 },
+  { function23, 2 },
+  { function24, 2 },
+  { function25, 2 },
+  { function26, 2 },
+  { function27, 2 },
+  { function28, 2 },
+  { function29, 2 },
+  { function30, 2 },
+};
+
+int main() {
+  return aotMain(source, functions, 31);
+}
@@ -0,0 +1,373 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "class Toggle {\n"
+    "  init(startState) {\n"
+    "    this.state = startState;\n"
+    "  }\n"
+    "\n"
+    "  value() { return this.state; }\n"
+    "\n"
+    "  activate() {\n"
+    "    this.state = !this.state;\n"
+    "    return this;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "class NthToggle < Toggle {\n"
+    "  init(startState, maxCounter) {\n"
+    "    super.init(startState);\n"
+    "    this.countMax = maxCounter;\n"
+    "    this.count = 0;\n"
+    "  }\n"
+    "\n"
+    "  activate() {\n"
+    "    this.count = this.count + 1;\n"
+    "    if (this.count >= this.countMax) {\n"
+    "      super.activate();\n"
+    "      this.count = 0;\n"
+    "    }\n"
+    "\n"
+    "    return this;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "var start = clock();\n"
+    "var n = 100000;\n"
+    "var val = true;\n"
+    "var toggle = Toggle(val);\n"
+    "\n"
+    "for (var i = 0; i < n; i = i + 1) {\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "  val = toggle.activate().value();\n"
+    "}\n"
+    "\n"
+    "print toggle.value();\n"
+    "\n"
+    "val = true;\n"
+    "var ntoggle = NthToggle(val, 3);\n"
+    "\n"
+    "for (var i = 0; i < n; i = i + 1) {\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "  val = ntoggle.activate().value();\n"
+    "}\n"
+    "\n"
+    "print ntoggle.value();\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  AOT_RUN(16, jitClosure(AS_FUNCTION(constants[7]), code + 16));
+  AOT_RUN(18, jitMethod(AOT_STRING(6)));
+  sp--;
+  AOT_RUN(21, jitClass(AOT_STRING(8)));
+  AOT_RUN(23, jitDefineGlobal(AOT_STRING(8)));
+  AOT_CHECK(25, jitGetGlobal(AOT_STRING(9)));
+  AOT_CHECK(27, jitGetGlobal(AOT_STRING(10)));
+  AOT_CHECK(28, jitInherit());
+  AOT_CHECK(30, jitGetGlobal(AOT_STRING(11)));
+  AOT_RUN(34, jitClosure(AS_FUNCTION(constants[13]), code + 32));
+  AOT_RUN(36, jitMethod(AOT_STRING(12)));
+  AOT_RUN(40, jitClosure(AS_FUNCTION(constants[15]), code + 38));
+  AOT_RUN(42, jitMethod(AOT_STRING(14)));
+  sp--;
+  AOT_RUN(44, jitCloseUpvalue());
+  AOT_CHECK(46, jitGetGlobal(AOT_STRING(17)));
+  AOT_CHECK(48, aotCall(0));
+  AOT_RUN(50, jitDefineGlobal(AOT_STRING(16)));
+  *sp++ = constants[19];
+  AOT_RUN(54, jitDefineGlobal(AOT_STRING(18)));
+  *sp++ = BOOL_VAL(true);
+  AOT_RUN(57, jitDefineGlobal(AOT_STRING(20)));
+  AOT_CHECK(59, jitGetGlobal(AOT_STRING(22)));
+  AOT_CHECK(61, jitGetGlobal(AOT_STRING(23)));
+  AOT_CHECK(63, aotCall(1));
+  AOT_RUN(65, jitDefineGlobal(AOT_STRING(21)));
+  *sp++ = constants[24];
+l67:
+  *sp++ = slots[1];
+  AOT_CHECK(71, jitGetGlobal(AOT_STRING(25)));
+  AOT_JUMP_UNLESS(74, <, l203);
+  goto l89;
+l77:
+  *sp++ = slots[1];
+  *sp++ = constants[26];
+  AOT_BINARY_OP(82, NUMBER_VAL, +, OP_ADD);
+  slots[1] = sp[-1];
+  sp--;
+  goto l67;
+l89:
+  AOT_CHECK(91, jitGetGlobal(AOT_STRING(28)));
+  AOT_CHECK(94, aotInvoke(AOT_STRING(29), 0));
+  AOT_CHECK(97, aotInvoke(AOT_STRING(30), 0));
+  AOT_CHECK(99, jitSetGlobal(AOT_STRING(27)));
+  sp--;
+  AOT_CHECK(102, jitGetGlobal(AOT_STRING(32)));
+  AOT_CHECK(105, aotInvoke(AOT_STRING(33), 0));
+  AOT_CHECK(108, aotInvoke(AOT_STRING(34), 0));
+  AOT_CHECK(110, jitSetGlobal(AOT_STRING(31)));
+  sp--;
+  AOT_CHECK(113, jitGetGlobal(AOT_STRING(36)));
+  AOT_CHECK(116, aotInvoke(AOT_STRING(37), 0));
+  AOT_CHECK(119, aotInvoke(AOT_STRING(38), 0));
+  AOT_CHECK(121, jitSetGlobal(AOT_STRING(35)));
+  sp--;
+  AOT_CHECK(124, jitGetGlobal(AOT_STRING(40)));
+  AOT_CHECK(127, aotInvoke(AOT_STRING(41), 0));
+  AOT_CHECK(130, aotInvoke(AOT_STRING(42), 0));
+  AOT_CHECK(132, jitSetGlobal(AOT_STRING(39)));
+  sp--;
+  AOT_CHECK(135, jitGetGlobal(AOT_STRING(44)));
+  AOT_CHECK(138, aotInvoke(AOT_STRING(45), 0));
+  AOT_CHECK(141, aotInvoke(AOT_STRING(46), 0));
+  AOT_CHECK(143, jitSetGlobal(AOT_STRING(43)));
+  sp--;
+  AOT_CHECK(146, jitGetGlobal(AOT_STRING(48)));
+  AOT_CHECK(149, aotInvoke(AOT_STRING(49), 0));
+  AOT_CHECK(152, aotInvoke(AOT_STRING(50), 0));
+  AOT_CHECK(154, jitSetGlobal(AOT_STRING(47)));
+  sp--;
+  AOT_CHECK(157, jitGetGlobal(AOT_STRING(52)));
+  AOT_CHECK(160, aotInvoke(AOT_STRING(53), 0));
+  AOT_CHECK(163, aotInvoke(AOT_STRING(54), 0));
+  AOT_CHECK(165, jitSetGlobal(AOT_STRING(51)));
+  sp--;
+  AOT_CHECK(168, jitGetGlobal(AOT_STRING(56)));
+  AOT_CHECK(171, aotInvoke(AOT_STRING(57), 0));
+  AOT_CHECK(174, aotInvoke(AOT_STRING(58), 0));
+  AOT_CHECK(176, jitSetGlobal(AOT_STRING(55)));
+  sp--;
+  AOT_CHECK(179, jitGetGlobal(AOT_STRING(60)));
+  AOT_CHECK(182, aotInvoke(AOT_STRING(61), 0));
+  AOT_CHECK(185, aotInvoke(AOT_STRING(62), 0));
+  AOT_CHECK(187, jitSetGlobal(AOT_STRING(59)));
+  sp--;
+  AOT_CHECK(190, jitGetGlobal(AOT_STRING(64)));
+  AOT_CHECK(193, aotInvoke(AOT_STRING(65), 0));
+  AOT_CHECK(196, aotInvoke(AOT_STRING(66), 0));
+  AOT_CHECK(198, jitSetGlobal(AOT_STRING(63)));
+  sp--;
+  goto l77;
+l203:
+  sp--;
+  sp--;
+  AOT_CHECK(207, jitGetGlobal(AOT_STRING(67)));
+  AOT_CHECK(210, aotInvoke(AOT_STRING(68), 0));
+  AOT_RUN(211, jitPrint());
+  *sp++ = BOOL_VAL(true);
+  AOT_CHECK(214, jitSetGlobal(AOT_STRING(69)));
+  sp--;
+  AOT_CHECK(217, jitGetGlobal(AOT_STRING(71)));
+  AOT_CHECK(219, jitGetGlobal(AOT_STRING(72)));
+  *sp++ = constants[73];
+  AOT_CHECK(223, aotCall(2));
+  AOT_RUN(225, jitDefineGlobal(AOT_STRING(70)));
+  *sp++ = constants[74];
+l227:
+  *sp++ = slots[1];
+  AOT_CHECK(231, jitGetGlobal(AOT_STRING(75)));
+  AOT_JUMP_UNLESS(234, <, l363);
+  goto l249;
+l237:
+  *sp++ = slots[1];
+  *sp++ = constants[76];
+  AOT_BINARY_OP(242, NUMBER_VAL, +, OP_ADD);
+  slots[1] = sp[-1];
+  sp--;
+  goto l227;
+l249:
+  AOT_CHECK(251, jitGetGlobal(AOT_STRING(78)));
+  AOT_CHECK(254, aotInvoke(AOT_STRING(79), 0));
+  AOT_CHECK(257, aotInvoke(AOT_STRING(80), 0));
+  AOT_CHECK(259, jitSetGlobal(AOT_STRING(77)));
+  sp--;
+  AOT_CHECK(262, jitGetGlobal(AOT_STRING(82)));
+  AOT_CHECK(265, aotInvoke(AOT_STRING(83), 0));
+  AOT_CHECK(268, aotInvoke(AOT_STRING(84), 0));
+  AOT_CHECK(270, jitSetGlobal(AOT_STRING(81)));
+  sp--;
+  AOT_CHECK(273, jitGetGlobal(AOT_STRING(86)));
+  AOT_CHECK(276, aotInvoke(AOT_STRING(87), 0));
+  AOT_CHECK(279, aotInvoke(AOT_STRING(88), 0));
+  AOT_CHECK(281, jitSetGlobal(AOT_STRING(85)));
+  sp--;
+  AOT_CHECK(284, jitGetGlobal(AOT_STRING(90)));
+  AOT_CHECK(287, aotInvoke(AOT_STRING(91), 0));
+  AOT_CHECK(290, aotInvoke(AOT_STRING(92), 0));
+  AOT_CHECK(292, jitSetGlobal(AOT_STRING(89)));
+  sp--;
+  AOT_CHECK(295, jitGetGlobal(AOT_STRING(94)));
+  AOT_CHECK(298, aotInvoke(AOT_STRING(95), 0));
+  AOT_CHECK(301, aotInvoke(AOT_STRING(96), 0));
+  AOT_CHECK(303, jitSetGlobal(AOT_STRING(93)));
+  sp--;
+  AOT_CHECK(306, jitGetGlobal(AOT_STRING(98)));
+  AOT_CHECK(309, aotInvoke(AOT_STRING(99), 0));
+  AOT_CHECK(312, aotInvoke(AOT_STRING(100), 0));
+  AOT_CHECK(314, jitSetGlobal(AOT_STRING(97)));
+  sp--;
+  AOT_CHECK(317, jitGetGlobal(AOT_STRING(102)));
+  AOT_CHECK(320, aotInvoke(AOT_STRING(103), 0));
+  AOT_CHECK(323, aotInvoke(AOT_STRING(104), 0));
+  AOT_CHECK(325, jitSetGlobal(AOT_STRING(101)));
+  sp--;
+  AOT_CHECK(328, jitGetGlobal(AOT_STRING(106)));
+  AOT_CHECK(331, aotInvoke(AOT_STRING(107), 0));
+  AOT_CHECK(334, aotInvoke(AOT_STRING(108), 0));
+  AOT_CHECK(336, jitSetGlobal(AOT_STRING(105)));
+  sp--;
+  AOT_CHECK(339, jitGetGlobal(AOT_STRING(110)));
+  AOT_CHECK(342, aotInvoke(AOT_STRING(111), 0));
+  AOT_CHECK(345, aotInvoke(AOT_STRING(112), 0));
+  AOT_CHECK(347, jitSetGlobal(AOT_STRING(109)));
+  sp--;
+  AOT_CHECK(350, jitGetGlobal(AOT_STRING(114)));
+  AOT_CHECK(353, aotInvoke(AOT_STRING(115), 0));
+  AOT_CHECK(356, aotInvoke(AOT_STRING(116), 0));
+  AOT_CHECK(358, jitSetGlobal(AOT_STRING(113)));
+  sp--;
+  goto l237;
+l363:
+  sp--;
+  sp--;
+  AOT_CHECK(367, jitGetGlobal(AOT_STRING(117)));
+  AOT_CHECK(370, aotInvoke(AOT_STRING(118), 0));
+  AOT_RUN(371, jitPrint());
+  AOT_CHECK(373, jitGetGlobal(AOT_STRING(119)));
+  AOT_CHECK(375, aotCall(0));
+  AOT_CHECK(377, jitGetGlobal(AOT_STRING(120)));
+  AOT_BINARY_OP(378, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(379, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[1];
+  AOT_CHECK(6, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// value
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// activate
+static bool function3() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(5, AOT_STRING(1));
+  sp[-1] = BOOL_VAL(AOT_FALSEY(sp[-1]));
+  AOT_CHECK(8, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function4() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[1];
+  *sp++ = *frame->closure->upvalues[0]->location;
+  AOT_CHECK(9, aotSuperInvoke(AOT_STRING(0), 1));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = slots[2];
+  AOT_CHECK(16, jitSetProperty(AOT_STRING(1)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[3];
+  AOT_CHECK(23, jitSetProperty(AOT_STRING(2)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// activate
+static bool function5() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(5, AOT_STRING(1));
+  *sp++ = constants[2];
+  AOT_BINARY_OP(8, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(10, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(14, AOT_STRING(3));
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(17, AOT_STRING(4));
+  AOT_BINARY_OP(18, BOOL_VAL, <, OP_LESS);
+  sp[-1] = BOOL_VAL(AOT_FALSEY(sp[-1]));
+  if (AOT_FALSEY(sp[-1])) goto l41;
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = *frame->closure->upvalues[0]->location;
+  AOT_CHECK(30, aotSuperInvoke(AOT_STRING(5), 0));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[7];
+  AOT_CHECK(37, jitSetProperty(AOT_STRING(6)));
+  sp--;
+  goto l42;
+l41:
+  sp--;
+l42:
+  *sp++ = slots[0];
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 381 },
+  { function1, 10 },
+  { function2, 6 },
+  { function3, 14 },
+  { function4, 27 },
+  { function5, 47 },
+};
+
+int main() {
+  return aotMain(source, functions, 6);
+}
@@ -0,0 +1,764 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "// This benchmark stresses both field and method lookup.\n"
+    "\n"
+    "class Foo {\n"
+    "  init() {\n"
+    "    this.field0 = 1;\n"
+    "    this.field1 = 1;\n"
+    "    this.field2 = 1;\n"
+    "    this.field3 = 1;\n"
+    "    this.field4 = 1;\n"
+    "    this.field5 = 1;\n"
+    "    this.field6 = 1;\n"
+    "    this.field7 = 1;\n"
+    "    this.field8 = 1;\n"
+    "    this.field9 = 1;\n"
+    "    this.field10 = 1;\n"
+    "    this.field11 = 1;\n"
+    "    this.field12 = 1;\n"
+    "    this.field13 = 1;\n"
+    "    this.field14 = 1;\n"
+    "    this.field15 = 1;\n"
+    "    this.field16 = 1;\n"
+    "    this.field17 = 1;\n"
+    "    this.field18 = 1;\n"
+    "    this.field19 = 1;\n"
+    "    this.field20 = 1;\n"
+    "    this.field21 = 1;\n"
+    "    this.field22 = 1;\n"
+    "    this.field23 = 1;\n"
+    "    this.field24 = 1;\n"
+    "    this.field25 = 1;\n"
+    "    this.field26 = 1;\n"
+    "    this.field27 = 1;\n"
+    "    this.field28 = 1;\n"
+    "    this.field29 = 1;\n"
+    "  }\n"
+    "\n"
+    "  method0() { return this.field0; }\n"
+    "  method1() { return this.field1; }\n"
+    "  method2() { return this.field2; }\n"
+    "  method3() { return this.field3; }\n"
+    "  method4() { return this.field4; }\n"
+    "  method5() { return this.field5; }\n"
+    "  method6() { return this.field6; }\n"
+    "  method7() { return this.field7; }\n"
+    "  method8() { return this.field8; }\n"
+    "  method9() { return this.field9; }\n"
+    "  method10() { return this.field10; }\n"
+    "  method11() { return this.field11; }\n"
+    "  method12() { return this.field12; }\n"
+    "  method13() { return this.field13; }\n"
+    "  method14() { return this.field14; }\n"
+    "  method15() { return this.field15; }\n"
+    "  method16() { return this.field16; }\n"
+    "  method17() { return this.field17; }\n"
+    "  method18() { return this.field18; }\n"
+    "  method19() { return this.field19; }\n"
+    "  method20() { return this.field20; }\n"
+    "  method21() { return this.field21; }\n"
+    "  method22() { return this.field22; }\n"
+    "  method23() { return this.field23; }\n"
+    "  method24() { return this.field24; }\n"
+    "  method25() { return this.field25; }\n"
+    "  method26() { return this.field26; }\n"
+    "  method27() { return this.field27; }\n"
+    "  method28() { return this.field28; }\n"
+    "  method29() { return this.field29; }\n"
+    "}\n"
+    "\n"
+    "var foo = Foo();\n"
+    "var start = clock();\n"
+    "var i = 0;\n"
+    "while (i < 500000) {\n"
+    "  foo.method0();\n"
+    "  foo.method1();\n"
+    "  foo.method2();\n"
+    "  foo.method3();\n"
+    "  foo.method4();\n"
+    "  foo.method5();\n"
+    "  foo.method6();\n"
+    "  foo.method7();\n"
+    "  foo.method8();\n"
+    "  foo.method9();\n"
+    "  foo.method10();\n"
+    "  foo.method11();\n"
+    "  foo.method12();\n"
+    "  foo.method13();\n"
+    "  foo.method14();\n"
+    "  foo.method15();\n"
+    "  foo.method16();\n"
+    "  foo.method17();\n"
+    "  foo.method18();\n"
+    "  foo.method19();\n"
+    "  foo.method20();\n"
+    "  foo.method21();\n"
+    "  foo.method22();\n"
+    "  foo.method23();\n"
+    "  foo.method24();\n"
+    "  foo.method25();\n"
+    "  foo.method26();\n"
+    "  foo.method27();\n"
+    "  foo.method28();\n"
+    "  foo.method29();\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  AOT_RUN(16, jitClosure(AS_FUNCTION(constants[7]), code + 16));
+  AOT_RUN(18, jitMethod(AOT_STRING(6)));
+  AOT_RUN(20, jitClosure(AS_FUNCTION(constants[9]), code + 20));
+  AOT_RUN(22, jitMethod(AOT_STRING(8)));
+  AOT_RUN(24, jitClosure(AS_FUNCTION(constants[11]), code + 24));
+  AOT_RUN(26, jitMethod(AOT_STRING(10)));
+  AOT_RUN(28, jitClosure(AS_FUNCTION(constants[13]), code + 28));
+  AOT_RUN(30, jitMethod(AOT_STRING(12)));
+  AOT_RUN(32, jitClosure(AS_FUNCTION(constants[15]), code + 32));
+  AOT_RUN(34, jitMethod(AOT_STRING(14)));
+  AOT_RUN(36, jitClosure(AS_FUNCTION(constants[17]), code + 36));
+  AOT_RUN(38, jitMethod(AOT_STRING(16)));
+  AOT_RUN(40, jitClosure(AS_FUNCTION(constants[19]), code + 40));
+  AOT_RUN(42, jitMethod(AOT_STRING(18)));
+  AOT_RUN(44, jitClosure(AS_FUNCTION(constants[21]), code + 44));
+  AOT_RUN(46, jitMethod(AOT_STRING(20)));
+  AOT_RUN(48, jitClosure(AS_FUNCTION(constants[23]), code + 48));
+  AOT_RUN(50, jitMethod(AOT_STRING(22)));
+  AOT_RUN(52, jitClosure(AS_FUNCTION(constants[25]), code + 52));
+  AOT_RUN(54, jitMethod(AOT_STRING(24)));
+  AOT_RUN(56, jitClosure(AS_FUNCTION(constants[27]), code + 56));
+  AOT_RUN(58, jitMethod(AOT_STRING(26)));
+  AOT_RUN(60, jitClosure(AS_FUNCTION(constants[29]), code + 60));
+  AOT_RUN(62, jitMethod(AOT_STRING(28)));
+  AOT_RUN(64, jitClosure(AS_FUNCTION(constants[31]), code + 64));
+  AOT_RUN(66, jitMethod(AOT_STRING(30)));
+  AOT_RUN(68, jitClosure(AS_FUNCTION(constants[33]), code + 68));
+  AOT_RUN(70, jitMethod(AOT_STRING(32)));
+  AOT_RUN(72, jitClosure(AS_FUNCTION(constants[35]), code + 72));
+  AOT_RUN(74, jitMethod(AOT_STRING(34)));
+  AOT_RUN(76, jitClosure(AS_FUNCTION(constants[37]), code + 76));
+  AOT_RUN(78, jitMethod(AOT_STRING(36)));
+  AOT_RUN(80, jitClosure(AS_FUNCTION(constants[39]), code + 80));
+  AOT_RUN(82, jitMethod(AOT_STRING(38)));
+  AOT_RUN(84, jitClosure(AS_FUNCTION(constants[41]), code + 84));
+  AOT_RUN(86, jitMethod(AOT_STRING(40)));
+  AOT_RUN(88, jitClosure(AS_FUNCTION(constants[43]), code + 88));
+  AOT_RUN(90, jitMethod(AOT_STRING(42)));
+  AOT_RUN(92, jitClosure(AS_FUNCTION(constants[45]), code + 92));
+  AOT_RUN(94, jitMethod(AOT_STRING(44)));
+  AOT_RUN(96, jitClosure(AS_FUNCTION(constants[47]), code + 96));
+  AOT_RUN(98, jitMethod(AOT_STRING(46)));
+  AOT_RUN(100, jitClosure(AS_FUNCTION(constants[49]), code + 100));
+  AOT_RUN(102, jitMethod(AOT_STRING(48)));
+  AOT_RUN(104, jitClosure(AS_FUNCTION(constants[51]), code + 104));
+  AOT_RUN(106, jitMethod(AOT_STRING(50)));
+  AOT_RUN(108, jitClosure(AS_FUNCTION(constants[53]), code + 108));
+  AOT_RUN(110, jitMethod(AOT_STRING(52)));
+  AOT_RUN(112, jitClosure(AS_FUNCTION(constants[55]), code + 112));
+  AOT_RUN(114, jitMethod(AOT_STRING(54)));
+  AOT_RUN(116, jitClosure(AS_FUNCTION(constants[57]), code + 116));
+  AOT_RUN(118, jitMethod(AOT_STRING(56)));
+  AOT_RUN(120, jitClosure(AS_FUNCTION(constants[59]), code + 120));
+  AOT_RUN(122, jitMethod(AOT_STRING(58)));
+  AOT_RUN(124, jitClosure(AS_FUNCTION(constants[61]), code + 124));
+  AOT_RUN(126, jitMethod(AOT_STRING(60)));
+  AOT_RUN(128, jitClosure(AS_FUNCTION(constants[63]), code + 128));
+  AOT_RUN(130, jitMethod(AOT_STRING(62)));
+  sp--;
+  AOT_CHECK(133, jitGetGlobal(AOT_STRING(65)));
+  AOT_CHECK(135, aotCall(0));
+  AOT_RUN(137, jitDefineGlobal(AOT_STRING(64)));
+  AOT_CHECK(139, jitGetGlobal(AOT_STRING(67)));
+  AOT_CHECK(141, aotCall(0));
+  AOT_RUN(143, jitDefineGlobal(AOT_STRING(66)));
+  *sp++ = constants[69];
+  AOT_RUN(147, jitDefineGlobal(AOT_STRING(68)));
+l147:
+  AOT_CHECK(149, jitGetGlobal(AOT_STRING(70)));
+  *sp++ = constants[71];
+  AOT_JUMP_UNLESS(154, <, l346);
+  AOT_CHECK(156, jitGetGlobal(AOT_STRING(72)));
+  AOT_CHECK(159, aotInvoke(AOT_STRING(73), 0));
+  sp--;
+  AOT_CHECK(162, jitGetGlobal(AOT_STRING(74)));
+  AOT_CHECK(165, aotInvoke(AOT_STRING(75), 0));
+  sp--;
+  AOT_CHECK(168, jitGetGlobal(AOT_STRING(76)));
+  AOT_CHECK(171, aotInvoke(AOT_STRING(77), 0));
+  sp--;
+  AOT_CHECK(174, jitGetGlobal(AOT_STRING(78)));
+  AOT_CHECK(177, aotInvoke(AOT_STRING(79), 0));
+  sp--;
+  AOT_CHECK(180, jitGetGlobal(AOT_STRING(80)));
+  AOT_CHECK(183, aotInvoke(AOT_STRING(81), 0));
+  sp--;
+  AOT_CHECK(186, jitGetGlobal(AOT_STRING(82)));
+  AOT_CHECK(189, aotInvoke(AOT_STRING(83), 0));
+  sp--;
+  AOT_CHECK(192, jitGetGlobal(AOT_STRING(84)));
+  AOT_CHECK(195, aotInvoke(AOT_STRING(85), 0));
+  sp--;
+  AOT_CHECK(198, jitGetGlobal(AOT_STRING(86)));
+  AOT_CHECK(201, aotInvoke(AOT_STRING(87), 0));
+  sp--;
+  AOT_CHECK(204, jitGetGlobal(AOT_STRING(88)));
+  AOT_CHECK(207, aotInvoke(AOT_STRING(89), 0));
+  sp--;
+  AOT_CHECK(210, jitGetGlobal(AOT_STRING(90)));
+  AOT_CHECK(213, aotInvoke(AOT_STRING(91), 0));
+  sp--;
+  AOT_CHECK(216, jitGetGlobal(AOT_STRING(92)));
+  AOT_CHECK(219, aotInvoke(AOT_STRING(93), 0));
+  sp--;
+  AOT_CHECK(222, jitGetGlobal(AOT_STRING(94)));
+  AOT_CHECK(225, aotInvoke(AOT_STRING(95), 0));
+  sp--;
+  AOT_CHECK(228, jitGetGlobal(AOT_STRING(96)));
+  AOT_CHECK(231, aotInvoke(AOT_STRING(97), 0));
+  sp--;
+  AOT_CHECK(234, jitGetGlobal(AOT_STRING(98)));
+  AOT_CHECK(237, aotInvoke(AOT_STRING(99), 0));
+  sp--;
+  AOT_CHECK(240, jitGetGlobal(AOT_STRING(100)));
+  AOT_CHECK(243, aotInvoke(AOT_STRING(101), 0));
+  sp--;
+  AOT_CHECK(246, jitGetGlobal(AOT_STRING(102)));
+  AOT_CHECK(249, aotInvoke(AOT_STRING(103), 0));
+  sp--;
+  AOT_CHECK(252, jitGetGlobal(AOT_STRING(104)));
+  AOT_CHECK(255, aotInvoke(AOT_STRING(105), 0));
+  sp--;
+  AOT_CHECK(258, jitGetGlobal(AOT_STRING(106)));
+  AOT_CHECK(261, aotInvoke(AOT_STRING(107), 0));
+  sp--;
+  AOT_CHECK(264, jitGetGlobal(AOT_STRING(108)));
+  AOT_CHECK(267, aotInvoke(AOT_STRING(109), 0));
+  sp--;
+  AOT_CHECK(270, jitGetGlobal(AOT_STRING(110)));
+  AOT_CHECK(273, aotInvoke(AOT_STRING(111), 0));
+  sp--;
+  AOT_CHECK(276, jitGetGlobal(AOT_STRING(112)));
+  AOT_CHECK(279, aotInvoke(AOT_STRING(113), 0));
+  sp--;
+  AOT_CHECK(282, jitGetGlobal(AOT_STRING(114)));
+  AOT_CHECK(285, aotInvoke(AOT_STRING(115), 0));
+  sp--;
+  AOT_CHECK(288, jitGetGlobal(AOT_STRING(116)));
+  AOT_CHECK(291, aotInvoke(AOT_STRING(117), 0));
+  sp--;
+  AOT_CHECK(294, jitGetGlobal(AOT_STRING(118)));
+  AOT_CHECK(297, aotInvoke(AOT_STRING(119), 0));
+  sp--;
+  AOT_CHECK(300, jitGetGlobal(AOT_STRING(120)));
+  AOT_CHECK(303, aotInvoke(AOT_STRING(121), 0));
+  sp--;
+  AOT_CHECK(306, jitGetGlobal(AOT_STRING(122)));
+  AOT_CHECK(309, aotInvoke(AOT_STRING(123), 0));
+  sp--;
+  AOT_CHECK(312, jitGetGlobal(AOT_STRING(124)));
+  AOT_CHECK(315, aotInvoke(AOT_STRING(125), 0));
+  sp--;
+  AOT_CHECK(318, jitGetGlobal(AOT_STRING(126)));
+  AOT_CHECK(321, aotInvoke(AOT_STRING(127), 0));
+  sp--;
+  AOT_CHECK(324, jitGetGlobal(AOT_STRING(128)));
+  AOT_CHECK(327, aotInvoke(AOT_STRING(129), 0));
+  sp--;
+  AOT_CHECK(330, jitGetGlobal(AOT_STRING(130)));
+  AOT_CHECK(333, aotInvoke(AOT_STRING(131), 0));
+  sp--;
+  AOT_CHECK(336, jitGetGlobal(AOT_STRING(133)));
+  *sp++ = constants[134];
+  AOT_BINARY_OP(339, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(341, jitSetGlobal(AOT_STRING(132)));
+  sp--;
+  goto l147;
+l346:
+  sp--;
+  AOT_CHECK(349, jitGetGlobal(AOT_STRING(135)));
+  AOT_CHECK(351, aotCall(0));
+  AOT_CHECK(353, jitGetGlobal(AOT_STRING(136)));
+  AOT_BINARY_OP(354, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(355, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = constants[1];
+  AOT_CHECK(6, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[3];
+  AOT_CHECK(13, jitSetProperty(AOT_STRING(2)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[5];
+  AOT_CHECK(20, jitSetProperty(AOT_STRING(4)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[7];
+  AOT_CHECK(27, jitSetProperty(AOT_STRING(6)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[9];
+  AOT_CHECK(34, jitSetProperty(AOT_STRING(8)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[11];
+  AOT_CHECK(41, jitSetProperty(AOT_STRING(10)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[13];
+  AOT_CHECK(48, jitSetProperty(AOT_STRING(12)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[15];
+  AOT_CHECK(55, jitSetProperty(AOT_STRING(14)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[17];
+  AOT_CHECK(62, jitSetProperty(AOT_STRING(16)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[19];
+  AOT_CHECK(69, jitSetProperty(AOT_STRING(18)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[21];
+  AOT_CHECK(76, jitSetProperty(AOT_STRING(20)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[23];
+  AOT_CHECK(83, jitSetProperty(AOT_STRING(22)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[25];
+  AOT_CHECK(90, jitSetProperty(AOT_STRING(24)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[27];
+  AOT_CHECK(97, jitSetProperty(AOT_STRING(26)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[29];
+  AOT_CHECK(104, jitSetProperty(AOT_STRING(28)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[31];
+  AOT_CHECK(111, jitSetProperty(AOT_STRING(30)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[33];
+  AOT_CHECK(118, jitSetProperty(AOT_STRING(32)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[35];
+  AOT_CHECK(125, jitSetProperty(AOT_STRING(34)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[37];
+  AOT_CHECK(132, jitSetProperty(AOT_STRING(36)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[39];
+  AOT_CHECK(139, jitSetProperty(AOT_STRING(38)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[41];
+  AOT_CHECK(146, jitSetProperty(AOT_STRING(40)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[43];
+  AOT_CHECK(153, jitSetProperty(AOT_STRING(42)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[45];
+  AOT_CHECK(160, jitSetProperty(AOT_STRING(44)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[47];
+  AOT_CHECK(167, jitSetProperty(AOT_STRING(46)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[49];
+  AOT_CHECK(174, jitSetProperty(AOT_STRING(48)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[51];
+  AOT_CHECK(181, jitSetProperty(AOT_STRING(50)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[53];
+  AOT_CHECK(188, jitSetProperty(AOT_STRING(52)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[55];
+  AOT_CHECK(195, jitSetProperty(AOT_STRING(54)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[57];
+  AOT_CHECK(202, jitSetProperty(AOT_STRING(56)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[59];
+  AOT_CHECK(209, jitSetProperty(AOT_STRING(58)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// method0
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method1
+static bool function3() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method2
+static bool function4() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method3
+static bool function5() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method4
+static bool function6() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method5
+static bool function7() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method6
+static bool function8() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method7
+static bool function9() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method8
+static bool function10() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method9
+static bool function11() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method10
+static bool function12() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method11
+static bool function13() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method12
+static bool function14() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method13
+static bool function15() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method14
+static bool function16() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method15
+static bool function17() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method16
+static bool function18() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method17
+static bool function19() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method18
+static bool function20() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method19
+static bool function21() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method20
+static bool function22() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method21
+static bool function23() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method22
+static bool function24() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method23
+static bool function25() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method24
+static bool function26() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method25
+static bool function27() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method26
+static bool function28() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method27
+static bool function29() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method28
+static bool function30() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// method29
+static bool function31() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 357 },
+  { function1, 213 },
+  { function2, 6 },
+  { function3, 6 },
+  { function4, 6 },
+  { function5, 6 },
+  { function6, 6 },
+  { function7, 6 },
+  { function8, 6 },
+  { function9, 6 },
+  { function10, 6 },
+  { function11, 6 },
+  { function12, 6 },
+  { function13, 6 },
+  { function14, 6 },
+  { function15, 6 },
+  { function16, 6 },
+  { function17, 6 },
+  { function18, 6 },
+  { function19, 6 },
+  { function20, 6 },
+  { function21, 6 },
+  { function22, 6 },
+  { function23, 6 },
+  { function24, 6 },
+  { function25, 6 },
+  { function26, 6 },
+  { function27, 6 },
+  { function28, 6 },
+  { function29, 6 },
+  { function30, 6 },
+  { function31, 6 },
+};
+
+int main() {
+  return aotMain(source, functions, 32);
+}
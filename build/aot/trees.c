@@ -0,0 +1,199 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "class Tree {\n"
+    "  init(depth) {\n"
+    "    this.depth = depth;\n"
+    "    if (depth > 0) {\n"
+    "      this.a = Tree(depth - 1);\n"
+    "      this.b = Tree(depth - 1);\n"
+    "      this.c = Tree(depth - 1);\n"
+    "      this.d = Tree(depth - 1);\n"
+    "      this.e = Tree(depth - 1);\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  walk() {\n"
+    "    if (this.depth == 0) return 0;\n"
+    "    return this.depth \n"
+    "        + this.a.walk()\n"
+    "        + this.b.walk()\n"
+    "        + this.c.walk()\n"
+    "        + this.d.walk()\n"
+    "        + this.e.walk();\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "var tree = Tree(8);\n"
+    "var start = clock();\n"
+    "for (var i = 0; i < 100; i = i + 1) {\n"
+    "  if (tree.walk() != 122068) print \"Error\";\n"
+    "}\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  sp--;
+  AOT_CHECK(17, jitGetGlobal(AOT_STRING(7)));
+  *sp++ = constants[8];
+  AOT_CHECK(21, aotCall(1));
+  AOT_RUN(23, jitDefineGlobal(AOT_STRING(6)));
+  AOT_CHECK(25, jitGetGlobal(AOT_STRING(10)));
+  AOT_CHECK(27, aotCall(0));
+  AOT_RUN(29, jitDefineGlobal(AOT_STRING(9)));
+  *sp++ = constants[11];
+l31:
+  *sp++ = slots[1];
+  *sp++ = constants[12];
+  AOT_JUMP_UNLESS(38, <, l77);
+  goto l53;
+l41:
+  *sp++ = slots[1];
+  *sp++ = constants[13];
+  AOT_BINARY_OP(46, NUMBER_VAL, +, OP_ADD);
+  slots[1] = sp[-1];
+  sp--;
+  goto l31;
+l53:
+  AOT_CHECK(55, jitGetGlobal(AOT_STRING(14)));
+  AOT_CHECK(58, aotInvoke(AOT_STRING(15), 0));
+  *sp++ = constants[16];
+  sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;
+  sp[-1] = BOOL_VAL(AOT_FALSEY(sp[-1]));
+  if (AOT_FALSEY(sp[-1])) goto l72;
+  sp--;
+  *sp++ = constants[17];
+  AOT_RUN(69, jitPrint());
+  goto l73;
+l72:
+  sp--;
+l73:
+  goto l41;
+l77:
+  sp--;
+  sp--;
+  AOT_CHECK(81, jitGetGlobal(AOT_STRING(18)));
+  AOT_CHECK(83, aotCall(0));
+  AOT_CHECK(85, jitGetGlobal(AOT_STRING(19)));
+  AOT_BINARY_OP(86, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(87, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = slots[1];
+  AOT_CHECK(6, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[1];
+  *sp++ = constants[1];
+  AOT_JUMP_UNLESS(14, >, l82);
+  *sp++ = slots[0];
+  AOT_CHECK(18, jitGetGlobal(AOT_STRING(3)));
+  *sp++ = slots[1];
+  *sp++ = constants[4];
+  AOT_BINARY_OP(22, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(24, aotCall(1));
+  AOT_CHECK(26, jitSetProperty(AOT_STRING(2)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(31, jitGetGlobal(AOT_STRING(6)));
+  *sp++ = slots[1];
+  *sp++ = constants[7];
+  AOT_BINARY_OP(35, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(37, aotCall(1));
+  AOT_CHECK(39, jitSetProperty(AOT_STRING(5)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(44, jitGetGlobal(AOT_STRING(9)));
+  *sp++ = slots[1];
+  *sp++ = constants[10];
+  AOT_BINARY_OP(48, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(50, aotCall(1));
+  AOT_CHECK(52, jitSetProperty(AOT_STRING(8)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(57, jitGetGlobal(AOT_STRING(12)));
+  *sp++ = slots[1];
+  *sp++ = constants[13];
+  AOT_BINARY_OP(61, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(63, aotCall(1));
+  AOT_CHECK(65, jitSetProperty(AOT_STRING(11)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_CHECK(70, jitGetGlobal(AOT_STRING(15)));
+  *sp++ = slots[1];
+  *sp++ = constants[16];
+  AOT_BINARY_OP(74, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_CHECK(76, aotCall(1));
+  AOT_CHECK(78, jitSetProperty(AOT_STRING(14)));
+  sp--;
+  goto l83;
+l82:
+  sp--;
+l83:
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// walk
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  *sp++ = constants[1];
+  AOT_JUMP_UNLESS_EQUAL(l14);
+  *sp++ = constants[2];
+  AOT_RETURN();
+  goto l15;
+l14:
+  sp--;
+l15:
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(18, AOT_STRING(3));
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(21, AOT_STRING(4));
+  AOT_CHECK(24, aotInvoke(AOT_STRING(5), 0));
+  AOT_BINARY_OP(25, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(28, AOT_STRING(6));
+  AOT_CHECK(31, aotInvoke(AOT_STRING(7), 0));
+  AOT_BINARY_OP(32, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(35, AOT_STRING(8));
+  AOT_CHECK(38, aotInvoke(AOT_STRING(9), 0));
+  AOT_BINARY_OP(39, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(42, AOT_STRING(10));
+  AOT_CHECK(45, aotInvoke(AOT_STRING(11), 0));
+  AOT_BINARY_OP(46, NUMBER_VAL, +, OP_ADD);
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(49, AOT_STRING(12));
+  AOT_CHECK(52, aotInvoke(AOT_STRING(13), 0));
+  AOT_BINARY_OP(53, NUMBER_VAL, +, OP_ADD);
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 89 },
+  { function1, 86 },
+  { function2, 56 },
+};
+
+int main() {
+  return aotMain(source, functions, 3);
+}
@@ -0,0 +1,209 @@
+// Compiled ahead of time by clox.
+#include "aot.h"
+
+static const char source[] =
+    "class Zoo {\n"
+    "  init() {\n"
+    "    this.aarvark  = 1;\n"
+    "    this.baboon   = 1;\n"
+    "    this.cat      = 1;\n"
+    "    this.donkey   = 1;\n"
+    "    this.elephant = 1;\n"
+    "    this.fox      = 1;\n"
+    "  }\n"
+    "  ant()    { return this.aarvark; }\n"
+    "  banana() { return this.baboon; }\n"
+    "  tuna()   { return this.cat; }\n"
+    "  hay()    { return this.donkey; }\n"
+    "  grass()  { return this.elephant; }\n"
+    "  mouse()  { return this.fox; }\n"
+    "}\n"
+    "\n"
+    "var zoo = Zoo();\n"
+    "var sum = 0;\n"
+    "var start = clock();\n"
+    "while (sum < 10000000) {\n"
+    "  sum = sum + zoo.ant()\n"
+    "            + zoo.banana()\n"
+    "            + zoo.tuna()\n"
+    "            + zoo.hay()\n"
+    "            + zoo.grass()\n"
+    "            + zoo.mouse();\n"
+    "}\n"
+    "\n"
+    "print sum;\n"
+    "print clock() - start;\n";
+
+// script
+static bool function0() {
+  AOT_ENTER();
+  AOT_RUN(2, jitClass(AOT_STRING(0)));
+  AOT_RUN(4, jitDefineGlobal(AOT_STRING(0)));
+  AOT_CHECK(6, jitGetGlobal(AOT_STRING(1)));
+  AOT_RUN(8, jitClosure(AS_FUNCTION(constants[3]), code + 8));
+  AOT_RUN(10, jitMethod(AOT_STRING(2)));
+  AOT_RUN(12, jitClosure(AS_FUNCTION(constants[5]), code + 12));
+  AOT_RUN(14, jitMethod(AOT_STRING(4)));
+  AOT_RUN(16, jitClosure(AS_FUNCTION(constants[7]), code + 16));
+  AOT_RUN(18, jitMethod(AOT_STRING(6)));
+  AOT_RUN(20, jitClosure(AS_FUNCTION(constants[9]), code + 20));
+  AOT_RUN(22, jitMethod(AOT_STRING(8)));
+  AOT_RUN(24, jitClosure(AS_FUNCTION(constants[11]), code + 24));
+  AOT_RUN(26, jitMethod(AOT_STRING(10)));
+  AOT_RUN(28, jitClosure(AS_FUNCTION(constants[13]), code + 28));
+  AOT_RUN(30, jitMethod(AOT_STRING(12)));
+  AOT_RUN(32, jitClosure(AS_FUNCTION(constants[15]), code + 32));
+  AOT_RUN(34, jitMethod(AOT_STRING(14)));
+  sp--;
+  AOT_CHECK(37, jitGetGlobal(AOT_STRING(17)));
+  AOT_CHECK(39, aotCall(0));
+  AOT_RUN(41, jitDefineGlobal(AOT_STRING(16)));
+  *sp++ = constants[19];
+  AOT_RUN(45, jitDefineGlobal(AOT_STRING(18)));
+  AOT_CHECK(47, jitGetGlobal(AOT_STRING(21)));
+  AOT_CHECK(49, aotCall(0));
+  AOT_RUN(51, jitDefineGlobal(AOT_STRING(20)));
+l51:
+  AOT_CHECK(53, jitGetGlobal(AOT_STRING(22)));
+  *sp++ = constants[23];
+  AOT_JUMP_UNLESS(58, <, l103);
+  AOT_CHECK(60, jitGetGlobal(AOT_STRING(25)));
+  AOT_CHECK(62, jitGetGlobal(AOT_STRING(26)));
+  AOT_CHECK(65, aotInvoke(AOT_STRING(27), 0));
+  AOT_BINARY_OP(66, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(68, jitGetGlobal(AOT_STRING(28)));
+  AOT_CHECK(71, aotInvoke(AOT_STRING(29), 0));
+  AOT_BINARY_OP(72, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(74, jitGetGlobal(AOT_STRING(30)));
+  AOT_CHECK(77, aotInvoke(AOT_STRING(31), 0));
+  AOT_BINARY_OP(78, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(80, jitGetGlobal(AOT_STRING(32)));
+  AOT_CHECK(83, aotInvoke(AOT_STRING(33), 0));
+  AOT_BINARY_OP(84, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(86, jitGetGlobal(AOT_STRING(34)));
+  AOT_CHECK(89, aotInvoke(AOT_STRING(35), 0));
+  AOT_BINARY_OP(90, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(92, jitGetGlobal(AOT_STRING(36)));
+  AOT_CHECK(95, aotInvoke(AOT_STRING(37), 0));
+  AOT_BINARY_OP(96, NUMBER_VAL, +, OP_ADD);
+  AOT_CHECK(98, jitSetGlobal(AOT_STRING(24)));
+  sp--;
+  goto l51;
+l103:
+  sp--;
+  AOT_CHECK(106, jitGetGlobal(AOT_STRING(38)));
+  AOT_RUN(107, jitPrint());
+  AOT_CHECK(109, jitGetGlobal(AOT_STRING(39)));
+  AOT_CHECK(111, aotCall(0));
+  AOT_CHECK(113, jitGetGlobal(AOT_STRING(40)));
+  AOT_BINARY_OP(114, NUMBER_VAL, -, OP_SUBTRACT);
+  AOT_RUN(115, jitPrint());
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// init
+static bool function1() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  *sp++ = constants[1];
+  AOT_CHECK(6, jitSetProperty(AOT_STRING(0)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[3];
+  AOT_CHECK(13, jitSetProperty(AOT_STRING(2)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[5];
+  AOT_CHECK(20, jitSetProperty(AOT_STRING(4)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[7];
+  AOT_CHECK(27, jitSetProperty(AOT_STRING(6)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[9];
+  AOT_CHECK(34, jitSetProperty(AOT_STRING(8)));
+  sp--;
+  *sp++ = slots[0];
+  *sp++ = constants[11];
+  AOT_CHECK(41, jitSetProperty(AOT_STRING(10)));
+  sp--;
+  *sp++ = slots[0];
+  AOT_RETURN();
+}
+
+// ant
+static bool function2() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// banana
+static bool function3() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// tuna
+static bool function4() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// hay
+static bool function5() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// grass
+static bool function6() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+// mouse
+static bool function7() {
+  AOT_ENTER();
+  *sp++ = slots[0];
+  AOT_GET_PROPERTY(3, AOT_STRING(0));
+  AOT_RETURN();
+  *sp++ = NIL_VAL;
+  AOT_RETURN();
+}
+
+static AotFunction functions[] = {
+  { function0, 117 },
+  { function1, 45 },
+  { function2, 6 },
+  { function3, 6 },
+  { function4, 6 },
+  { function5, 6 },
+  { function6, 6 },
+  { function7, 6 },
+};
+
+int main() {
+  return aotMain(source, functions, 8);
+}
@@ -0,0 +1,385 @@
+//> Optimization omit
+#include <stdlib.h>
+
+#include "aot.h"
+#include "compiler.h"
+#include "memory.h"
+#include "vm.h"
+
+// An ahead-of-time compiler from bytecode to C. Each function becomes a C
+// function that does what run() would do for each of its instructions, in
+// order, with jumps turned into gotos. The generated code runs on the same
+// VM as the interpreter: it keeps values on vm.stack, pushes the same call
+// frames, and uses the same objects and GC. Only the dispatch loop is gone.
+//
+// The program still needs the functions' constants, names, and line
+// information at runtime. Instead of describing them all in C, it embeds the
+// script's source and compiles it again on startup. Compiling is
+// deterministic, so the functions come out in the same order with the same
+// constants, and the C code refers to them by index as the bytecode did.
+
+typedef struct {
+  ObjFunction** functions;
+  int count;
+  int capacity;
+} FunctionList;
+
+// Adds [function] and the functions nested in it to [list], depth first,
+// in the order they appear among the constants of their enclosing function.
+static void collectFunctions(FunctionList* list, ObjFunction* function) {
+  if (list->capacity < list->count + 1) {
+    int oldCapacity = list->capacity;
+    list->capacity = GROW_CAPACITY(oldCapacity);
+    list->functions = GROW_ARRAY(ObjFunction*, list->functions,
+        oldCapacity, list->capacity);
+  }
+  list->functions[list->count++] = function;
+
+  ValueArray* constants = &function->chunk.constants;
+  for (int i = 0; i < constants->count; i++) {
+    if (IS_FUNCTION(constants->values[i])) {
+      collectFunctions(list, AS_FUNCTION(constants->values[i]));
+    }
+  }
+}
+
+// Collects the functions in the tree rooted at [function], which it keeps
+// on the stack in case growing the list triggers a GC.
+static FunctionList listFunctions(ObjFunction* function) {
+  FunctionList list;
+  list.functions = NULL;
+  list.count = 0;
+  list.capacity = 0;
+
+  push(OBJ_VAL(function));
+  collectFunctions(&list, function);
+  pop();
+  return list;
+}
+
+static void freeFunctionList(FunctionList* list) {
+  FREE_ARRAY(ObjFunction*, list->functions, list->capacity);
+}
+
+static int readShort(Chunk* chunk, int offset) {
+  return (chunk->code[offset] << 8) | chunk->code[offset + 1];
+}
+
+// Returns the offset the jump at [offset] goes to, or -1 if the instruction
+// there isn't a jump.
+static int jumpTarget(Chunk* chunk, int offset) {
+  switch ((OpCode)chunk->code[offset]) {
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER:
+    case OP_JUMP_IF_NOT_EQUAL:
+      return offset + 3 + readShort(chunk, offset + 1);
+    case OP_LOOP:
+      return offset + 4 - readShort(chunk, offset + 1);
+    default:
+      return -1;
+  }
+}
+
+// Writes a read of the property whose name is constant [name], inline when
+// the instruction has a property cache to check.
+static void emitGetProperty(FILE* out, int next, int name, int cache) {
+  if (cache == PROPERTY_UNCACHED) {
+    fprintf(out, "AOT_CHECK(%d, jitGetProperty(AOT_STRING(%d)));\n",
+            next, name);
+  } else {
+    fprintf(out, "AOT_GET_PROPERTY(%d, AOT_STRING(%d), %d);\n",
+            next, name, cache);
+  }
+}
+
+// Writes the C statements for the instruction at [offset].
+static void emitInstruction(FILE* out, Chunk* chunk, int offset) {
+  uint8_t* code = chunk->code + offset;
+  int next = offset + instructionLength(chunk, offset);
+  int target = jumpTarget(chunk, offset);
+
+  fprintf(out, "  ");
+  switch ((OpCode)code[0]) {
+    case OP_CONSTANT:
+      fprintf(out, "*sp++ = constants[%d];\n", code[1]);
+      break;
+    case OP_NIL: fprintf(out, "*sp++ = NIL_VAL;\n"); break;
+    case OP_TRUE: fprintf(out, "*sp++ = BOOL_VAL(true);\n"); break;
+    case OP_FALSE: fprintf(out, "*sp++ = BOOL_VAL(false);\n"); break;
+    case OP_POP: fprintf(out, "sp--;\n"); break;
+    case OP_GET_LOCAL: fprintf(out, "*sp++ = slots[%d];\n", code[1]); break;
+    case OP_SET_LOCAL: fprintf(out, "slots[%d] = sp[-1];\n", code[1]); break;
+
+    case OP_GET_GLOBAL:
+      fprintf(out, "AOT_GET_GLOBAL(%d, %d);\n",
+              next, readShort(chunk, offset + 1));
+      break;
+
+    case OP_DEFINE_GLOBAL:
+      fprintf(out, "vm.globalValues.values[%d] = *--sp;\n",
+              readShort(chunk, offset + 1));
+      break;
+
+    case OP_SET_GLOBAL:
+      fprintf(out, "AOT_SET_GLOBAL(%d, %d);\n",
+              next, readShort(chunk, offset + 1));
+      break;
+
+    case OP_GET_UPVALUE:
+      fprintf(out, "*sp++ = *frame->closure->upvalues[%d]->location;\n",
+              code[1]);
+      break;
+
+    case OP_SET_UPVALUE:
+      fprintf(out, "*frame->closure->upvalues[%d]->location = sp[-1];\n",
+              code[1]);
+      break;
+
+    case OP_GET_CAPTURE:
+      fprintf(out, "*sp++ = frame->closure->captures[%d];\n", code[1]);
+      break;
+
+    case OP_GET_PROPERTY:
+    case OP_GET_FIELD:
+      emitGetProperty(out, next, code[1], code[2]);
+      break;
+
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_GET_LOCAL_FIELD:
+      fprintf(out, "*sp++ = slots[%d];\n  ", code[1]);
+      emitGetProperty(out, next, code[2], code[3]);
+      break;
+
+    case OP_SET_PROPERTY:
+      fprintf(out, "AOT_CHECK(%d, jitSetProperty(AOT_STRING(%d)));\n",
+              next, code[1]);
+      break;
+
+    case OP_GET_SUPER:
+      fprintf(out, "AOT_CHECK(%d, jitGetSuper(AOT_STRING(%d)));\n",
+              next, code[1]);
+      break;
+
+    case OP_EQUAL:
+      fprintf(out, "sp[-2] = BOOL_VAL(valuesEqual(sp[-2], sp[-1])); sp--;\n");
+      break;
+
+    case OP_GREATER:
+      fprintf(out, "AOT_BINARY_OP(%d, BOOL_VAL, >, OP_GREATER);\n", next);
+      break;
+    case OP_LESS:
+      fprintf(out, "AOT_BINARY_OP(%d, BOOL_VAL, <, OP_LESS);\n", next);
+      break;
+    case OP_ADD:
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+      fprintf(out, "AOT_BINARY_OP(%d, NUMBER_VAL, +, OP_ADD);\n", next);
+      break;
+    case OP_SUBTRACT:
+      fprintf(out, "AOT_BINARY_OP(%d, NUMBER_VAL, -, OP_SUBTRACT);\n", next);
+      break;
+
+    case OP_SUBTRACT_CONSTANT:
+      fprintf(out, "*sp++ = constants[%d];\n", code[1]);
+      fprintf(out, "  AOT_BINARY_OP(%d, NUMBER_VAL, -, OP_SUBTRACT);\n",
+              next);
+      break;
+
+    case OP_MULTIPLY:
+      fprintf(out, "AOT_BINARY_OP(%d, NUMBER_VAL, *, OP_MULTIPLY);\n", next);
+      break;
+    case OP_DIVIDE:
+      fprintf(out, "AOT_BINARY_OP(%d, NUMBER_VAL, /, OP_DIVIDE);\n", next);
+      break;
+
+    case OP_NOT:
+      fprintf(out, "sp[-1] = BOOL_VAL(AOT_FALSEY(sp[-1]));\n");
+      break;
+
+    case OP_NEGATE: fprintf(out, "AOT_NEGATE(%d);\n", next); break;
+    case OP_PRINT: fprintf(out, "AOT_RUN(%d, jitPrint());\n", next); break;
+
+    case OP_JUMP:
+    case OP_LOOP:
+      fprintf(out, "goto l%d;\n", target);
+      break;
+
+    case OP_JUMP_IF_FALSE:
+      fprintf(out, "if (AOT_FALSEY(sp[-1])) goto l%d;\n", target);
+      break;
+
+    case OP_JUMP_IF_NOT_LESS:
+      fprintf(out, "AOT_JUMP_UNLESS(%d, <, l%d);\n", next, target);
+      break;
+    case OP_JUMP_IF_NOT_GREATER:
+      fprintf(out, "AOT_JUMP_UNLESS(%d, >, l%d);\n", next, target);
+      break;
+    case OP_JUMP_IF_NOT_EQUAL:
+      fprintf(out, "AOT_JUMP_UNLESS_EQUAL(l%d);\n", target);
+      break;
+
+    case OP_CALL:
+      fprintf(out, "AOT_CHECK(%d, aotCall(%d));\n", next, code[1]);
+      break;
+
+    case OP_CALL_GLOBAL:
+      fprintf(out, "AOT_CHECK(%d, aotCallGlobal(%d));\n", next, code[1]);
+      break;
+
+    case OP_TAIL_CALL:
+      fprintf(out, "AOT_TAIL_CALL(%d, %d);\n", next, code[1]);
+      break;
+
+    case OP_INVOKE:
+      fprintf(out, "AOT_CHECK(%d, aotInvoke(AOT_STRING(%d), %d));\n",
+              next, code[1], code[2]);
+      break;
+
+    case OP_SUPER_INVOKE:
+      fprintf(out, "AOT_CHECK(%d, aotSuperInvoke(AOT_STRING(%d), %d));\n",
+              next, code[1], code[2]);
+      break;
+
+    case OP_CLOSURE:
+      // The captures are read from the operands of the bytecode instruction.
+      fprintf(out, "AOT_RUN(%d, jitClosure(AS_FUNCTION(constants[%d]), "
+                   "code + %d));\n", next, code[1], offset + 2);
+      break;
+
+    case OP_CLOSE_UPVALUE:
+      fprintf(out, "AOT_RUN(%d, jitCloseUpvalue());\n", next);
+      break;
+
+    case OP_RETURN: fprintf(out, "AOT_RETURN();\n"); break;
+
+    case OP_CLASS:
+      fprintf(out, "AOT_RUN(%d, jitClass(AOT_STRING(%d)));\n", next, code[1]);
+      break;
+
+    case OP_INHERIT:
+      fprintf(out, "AOT_CHECK(%d, jitInherit());\n", next);
+      break;
+
+    case OP_METHOD:
+      fprintf(out, "AOT_RUN(%d, jitMethod(AOT_STRING(%d)));\n",
+              next, code[1]);
+      break;
+  }
+}
+
+static void emitFunction(FILE* out, ObjFunction* function, int index) {
+  Chunk* chunk = &function->chunk;
+
+  // Only the instructions something jumps to get a label, since C warns
+  // about unused ones.
+  bool* targets = ALLOCATE(bool, chunk->count + 1);
+  for (int offset = 0; offset <= chunk->count; offset++) {
+    targets[offset] = false;
+  }
+  for (int offset = 0; offset < chunk->count;
+       offset += instructionLength(chunk, offset)) {
+    int target = jumpTarget(chunk, offset);
+    if (target != -1) targets[target] = true;
+  }
+
+  fprintf(out, "\n// %s\n", function->name == NULL
+      ? "script" : function->name->chars);
+  fprintf(out, "static bool function%d() {\n", index);
+  fprintf(out, "  AOT_ENTER();\n");
+  for (int offset = 0; offset < chunk->count;
+       offset += instructionLength(chunk, offset)) {
+    if (targets[offset]) fprintf(out, "l%d:\n", offset);
+    emitInstruction(out, chunk, offset);
+  }
+  fprintf(out, "}\n");
+
+  FREE_ARRAY(bool, targets, chunk->count + 1);
+}
+
+// Writes [source] as a C string literal, a line at a time.
+static void emitSource(FILE* out, const char* source) {
+  fprintf(out, "static const char source[] =\n    \"");
+  for (const char* c = source; *c != '\0'; c++) {
+    switch (*c) {
+      case '\n':
+        if (c[1] == '\0') {
+          fprintf(out, "\\n");
+        } else {
+          fprintf(out, "\\n\"\n    \"");
+        }
+        break;
+      case '\\': fprintf(out, "\\\\"); break;
+      case '"': fprintf(out, "\\\""); break;
+      // Keep it from forming a trigraph.
+      case '?': fprintf(out, "\\?"); break;
+      default:
+        if (*c < ' ' || *c > '~') {
+          fprintf(out, "\\%03o", (unsigned char)*c);
+        } else {
+          fputc(*c, out);
+        }
+        break;
+    }
+  }
+  fprintf(out, "\";\n");
+}
+
+void aotEmit(FILE* out, const char* source, ObjFunction* function) {
+  FunctionList list = listFunctions(function);
+
+  fprintf(out, "// Compiled ahead of time by clox.\n");
+  fprintf(out, "#include \"aot.h\"\n\n");
+  emitSource(out, source);
+
+  for (int i = 0; i < list.count; i++) {
+    emitFunction(out, list.functions[i], i);
+  }
+
+  fprintf(out, "\nstatic AotFunction functions[] = {\n");
+  for (int i = 0; i < list.count; i++) {
+    fprintf(out, "  { function%d, %d },\n", i, list.functions[i]->chunk.count);
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "int main() {\n");
+  fprintf(out, "  return aotMain(source, functions, %d);\n", list.count);
+  fprintf(out, "}\n");
+
+  freeFunctionList(&list);
+}
+
+#ifdef AOT_RUNTIME
+int aotMain(const char* source, AotFunction* functions, int functionCount) {
+  initVM();
+
+  int status = 0;
+  ObjFunction* script = compile(source);
+  if (script == NULL) {
+    status = 65;
+  } else {
+    // Pair each function up with its C code. If the bytecode differs from
+    // what the C code was generated from, the runtime was built with
+    // different options than the compiler.
+    FunctionList list = listFunctions(script);
+    bool matches = list.count == functionCount;
+    for (int i = 0; matches && i < list.count; i++) {
+      matches = list.functions[i]->chunk.count == functions[i].byteCount;
+      list.functions[i]->aotCode = functions[i].code;
+    }
+    freeFunctionList(&list);
+
+    if (!matches) {
+      fprintf(stderr, "Compiled code does not match its source.\n");
+      status = 70;
+    } else if (aotInterpret(script) != INTERPRET_OK) {
+      status = 70;
+    }
+  }
+
+  freeVM();
+  return status;
+}
+#endif
+//< Optimization omit
@@ -0,0 +1,166 @@
+//> Optimization omit
+#ifndef clox_aot_h
+#define clox_aot_h
+
+#include <stdio.h>
+
+#include "common.h"
+#include "object.h"
+
+// Writes a C program to [out] that runs the script [function] was compiled
+// from, with each function's bytecode translated to a C function. [source]
+// is the script's source, which the program embeds and compiles again when
+// it starts, to recreate the functions and constants the C code refers to.
+void aotEmit(FILE* out, const char* source, ObjFunction* function);
+
+#ifdef AOT_RUNTIME
+#include "jit.h"
+#include "vm.h"
+
+// A compiled function, in the order aotEmit() walks the function tree, with
+// the length of the bytecode it was compiled from.
+typedef struct {
+  bool (*code)();
+  int byteCount;
+} AotFunction;
+
+// The main() of a program compiled ahead of time.
+int aotMain(const char* source, AotFunction* functions, int functionCount);
+
+// Runtime helpers in vm.c.
+bool aotCall(int argCount);
+bool aotCallGlobal(int argCount);
+bool aotInvoke(ObjString* name, int argCount);
+bool aotSuperInvoke(ObjString* name, int argCount);
+bool aotTailCall(int argCount);
+InterpretResult aotInterpret(ObjFunction* function);
+
+// The generated C code is written in terms of these macros. Each function
+// keeps the top of the VM's stack in the local sp, and writes it back, along
+// with the frame's ip, before calling a runtime helper.
+#define AOT_ENTER() \
+    CallFrame* frame = FRAME_AT(vm.frameCount - 1); \
+    uint8_t* code = frame->closure->function->chunk.code; \
+    Value* constants = frame->closure->function->chunk.constants.values; \
+    Value* slots = frame->slots; \
+    Value* sp = vm.stackTop; \
+    (void)code; (void)constants; (void)slots
+
+#define AOT_STRING(index) AS_STRING(constants[index])
+
+#define AOT_FALSEY(value) \
+    (IS_NIL(value) || (IS_BOOL(value) && !AS_BOOL(value)))
+
+// Runs [call] with the VM state written back, resuming at [next] if it
+// reports an error.
+#define AOT_RUN(next, call) \
+    do { \
+      vm.stackTop = sp; \
+      frame->ip = code + (next); \
+      call; \
+      sp = vm.stackTop; \
+    } while (false)
+
+#define AOT_CHECK(next, call) \
+    do { \
+      vm.stackTop = sp; \
+      frame->ip = code + (next); \
+      if (!(call)) return false; \
+      sp = vm.stackTop; \
+    } while (false)
+
+#define AOT_BINARY_OP(next, valueType, op, instruction) \
+    do { \
+      if (IS_NUMBER(sp[-2]) && IS_NUMBER(sp[-1])) { \
+        sp[-2] = valueType(AS_NUMBER(sp[-2]) op AS_NUMBER(sp[-1])); \
+        sp--; \
+      } else { \
+        AOT_CHECK(next, jitBinaryOp(instruction)); \
+      } \
+    } while (false)
+
+#define AOT_NEGATE(next) \
+    do { \
+      if (IS_NUMBER(sp[-1])) { \
+        sp[-1] = NUMBER_VAL(-AS_NUMBER(sp[-1])); \
+      } else { \
+        AOT_CHECK(next, jitNegate()); \
+      } \
+    } while (false)
+
+// The global variable in [slot], which only goes to the helpers to report
+// that it isn't defined.
+#define AOT_GET_GLOBAL(next, slot) \
+    do { \
+      Value value = vm.globalValues.values[slot]; \
+      if (IS_UNDEFINED(value)) { \
+        AOT_CHECK(next, jitGetGlobal(slot)); \
+      } else { \
+        *sp++ = value; \
+      } \
+    } while (false)
+
+#define AOT_SET_GLOBAL(next, slot) \
+    do { \
+      if (IS_UNDEFINED(vm.globalValues.values[slot])) { \
+        AOT_CHECK(next, jitSetGlobal(slot)); \
+      } \
+      vm.globalValues.values[slot] = sp[-1]; \
+    } while (false)
+
+// Reads a field straight out of the instance when its shape is the one
+// property cache [index] last saw.
+#define AOT_GET_PROPERTY(next, name, index) \
+    do { \
+      PropertyCache* cache = \
+          &frame->closure->function->chunk.propertyCaches[index]; \
+      if (IS_INSTANCE(sp[-1]) && \
+          AS_INSTANCE(sp[-1])->shape == cache->shape) { \
+        sp[-1] = AS_INSTANCE(sp[-1])->fields[cache->slot]; \
+      } else { \
+        AOT_CHECK(next, jitGetProperty(name)); \
+      } \
+    } while (false)
+
+#define AOT_JUMP_UNLESS(next, op, label) \
+    do { \
+      if (!IS_NUMBER(sp[-2]) || !IS_NUMBER(sp[-1])) { \
+        AOT_CHECK(next, jitBinaryOp(OP_LESS)); \
+      } \
+      double b = AS_NUMBER(sp[-1]); \
+      double a = AS_NUMBER(sp[-2]); \
+      sp -= 2; \
+      if (!(a op b)) { \
+        *sp++ = BOOL_VAL(false); \
+        goto label; \
+      } \
+    } while (false)
+
+#define AOT_JUMP_UNLESS_EQUAL(label) \
+    do { \
+      bool equal = valuesEqual(sp[-2], sp[-1]); \
+      sp -= 2; \
+      if (!equal) { \
+        *sp++ = BOOL_VAL(false); \
+        goto label; \
+      } \
+    } while (false)
+
+// A callee that took over the frame starts it over at its own code, and
+// the caller returns to let it run.
+#define AOT_TAIL_CALL(next, argCount) \
+    do { \
+      AOT_CHECK(next, aotTailCall(argCount)); \
+      if (frame->ip != code + (next)) return true; \
+    } while (false)
+
+#define AOT_RETURN() \
+    do { \
+      vm.stackTop = sp; \
+      jitReturn(); \
+      return true; \
+    } while (false)
+#endif
+
+#endif
+//< Optimization omit
@@ -0,0 +1,439 @@
+//> Optimization omit
+// mmap(), mprotect(), and sysconf() aren't part of C99.
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "memory.h"
+#include "vm.h"
+
+#ifdef BASELINE_JIT
+void initAssembler(Assembler* as) {
+  as->code = NULL;
+  as->count = 0;
+  as->capacity = 0;
+  as->exitOk = -1;
+  as->exitError = -1;
+}
+
+void freeAssembler(Assembler* as) {
+  FREE_ARRAY(uint8_t, as->code, as->capacity);
+  initAssembler(as);
+}
+
+void emitByte(Assembler* as, uint8_t byte) {
+  if (as->capacity < as->count + 1) {
+    int oldCapacity = as->capacity;
+    as->capacity = GROW_CAPACITY(oldCapacity);
+    as->code = GROW_ARRAY(uint8_t, as->code, oldCapacity, as->capacity);
+  }
+
+  as->code[as->count++] = byte;
+}
+
+void emitBytes(Assembler* as, uint8_t byte1, uint8_t byte2) {
+  emitByte(as, byte1);
+  emitByte(as, byte2);
+}
+
+void emitInt32(Assembler* as, uint32_t value) {
+  for (int i = 0; i < 4; i++) emitByte(as, (uint8_t)(value >> (i * 8)));
+}
+
+static void emitInt64(Assembler* as, uint64_t value) {
+  for (int i = 0; i < 8; i++) emitByte(as, (uint8_t)(value >> (i * 8)));
+}
+
+// Emits the REX prefix, if one is needed, for an instruction whose ModRM
+// byte refers to [reg] and [rm].
+static void emitRex(Assembler* as, bool wide, int reg, int rm) {
+  uint8_t rex = 0x40;
+  if (wide) rex |= 0x08;
+  if (reg & 8) rex |= 0x04;
+  if (rm & 8) rex |= 0x01;
+  if (rex != 0x40) emitByte(as, rex);
+}
+
+// A ModRM byte for two registers.
+void emitModRm(Assembler* as, int reg, int rm) {
+  emitByte(as, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// A ModRM byte for a register and [base + offset].
+static void emitModRmMemory(Assembler* as, int reg, Register base,
+                            int32_t offset) {
+  emitByte(as, 0x80 | ((reg & 7) << 3) | (base & 7));
+  // RSP and R12 can only be used as a base through a SIB byte.
+  if ((base & 7) == RSP) emitByte(as, 0x24);
+  emitInt32(as, (uint32_t)offset);
+}
+
+// mov dst, value
+void emitMoveImmediate(Assembler* as, Register dst, uint64_t value) {
+  emitRex(as, true, 0, dst);
+  emitByte(as, 0xb8 + (dst & 7));
+  emitInt64(as, value);
+}
+
+// mov dst, [base + offset]
+void emitLoad(Assembler* as, Register dst, Register base, int32_t offset) {
+  emitRex(as, true, dst, base);
+  emitByte(as, 0x8b);
+  emitModRmMemory(as, dst, base, offset);
+}
+
+// mov dst32, dword [base + offset], which zero-extends into dst.
+void emitLoad32(Assembler* as, Register dst, Register base, int32_t offset) {
+  emitRex(as, false, dst, base);
+  emitByte(as, 0x8b);
+  emitModRmMemory(as, dst, base, offset);
+}
+
+// mov [base + offset], src
+void emitStore(Assembler* as, Register base, int32_t offset, Register src) {
+  emitRex(as, true, src, base);
+  emitByte(as, 0x89);
+  emitModRmMemory(as, src, base, offset);
+}
+
+// op dst, src
+void emitAlu(Assembler* as, AluOp op, Register dst, Register src) {
+  emitRex(as, true, src, dst);
+  emitByte(as, op);
+  emitModRm(as, src, dst);
+}
+
+// op dst, value
+void emitAluImmediate(Assembler* as, ImmOp op, Register dst, int32_t value) {
+  emitRex(as, true, 0, dst);
+  emitByte(as, 0x81);
+  emitModRm(as, op, dst);
+  emitInt32(as, (uint32_t)value);
+}
+
+// op dword [base + offset], value
+void emitAluMemory32(Assembler* as, ImmOp op, Register base, int32_t offset,
+                     int8_t value) {
+  emitRex(as, false, 0, base);
+  emitByte(as, 0x83);
+  emitModRmMemory(as, op, base, offset);
+  emitByte(as, (uint8_t)value);
+}
+
+// op qword [base + offset], value
+void emitAluMemory64(Assembler* as, ImmOp op, Register base, int32_t offset,
+                     int8_t value) {
+  emitRex(as, true, 0, base);
+  emitByte(as, 0x83);
+  emitModRmMemory(as, op, base, offset);
+  emitByte(as, (uint8_t)value);
+}
+
+// shl reg, count
+void emitShiftLeft(Assembler* as, Register reg, uint8_t count) {
+  emitRex(as, true, 0, reg);
+  emitByte(as, 0xc1);
+  emitModRm(as, 4, reg);
+  emitByte(as, count);
+}
+
+// Calls the function at [address], clobbering RAX.
+void emitCallAddress(Assembler* as, uint64_t address) {
+  emitMoveImmediate(as, RAX, address);
+  emitBytes(as, 0xff, 0xd0); // call rax
+}
+
+// setcc al
+void emitSetAl(Assembler* as, Condition condition) {
+  emitBytes(as, 0x0f, 0x90 + condition);
+  emitModRm(as, 0, RAX);
+}
+
+// movq xmm, src
+void emitMoveToXmm(Assembler* as, int xmm, Register src) {
+  emitByte(as, 0x66);
+  emitRex(as, true, xmm, src);
+  emitBytes(as, 0x0f, 0x6e);
+  emitModRm(as, xmm, src);
+}
+
+// movq dst, xmm
+void emitMoveFromXmm(Assembler* as, Register dst, int xmm) {
+  emitByte(as, 0x66);
+  emitRex(as, true, xmm, dst);
+  emitBytes(as, 0x0f, 0x7e);
+  emitModRm(as, xmm, dst);
+}
+
+// op xmm, xmm
+void emitSse(Assembler* as, SseOp op, int dst, int src) {
+  emitByte(as, 0xf2);
+  emitBytes(as, 0x0f, op);
+  emitModRm(as, dst, src);
+}
+
+// ucomisd a, b
+void emitCompareDoubles(Assembler* as, int a, int b) {
+  emitByte(as, 0x66);
+  emitBytes(as, 0x0f, 0x2e);
+  emitModRm(as, a, b);
+}
+
+static void emitPushRegister(Assembler* as, Register reg) {
+  emitRex(as, false, 0, reg);
+  emitByte(as, 0x50 + (reg & 7));
+}
+
+static void emitPopRegister(Assembler* as, Register reg) {
+  emitRex(as, false, 0, reg);
+  emitByte(as, 0x58 + (reg & 7));
+}
+
+// Emits a jmp or jcc with a 32-bit offset to be filled in later, and returns
+// where that offset is.
+int emitJump(Assembler* as, Condition condition) {
+  if (condition == CC_ALWAYS) {
+    emitByte(as, 0xe9);
+  } else {
+    emitBytes(as, 0x0f, 0x80 + condition);
+  }
+
+  emitInt32(as, 0);
+  return as->count - 4;
+}
+
+void patchJumpTo(Assembler* as, int patch, int target) {
+  uint32_t offset = (uint32_t)(target - (patch + 4));
+  for (int i = 0; i < 4; i++) {
+    as->code[patch + i] = (uint8_t)(offset >> (i * 8));
+  }
+}
+
+void patchJump(Assembler* as, int patch) {
+  patchJumpTo(as, patch, as->count);
+}
+
+void emitJumpTo(Assembler* as, Condition condition, int target) {
+  patchJumpTo(as, emitJump(as, condition), target);
+}
+
+void emitPush(Assembler* as, Register reg) {
+  emitStore(as, STACK_REG, 0, reg);
+  emitAluImmediate(as, IMM_ADD, STACK_REG, sizeof(Value));
+}
+
+void emitPeek(Assembler* as, Register dst, int distance) {
+  emitLoad(as, dst, STACK_REG, -(int32_t)sizeof(Value) * (distance + 1));
+}
+
+void emitDrop(Assembler* as, int count) {
+  emitAluImmediate(as, IMM_SUB, STACK_REG, sizeof(Value) * count);
+}
+
+void emitPushConstant(Assembler* as, Value value) {
+  emitMoveImmediate(as, RAX, value);
+  emitPush(as, RAX);
+}
+
+void emitGetLocal(Assembler* as, int slot) {
+  emitLoad(as, RAX, SLOTS_REG, sizeof(Value) * slot);
+  emitPush(as, RAX);
+}
+
+// Loads frame->closure->upvalues[slot]->location into [dst].
+void emitUpvalueLocation(Assembler* as, Register dst, int slot) {
+  emitLoad(as, dst, FRAME_REG, offsetof(CallFrame, closure));
+  emitLoad(as, dst, dst, offsetof(ObjClosure, upvalues));
+  emitLoad(as, dst, dst, sizeof(ObjUpvalue*) * slot);
+  emitLoad(as, dst, dst, offsetof(ObjUpvalue, location));
+}
+
+// Pushes frame->closure->captures[slot].
+void emitGetCapture(Assembler* as, int slot) {
+  emitLoad(as, RAX, FRAME_REG, offsetof(CallFrame, closure));
+  emitLoad(as, RAX, RAX, offsetof(ObjClosure, captures));
+  emitLoad(as, RAX, RAX, sizeof(Value) * slot);
+  emitPush(as, RAX);
+}
+
+// Loads the address of the global variable in [slot] into R9 and its value
+// into RAX, clobbering RCX. Returns the jump to patch, which is taken if the
+// variable hasn't been defined. The globals array can move when a new
+// global is added, so it is found through vm each time.
+int emitLoadGlobal(Assembler* as, int slot) {
+  emitLoad(as, R9, VM_REG,
+           offsetof(VM, globalValues) + offsetof(ValueArray, values));
+  emitAluImmediate(as, IMM_ADD, R9, sizeof(Value) * slot);
+  emitLoad(as, RAX, R9, 0);
+  emitMoveImmediate(as, RCX, UNDEFINED_VAL);
+  emitAlu(as, ALU_CMP, RAX, RCX);
+  return emitJump(as, CC_E);
+}
+
+// Jumps if the value in [reg] is not a number, clobbering RDX. Returns the
+// jump to patch.
+int emitJumpIfNotNumber(Assembler* as, Register reg) {
+  emitAlu(as, ALU_MOV, RDX, reg);
+  emitAlu(as, ALU_AND, RDX, QNAN_REG);
+  emitAlu(as, ALU_CMP, RDX, QNAN_REG);
+  return emitJump(as, CC_E);
+}
+
+// Turns the 0 or 1 in al into a Lox Boolean in RAX.
+void emitBoolFromAl(Assembler* as) {
+  // movzx eax, al
+  emitBytes(as, 0x0f, 0xb6);
+  emitModRm(as, RAX, RAX);
+  emitMoveImmediate(as, RCX, FALSE_VAL);
+  emitAlu(as, ALU_ADD, RAX, RCX);
+}
+
+// Leaves 1 in al if the top two values on the stack are equal according to
+// valuesEqual(), or 0 if not.
+void emitValuesEqual(Assembler* as) {
+  emitPeek(as, RAX, 1);
+  emitPeek(as, RCX, 0);
+  int aNotNumber = emitJumpIfNotNumber(as, RAX);
+  int bNotNumber = emitJumpIfNotNumber(as, RCX);
+
+  // Numbers compare as doubles, so that NaN isn't equal to itself.
+  emitMoveToXmm(as, 0, RAX);
+  emitMoveToXmm(as, 1, RCX);
+  emitCompareDoubles(as, 0, 1);
+  emitSetAl(as, CC_E);
+  emitBytes(as, 0x0f, 0x90 + CC_NP); // setnp cl
+  emitModRm(as, 0, RCX);
+  emitBytes(as, 0x20, 0xc8); // and al, cl
+  int done = emitJump(as, CC_ALWAYS);
+
+  patchJump(as, aNotNumber);
+  patchJump(as, bNotNumber);
+  emitAlu(as, ALU_CMP, RAX, RCX);
+  emitSetAl(as, CC_E);
+  patchJump(as, done);
+}
+
+// Leaves the flags "below or equal" if [reg] holds nil or false.
+void emitTestFalsey(Assembler* as, Register reg) {
+  emitMoveImmediate(as, RCX, NIL_VAL);
+  emitAlu(as, ALU_SUB, reg, RCX);
+  // FALSE_VAL is right after NIL_VAL.
+  emitAluImmediate(as, IMM_CMP, reg, 1);
+}
+
+// Calls [helper] with up to two arguments. Before the call, it writes back
+// the stack top and points the frame's ip at [ip], past the current
+// instruction, as run() does before calling out. If [checked], the helper
+// returns false on a runtime error, and the compiled code bails out.
+void emitRuntimeCall(Assembler* as, uint8_t* ip, uint64_t helper,
+                     uint64_t arg1, uint64_t arg2, bool checked) {
+  emitStore(as, VM_REG, offsetof(VM, stackTop), STACK_REG);
+  emitMoveImmediate(as, RAX, ADDRESS(ip));
+  emitStore(as, FRAME_REG, offsetof(CallFrame, ip), RAX);
+
+  emitMoveImmediate(as, RDI, arg1);
+  emitMoveImmediate(as, RSI, arg2);
+  emitCallAddress(as, helper);
+
+  if (checked) {
+    emitBytes(as, 0x84, 0xc0); // test al, al
+    emitJumpTo(as, CC_E, as->exitError);
+  }
+
+  emitLoad(as, STACK_REG, VM_REG, offsetof(VM, stackTop));
+}
+
+// The code shared by all of the compiled code's exits, then the entry point
+// that sets up the registers and jumps to where the frame resumes.
+int emitEntryAndExits(Assembler* as) {
+  static const Register saved[] = { RBX, R12, R13, R14, R15 };
+  int savedCount = sizeof(saved) / sizeof(saved[0]);
+
+  as->exitOk = as->count;
+  emitBytes(as, 0x31, 0xc0); // xor eax, eax
+  int restore = as->count;
+  for (int i = savedCount - 1; i >= 0; i--) emitPopRegister(as, saved[i]);
+  emitByte(as, 0xc3); // ret
+
+  as->exitError = as->count;
+  emitByte(as, 0xb8); // mov eax, imm32
+  emitInt32(as, INTERPRET_RUNTIME_ERROR);
+  emitJumpTo(as, CC_ALWAYS, restore);
+
+  as->exitSuspended = as->count;
+  emitByte(as, 0xb8); // mov eax, imm32
+  emitInt32(as, INTERPRET_SUSPENDED);
+  emitJumpTo(as, CC_ALWAYS, restore);
+
+  // Pushing five registers on top of the return address leaves the stack
+  // 16-byte aligned for calls, as the System V ABI wants.
+  int entry = as->count;
+  for (int i = 0; i < savedCount; i++) emitPushRegister(as, saved[i]);
+  emitAlu(as, ALU_MOV, FRAME_REG, RDI);
+  emitMoveImmediate(as, VM_REG, ADDRESS(&vm));
+  emitMoveImmediate(as, QNAN_REG, QNAN);
+  emitLoad(as, STACK_REG, VM_REG, offsetof(VM, stackTop));
+  emitLoad(as, SLOTS_REG, FRAME_REG, offsetof(CallFrame, slots));
+  emitBytes(as, 0xff, 0xe6); // jmp rsi
+  return entry;
+}
+
+// Compiled code is packed into large regions of memory, so that calls
+// between small functions don't keep landing on new pages. Code is never
+// freed on its own, only all at once when the VM is.
+typedef struct CodeRegion {
+  struct CodeRegion* next;
+  uint8_t* start;
+  size_t size;
+  size_t used;
+} CodeRegion;
+
+#define CODE_REGION_SIZE (1024 * 1024)
+
+static CodeRegion* codeRegions = NULL;
+
+// Copies the code into executable memory. Returns NULL on failure.
+uint8_t* makeExecutable(Assembler* as) {
+  size_t size = ((size_t)as->count + 15) & ~(size_t)15;
+  CodeRegion* region = codeRegions;
+  if (region == NULL || region->used + size > region->size) {
+    size_t regionSize = size > CODE_REGION_SIZE ? size : CODE_REGION_SIZE;
+    uint8_t* start = mmap(NULL, regionSize, PROT_READ | PROT_EXEC,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (start == MAP_FAILED) return NULL;
+
+    region = ALLOCATE(CodeRegion, 1);
+    region->next = codeRegions;
+    region->start = start;
+    region->size = regionSize;
+    region->used = 0;
+    codeRegions = region;
+  }
+
+  // The pages being copied into are never writable and executable at once.
+  uint8_t* code = region->start + region->used;
+  uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uint8_t* firstPage = (uint8_t*)((uintptr_t)code & ~(pageSize - 1));
+  size_t length = (size_t)(code + as->count - firstPage);
+  if (mprotect(firstPage, length, PROT_READ | PROT_WRITE) != 0) return NULL;
+  memcpy(code, as->code, as->count);
+  if (mprotect(firstPage, length, PROT_READ | PROT_EXEC) != 0) exit(1);
+
+  region->used += size;
+  return code;
+}
+
+void freeExecutableCode() {
+  while (codeRegions != NULL) {
+    CodeRegion* next = codeRegions->next;
+    munmap(codeRegions->start, codeRegions->size);
+    FREE(CodeRegion, codeRegions);
+    codeRegions = next;
+  }
+}
+#endif
+//< Optimization omit
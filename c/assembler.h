@@ -0,0 +1,134 @@
+//> Optimization omit
+#ifndef clox_assembler_h
+#define clox_assembler_h
+
+#include "common.h"
+#include "value.h"
+
+#ifdef BASELINE_JIT
+// An x86-64 machine code assembler shared by the baseline JIT and the
+// tracing JIT, along with the code templates both use to work with the VM's
+// stack.
+
+// The x86-64 general purpose registers, numbered as in their encodings.
+typedef enum {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15
+} Register;
+
+// Where compiled code keeps its state. These are all callee-saved, so they
+// survive calls to the helpers.
+#define FRAME_REG RBX     // The running CallFrame.
+#define STACK_REG R12     // Where the next value pushed will go.
+#define SLOTS_REG R13     // The frame's slots.
+#define VM_REG R14        // &vm.
+#define QNAN_REG R15      // QNAN, for checking if a value is a number.
+
+// The condition codes used with jcc and setcc.
+typedef enum {
+  CC_B = 0x2,
+  CC_AE = 0x3,
+  CC_E = 0x4,
+  CC_NE = 0x5,
+  CC_BE = 0x6,
+  CC_A = 0x7,
+  CC_P = 0xa,
+  CC_NP = 0xb,
+  CC_LE = 0xe,
+  CC_G = 0xf,
+  CC_ALWAYS = -1 // An unconditional jmp.
+} Condition;
+
+// Opcodes of the ALU instructions in their "op r/m64, r64" form.
+typedef enum {
+  ALU_ADD = 0x01,
+  ALU_OR = 0x09,
+  ALU_AND = 0x21,
+  ALU_SUB = 0x29,
+  ALU_XOR = 0x31,
+  ALU_CMP = 0x39,
+  ALU_TEST = 0x85,
+  ALU_MOV = 0x89
+} AluOp;
+
+// The opcode extensions of the same instructions with an immediate operand.
+typedef enum {
+  IMM_ADD = 0,
+  IMM_AND = 4,
+  IMM_SUB = 5,
+  IMM_CMP = 7
+} ImmOp;
+
+// SSE2 scalar double instructions, after their F2 0F prefix.
+typedef enum {
+  SSE_ADD = 0x58,
+  SSE_MUL = 0x59,
+  SSE_SUB = 0x5c,
+  SSE_DIV = 0x5e
+} SseOp;
+
+typedef struct {
+  uint8_t* code;
+  int count;
+  int capacity;
+
+  // The shared code that returns to run().
+  int exitOk;
+  int exitError;
+  int exitSuspended;
+} Assembler;
+
+#define ADDRESS(pointer) ((uint64_t)(uintptr_t)(pointer))
+
+void initAssembler(Assembler* as);
+void freeAssembler(Assembler* as);
+
+void emitByte(Assembler* as, uint8_t byte);
+void emitBytes(Assembler* as, uint8_t byte1, uint8_t byte2);
+void emitInt32(Assembler* as, uint32_t value);
+void emitModRm(Assembler* as, int reg, int rm);
+void emitMoveImmediate(Assembler* as, Register dst, uint64_t value);
+void emitLoad(Assembler* as, Register dst, Register base, int32_t offset);
+void emitLoad32(Assembler* as, Register dst, Register base, int32_t offset);
+void emitStore(Assembler* as, Register base, int32_t offset, Register src);
+void emitAlu(Assembler* as, AluOp op, Register dst, Register src);
+void emitAluImmediate(Assembler* as, ImmOp op, Register dst, int32_t value);
+void emitAluMemory32(Assembler* as, ImmOp op, Register base, int32_t offset,
+                     int8_t value);
+void emitAluMemory64(Assembler* as, ImmOp op, Register base, int32_t offset,
+                     int8_t value);
+void emitShiftLeft(Assembler* as, Register reg, uint8_t count);
+void emitCallAddress(Assembler* as, uint64_t address);
+void emitSetAl(Assembler* as, Condition condition);
+void emitMoveToXmm(Assembler* as, int xmm, Register src);
+void emitMoveFromXmm(Assembler* as, Register dst, int xmm);
+void emitSse(Assembler* as, SseOp op, int dst, int src);
+void emitCompareDoubles(Assembler* as, int a, int b);
+
+int emitJump(Assembler* as, Condition condition);
+void patchJumpTo(Assembler* as, int patch, int target);
+void patchJump(Assembler* as, int patch);
+void emitJumpTo(Assembler* as, Condition condition, int target);
+
+void emitPush(Assembler* as, Register reg);
+void emitPeek(Assembler* as, Register dst, int distance);
+void emitDrop(Assembler* as, int count);
+void emitPushConstant(Assembler* as, Value value);
+void emitGetLocal(Assembler* as, int slot);
+void emitUpvalueLocation(Assembler* as, Register dst, int slot);
+void emitGetCapture(Assembler* as, int slot);
+int emitLoadGlobal(Assembler* as, int slot);
+int emitJumpIfNotNumber(Assembler* as, Register reg);
+void emitBoolFromAl(Assembler* as);
+void emitValuesEqual(Assembler* as);
+void emitTestFalsey(Assembler* as, Register reg);
+void emitRuntimeCall(Assembler* as, uint8_t* ip, uint64_t helper,
+                     uint64_t arg1, uint64_t arg2, bool checked);
+int emitEntryAndExits(Assembler* as);
+
+uint8_t* makeExecutable(Assembler* as);
+void freeExecutableCode();
+#endif
+
+#endif
+//< Optimization omit
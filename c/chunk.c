@@ -19,6 +19,26 @@ void initChunk(Chunk* chunk) {
 //> chunk-init-constant-array
   initValueArray(&chunk->constants);
 //< chunk-init-constant-array
+//> Optimization omit
+#ifdef DISPATCH_THREADED
+  chunk->threaded = NULL;
+#endif
+#ifdef REGISTER_VM
+  chunk->registers = NULL;
+#endif
+  chunk->loopCount = 0;
+  chunk->loopCapacity = 0;
+  chunk->loops = NULL;
+  chunk->invokeCacheCount = 0;
+  chunk->invokeCacheCapacity = 0;
+  chunk->invokeCaches = NULL;
+  chunk->propertyCacheCount = 0;
+  chunk->propertyCacheCapacity = 0;
+  chunk->propertyCaches = NULL;
+  chunk->callCacheCount = 0;
+  chunk->callCacheCapacity = 0;
+  chunk->callCaches = NULL;
+//< Optimization omit
 }
 //> free-chunk
 void freeChunk(Chunk* chunk) {
@@ -29,6 +49,26 @@ void freeChunk(Chunk* chunk) {
 //> chunk-free-constants
   freeValueArray(&chunk->constants);
 //< chunk-free-constants
+//> Optimization omit
+#ifdef DISPATCH_THREADED
+  if (chunk->threaded != NULL) {
+    FREE_ARRAY(ThreadedCode, chunk->threaded, chunk->count);
+  }
+#endif
+#ifdef REGISTER_VM
+  if (chunk->registers != NULL) {
+    RegisterChunk* registers = chunk->registers;
+    FREE_ARRAY(Instruction, registers->code, registers->count);
+    FREE_ARRAY(int, registers->lines, registers->count);
+    FREE(RegisterChunk, registers);
+  }
+#endif
+  FREE_ARRAY(Loop, chunk->loops, chunk->loopCapacity);
+  FREE_ARRAY(InvokeCache, chunk->invokeCaches, chunk->invokeCacheCapacity);
+  FREE_ARRAY(PropertyCache, chunk->propertyCaches,
+             chunk->propertyCacheCapacity);
+  FREE_ARRAY(CallCache, chunk->callCaches, chunk->callCacheCapacity);
+//< Optimization omit
   initChunk(chunk);
 }
 //< free-chunk
@@ -69,3 +109,150 @@ int addConstant(Chunk* chunk, Value value) {
   return chunk->constants.count - 1;
 }
 //< add-constant
+//> Optimization omit
+// Returns the index of a new loop whose header is at [header], or
+// LOOP_UNTRACKED if the chunk has run out of indexes.
+int addLoop(Chunk* chunk, int header) {
+  if (chunk->loopCount == LOOP_UNTRACKED) return LOOP_UNTRACKED;
+
+  if (chunk->loopCapacity < chunk->loopCount + 1) {
+    int oldCapacity = chunk->loopCapacity;
+    chunk->loopCapacity = GROW_CAPACITY(oldCapacity);
+    chunk->loops = GROW_ARRAY(Loop, chunk->loops,
+        oldCapacity, chunk->loopCapacity);
+  }
+
+  Loop* loop = &chunk->loops[chunk->loopCount];
+  loop->header = header;
+  loop->backEdges = 0;
+  loop->hotAt = vm.hotLoopThreshold;
+  loop->optimized = NULL;
+  loop->traceFailures = 0;
+  return chunk->loopCount++;
+}
+
+// Returns the index of a new, empty inline cache for a call site, or
+// INVOKE_UNCACHED if the chunk has run out of indexes.
+int addInvokeCache(Chunk* chunk) {
+  if (chunk->invokeCacheCount == INVOKE_UNCACHED) return INVOKE_UNCACHED;
+
+  if (chunk->invokeCacheCapacity < chunk->invokeCacheCount + 1) {
+    int oldCapacity = chunk->invokeCacheCapacity;
+    chunk->invokeCacheCapacity = GROW_CAPACITY(oldCapacity);
+    chunk->invokeCaches = GROW_ARRAY(InvokeCache, chunk->invokeCaches,
+        oldCapacity, chunk->invokeCacheCapacity);
+  }
+
+  InvokeCache* cache = &chunk->invokeCaches[chunk->invokeCacheCount];
+  cache->count = 0;
+  cache->epoch = vm.methodEpoch;
+  return chunk->invokeCacheCount++;
+}
+
+// Returns the index of a new, empty property cache, or PROPERTY_UNCACHED if
+// the chunk has run out of indexes.
+int addPropertyCache(Chunk* chunk) {
+  if (chunk->propertyCacheCount == PROPERTY_UNCACHED) {
+    return PROPERTY_UNCACHED;
+  }
+
+  if (chunk->propertyCacheCapacity < chunk->propertyCacheCount + 1) {
+    int oldCapacity = chunk->propertyCacheCapacity;
+    chunk->propertyCacheCapacity = GROW_CAPACITY(oldCapacity);
+    chunk->propertyCaches = GROW_ARRAY(PropertyCache, chunk->propertyCaches,
+        oldCapacity, chunk->propertyCacheCapacity);
+  }
+
+  PropertyCache* cache = &chunk->propertyCaches[chunk->propertyCacheCount];
+  cache->shape = NULL;
+  cache->slot = 0;
+  cache->transition = NULL;
+  return chunk->propertyCacheCount++;
+}
+
+// Returns the index of a new, empty call cache, or CALL_UNCACHED if the
+// chunk has run out of indexes.
+int addCallCache(Chunk* chunk) {
+  if (chunk->callCacheCount == CALL_UNCACHED) return CALL_UNCACHED;
+
+  if (chunk->callCacheCapacity < chunk->callCacheCount + 1) {
+    int oldCapacity = chunk->callCacheCapacity;
+    chunk->callCacheCapacity = GROW_CAPACITY(oldCapacity);
+    chunk->callCaches = GROW_ARRAY(CallCache, chunk->callCaches,
+        oldCapacity, chunk->callCacheCapacity);
+  }
+
+  chunk->callCaches[chunk->callCacheCount].closure = NULL;
+  return chunk->callCacheCount++;
+}
+
+int instructionLength(Chunk* chunk, int offset) {
+  switch ((OpCode)chunk->code[offset]) {
+    case OP_NIL:
+    case OP_TRUE:
+    case OP_FALSE:
+    case OP_POP:
+    case OP_EQUAL:
+    case OP_GREATER:
+    case OP_LESS:
+    case OP_ADD:
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+    case OP_NOT:
+    case OP_NEGATE:
+    case OP_PRINT:
+    case OP_CLOSE_UPVALUE:
+    case OP_RETURN:
+    case OP_INHERIT:
+      return 1;
+
+    case OP_CONSTANT:
+    case OP_GET_LOCAL:
+    case OP_SET_LOCAL:
+    case OP_GET_UPVALUE:
+    case OP_SET_UPVALUE:
+    case OP_GET_CAPTURE:
+    case OP_GET_SUPER:
+    case OP_CALL:
+    case OP_TAIL_CALL:
+    case OP_CLASS:
+    case OP_METHOD:
+    case OP_SUBTRACT_CONSTANT:
+      return 2;
+
+    case OP_GET_GLOBAL:
+    case OP_DEFINE_GLOBAL:
+    case OP_SET_GLOBAL:
+    case OP_CALL_GLOBAL:
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_GET_PROPERTY:
+    case OP_SET_PROPERTY:
+    case OP_GET_FIELD:
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER:
+    case OP_JUMP_IF_NOT_EQUAL:
+      return 3;
+
+    case OP_LOOP:
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_GET_LOCAL_FIELD:
+    case OP_INVOKE:
+    case OP_SUPER_INVOKE:
+      return 4;
+
+    case OP_CLOSURE: {
+      // Each captured variable adds an (isLocal, index) pair of operands,
+      // those captured by upvalue first and then those copied.
+      ObjFunction* function = AS_FUNCTION(
+          chunk->constants.values[chunk->code[offset + 1]]);
+      return 2 + (function->upvalueCount + function->captureCount) * 2;
+    }
+  }
+
+  return 1; // Unreachable.
+}
+//< Optimization omit
@@ -39,10 +39,18 @@ typedef enum {
   OP_GET_UPVALUE,
   OP_SET_UPVALUE,
 //< Closures upvalue-ops
+//> Optimization omit
+  OP_GET_CAPTURE,
+//< Optimization omit
 //> Classes and Instances property-ops
   OP_GET_PROPERTY,
   OP_SET_PROPERTY,
 //< Classes and Instances property-ops
+//> Optimization omit
+  OP_GET_LOCAL_PROPERTY,
+  OP_GET_FIELD,
+  OP_GET_LOCAL_FIELD,
+//< Optimization omit
 //> Superclasses get-super-op
   OP_GET_SUPER,
 //< Superclasses get-super-op
@@ -53,7 +61,14 @@ typedef enum {
 //< Types of Values comparison-ops
 //> A Virtual Machine binary-ops
   OP_ADD,
+//> Optimization omit
+  OP_ADD_NUMBER,
+  OP_ADD_STRING,
+//< Optimization omit
   OP_SUBTRACT,
+//> Optimization omit
+  OP_SUBTRACT_CONSTANT,
+//< Optimization omit
   OP_MULTIPLY,
   OP_DIVIDE,
 //> Types of Values not-op
@@ -72,12 +87,21 @@ typedef enum {
 //> Jumping Back and Forth jump-if-false-op
   OP_JUMP_IF_FALSE,
 //< Jumping Back and Forth jump-if-false-op
+//> Optimization omit
+  OP_JUMP_IF_NOT_LESS,
+  OP_JUMP_IF_NOT_GREATER,
+  OP_JUMP_IF_NOT_EQUAL,
+//< Optimization omit
 //> Jumping Back and Forth loop-op
   OP_LOOP,
 //< Jumping Back and Forth loop-op
 //> Calls and Functions op-call
   OP_CALL,
 //< Calls and Functions op-call
+//> Optimization omit
+  OP_TAIL_CALL,
+  OP_CALL_GLOBAL,
+//< Optimization omit
 //> Methods and Initializers invoke-op
   OP_INVOKE,
 //< Methods and Initializers invoke-op
@@ -102,6 +126,164 @@ typedef enum {
 //< Methods and Initializers method-op
 } OpCode;
 //< op-enum
+//> Optimization omit
+
+#ifdef DISPATCH_THREADED
+// In direct-threaded mode, each chunk is translated into an array with one
+// cell per byte of bytecode. The cell at the start of an instruction holds
+// the address of its handler in run() and the cells after it hold the
+// operand bytes. Keeping the same layout as the bytecode means jump offsets
+// and line numbers carry over unchanged.
+typedef union {
+  void* handler;
+  uint8_t operand;
+} ThreadedCode;
+#endif
+
+#ifdef REGISTER_VM
+// The register-based instruction set. Each instruction is a 32-bit word
+// holding the opcode in its low byte and up to three byte operands, A, B,
+// and C, above it. Registers are the slots of the function's call frame, so
+// R[0] is the callee and R[1] onward its parameters and locals. K[n] is the
+// chunk's nth constant. Jumps are followed by a word with the signed offset
+// of their target, relative to the next instruction, property accesses and
+// invokes by a word with the index of their inline cache, and closures by
+// one word for each variable they capture.
+typedef enum {
+  REG_MOVE,             // R[A] = R[B]
+  REG_LOAD_CONSTANT,    // R[A] = K[B]
+  REG_LOAD_NIL,         // R[A] = nil
+  REG_LOAD_TRUE,        // R[A] = true
+  REG_LOAD_FALSE,       // R[A] = false
+  REG_GET_GLOBAL,       // R[A] = globals[BC]
+  REG_DEFINE_GLOBAL,    // globals[BC] = R[A]
+  REG_SET_GLOBAL,       // globals[BC] = R[A], if it exists
+  REG_GET_UPVALUE,      // R[A] = upvalues[B]
+  REG_SET_UPVALUE,      // upvalues[B] = R[A]
+  REG_GET_CAPTURE,      // R[A] = captures[B]
+  REG_GET_PROPERTY,     // R[A] = R[B].K[C]
+  REG_SET_PROPERTY,     // R[A].K[B] = R[C], then R[A] = R[C]
+  REG_GET_SUPER,        // R[A] = R[A] bound to method K[C] of R[B]
+  REG_EQUAL,            // R[A] = R[B] == R[C]
+  REG_GREATER,          // R[A] = R[B] > R[C]
+  REG_LESS,             // R[A] = R[B] < R[C]
+  REG_ADD,              // R[A] = R[B] + R[C]
+  REG_SUBTRACT,         // R[A] = R[B] - R[C]
+  REG_MULTIPLY,         // R[A] = R[B] * R[C]
+  REG_DIVIDE,           // R[A] = R[B] / R[C]
+  REG_EQUAL_K,          // R[A] = R[B] == K[C]
+  REG_GREATER_K,        // R[A] = R[B] > K[C]
+  REG_LESS_K,           // R[A] = R[B] < K[C]
+  REG_ADD_K,            // R[A] = R[B] + K[C]
+  REG_SUBTRACT_K,       // R[A] = R[B] - K[C]
+  REG_MULTIPLY_K,       // R[A] = R[B] * K[C]
+  REG_DIVIDE_K,         // R[A] = R[B] / K[C]
+  REG_NOT,              // R[A] = !R[B]
+  REG_NEGATE,           // R[A] = -R[B]
+  REG_PRINT,            // print R[A]
+  REG_JUMP,             // jump, counting a back-edge of loop A
+  REG_JUMP_IF_FALSE,    // if R[A] is falsey, jump
+  REG_JUMP_IF_NOT_LESS, // unless R[B] < R[C], R[A] = false and jump
+  REG_JUMP_IF_NOT_GREATER,
+  REG_JUMP_IF_NOT_EQUAL,
+  REG_JUMP_IF_NOT_LESS_K, // unless R[B] < K[C], R[A] = false and jump
+  REG_JUMP_IF_NOT_GREATER_K,
+  REG_JUMP_IF_NOT_EQUAL_K,
+  REG_CALL,             // R[A] = R[A](R[A+1] ... R[A+B])
+  REG_TAIL_CALL,        // REG_CALL that may reuse the frame for the callee
+  REG_INVOKE,           // R[A] = R[A].K[B](R[A+1] ... R[A+C])
+  REG_SUPER_INVOKE,     // R[A] = super K[B] of R[A+C+1] on R[A] ... R[A+C]
+  REG_CLOSURE,          // R[A] = closure of K[B]
+  REG_CLOSE_UPVALUE,    // close upvalues capturing R[A] or above
+  REG_RETURN,           // return R[A]
+  REG_CLASS,            // R[A] = class named K[B]
+  REG_INHERIT,          // copy methods of superclass R[A] into R[B]
+  REG_METHOD            // add R[C] to class R[A] as method K[B]
+} RegisterOpCode;
+
+typedef uint32_t Instruction;
+
+#define REG_INSTRUCTION(op, a, b, c) \
+    ((Instruction)(op) | ((Instruction)(a) << 8) | \
+     ((Instruction)(b) << 16) | ((Instruction)(c) << 24))
+#define REG_OP(instruction) ((instruction) & 0xff)
+#define REG_A(instruction) (((instruction) >> 8) & 0xff)
+#define REG_B(instruction) (((instruction) >> 16) & 0xff)
+#define REG_C(instruction) ((instruction) >> 24)
+// B and C taken together as one 16-bit operand.
+#define REG_BC(instruction) ((instruction) >> 16)
+
+// A function's code translated into register instructions. The chunk's
+// constant table is shared with the stack bytecode.
+typedef struct {
+  int count;
+  Instruction* code;
+  int* lines;
+  // How many registers a frame for this function uses.
+  int registerCount;
+} RegisterChunk;
+#endif
+
+// A loop in a chunk, identified by the index operand of the OP_LOOP
+// instruction that jumps back to its header. Chunks with more loops than an
+// operand can index leave the rest untracked.
+#define LOOP_UNTRACKED UINT8_MAX
+
+typedef struct {
+  // The bytecode offset that the loop jumps back to.
+  int header;
+  // How many times the interpreter has jumped back to the header.
+  unsigned int backEdges;
+  // The back-edge count at which the loop is next hot. A hot loop hook can
+  // push it back to try again later.
+  unsigned int hotAt;
+  // Code the hot loop hook installed for the loop, or NULL.
+  void* optimized;
+  // How many times recording or running a trace of the loop has failed.
+  int traceFailures;
+} Loop;
+
+// An inline cache for an OP_INVOKE or OP_SUPER_INVOKE call site, identified
+// by the instruction's last operand the same way loops are. It maps each
+// class the site has called a method on to the method it found, so calls
+// on those classes skip the hash lookups. A site that sees more classes than
+// the cache holds looks up the rest each time. Chunks with more call sites
+// than an operand can index leave the rest uncached.
+#define INVOKE_CACHE_SIZE 4
+#define INVOKE_UNCACHED UINT8_MAX
+
+typedef struct {
+  int count;
+  struct sObjClass* classes[INVOKE_CACHE_SIZE];
+  struct sObjClosure* methods[INVOKE_CACHE_SIZE];
+  // The entries are only valid while this matches vm.methodEpoch.
+  unsigned int epoch;
+} InvokeCache;
+
+// An inline cache for an instruction that gets or sets a property, also
+// identified by its last operand. It remembers the shape of the last
+// instance whose field the instruction found and the slot the field is in.
+// For a set that added the field, [transition] is the shape the instance
+// moved to. Shapes never change, so the cache never goes stale.
+#define PROPERTY_UNCACHED UINT8_MAX
+
+typedef struct {
+  struct sObjShape* shape;
+  int slot;
+  struct sObjShape* transition;
+} PropertyCache;
+
+// An inline cache for an OP_CALL_GLOBAL call site, identified by its last
+// operand. It holds the closure the site last called, which takes as many
+// arguments as the site passes. Top-level functions are rarely reassigned,
+// so a call finding the same closure in the global again can go straight
+// to it.
+#define CALL_UNCACHED UINT8_MAX
+
+typedef struct {
+  struct sObjClosure* closure;
+} CallCache;
+//< Optimization omit
 //> chunk-struct
 
 typedef struct {
@@ -116,6 +298,28 @@ typedef struct {
 //> chunk-constants
   ValueArray constants;
 //< chunk-constants
+//> Optimization omit
+#ifdef DISPATCH_THREADED
+  // Lazily created the first time the chunk is executed.
+  ThreadedCode* threaded;
+#endif
+#ifdef REGISTER_VM
+  // NULL if the function could not be translated and runs on the stack VM.
+  RegisterChunk* registers;
+#endif
+  int loopCount;
+  int loopCapacity;
+  Loop* loops;
+  int invokeCacheCount;
+  int invokeCacheCapacity;
+  InvokeCache* invokeCaches;
+  int propertyCacheCount;
+  int propertyCacheCapacity;
+  PropertyCache* propertyCaches;
+  int callCacheCount;
+  int callCacheCapacity;
+  CallCache* callCaches;
+//< Optimization omit
 } Chunk;
 //< chunk-struct
 //> init-chunk-h
@@ -134,5 +338,12 @@ void writeChunk(Chunk* chunk, uint8_t byte, int line);
 //> add-constant-h
 int addConstant(Chunk* chunk, Value value);
 //< add-constant-h
+//> Optimization omit
+int addLoop(Chunk* chunk, int header);
+int addInvokeCache(Chunk* chunk);
+int addPropertyCache(Chunk* chunk);
+int addCallCache(Chunk* chunk);
+int instructionLength(Chunk* chunk, int offset);
+//< Optimization omit
 
 #endif
@@ -26,6 +26,63 @@
 
 #define UINT8_COUNT (UINT8_MAX + 1)
 //< Local Variables uint8-count
+//> Optimization omit
+
+// How run() dispatches instructions. Define one of DISPATCH_SWITCH,
+// DISPATCH_COMPUTED_GOTO, or DISPATCH_THREADED when building to pick a
+// strategy. Otherwise, use computed goto if the compiler supports labels as
+// values.
+#if !defined(DISPATCH_SWITCH) && !defined(DISPATCH_COMPUTED_GOTO) && \
+    !defined(DISPATCH_THREADED)
+#ifdef __GNUC__
+#define DISPATCH_COMPUTED_GOTO
+#else
+#define DISPATCH_SWITCH
+#endif
+#endif
+
+// Whether run() keeps the value on top of the stack in a local, where the C
+// compiler can hold it in a register, and only spills it to vm.stack when the
+// GC or a call needs to see the whole stack. Define NO_CACHE_TOP_OF_STACK
+// when building to keep every value in memory instead.
+#ifndef NO_CACHE_TOP_OF_STACK
+#define CACHE_TOP_OF_STACK
+#endif
+
+// How many calls make a function hot, and how many jumps back to its header
+// make a loop hot. The VM counts both, and calls its tier-up hooks when a
+// count reaches its threshold. These are the defaults for
+// vm.hotCallThreshold and vm.hotLoopThreshold. Define DEBUG_LOG_TIERING when
+// building to log when code gets hot.
+#ifndef HOT_CALL_THRESHOLD
+#define HOT_CALL_THRESHOLD 100
+#endif
+#ifndef HOT_LOOP_THRESHOLD
+#define HOT_LOOP_THRESHOLD 50
+#endif
+
+// Whether hot functions are compiled to machine code. The baseline JIT only
+// targets x86-64 Linux and relies on the NaN-boxed value representation.
+// Define NO_JIT when building to run everything in the interpreter instead,
+// and HOT_CALL_THRESHOLD=0 to compile every function before its first call.
+#if defined(__x86_64__) && defined(__linux__) && defined(NAN_BOXING) && \
+    !defined(NO_JIT) && !defined(REGISTER_VM) && !defined(AOT_RUNTIME)
+#define BASELINE_JIT
+#endif
+
+// Whether hot loops run in the interpreter are recorded and compiled into
+// traces. The tracing JIT shares the baseline JIT's assembler, so it needs
+// BASELINE_JIT too. Define NO_TRACE_JIT when building to only compile whole
+// functions.
+#if defined(BASELINE_JIT) && !defined(NO_TRACE_JIT)
+#define TRACE_JIT
+#endif
+
+// Programs compiled ahead of time to C with "clox --emit-c" are built with
+// AOT_RUNTIME defined, against the same sources minus main.c. Their functions
+// are all native code from the start, so the bytecode is never run and the
+// JITs are left out.
+//< Optimization omit
 
 #endif
 //> omit
@@ -13,6 +13,9 @@
 #include "memory.h"
 //< Garbage Collection compiler-include-memory
 #include "scanner.h"
+//> Optimization omit
+#include "vm.h"
+//< Optimization omit
 //> Compiling Expressions include-debug
 
 #ifdef DEBUG_PRINT_CODE
@@ -72,12 +75,26 @@ typedef struct {
 //> Closures is-captured-field
   bool isCaptured;
 //< Closures is-captured-field
+//> Optimization omit
+  // The function a local function declaration's closure runs, and whether
+  // the closure is used for anything but being called by the declaring
+  // function or itself. If it isn't, it can't outlive the declaring
+  // function's frame.
+  ObjFunction* function;
+  bool escapes;
+//< Optimization omit
 } Local;
 //< Local Variables local-struct
 //> Closures upvalue-struct
 typedef struct {
   uint8_t index;
   bool isLocal;
+//> Optimization omit
+  // Whether the closure copies the variable's value instead of capturing
+  // it. The index is then into the closure's copies, or its enclosing
+  // closure's when the variable isn't local.
+  bool byValue;
+//< Optimization omit
 } Upvalue;
 //< Closures upvalue-struct
 //> Calls and Functions function-type-enum
@@ -112,6 +129,15 @@ typedef struct Compiler {
   Upvalue upvalues[UINT8_COUNT];
 //< Closures upvalues-array
   int scopeDepth;
+//> Optimization omit
+  // Offset of the last instruction that a superinstruction may be fused
+  // onto, or -1 if there is none. Patching a forward jump clears it since the
+  // jump may land between that instruction and the next one. Loops don't
+  // need to, because a loop always starts a fresh expression or statement.
+  int lastInstruction;
+  // The local variable the last call read its callee from, or -1.
+  int lastCallee;
+//< Optimization omit
 } Compiler;
 //< Local Variables compiler-struct
 //> Methods and Initializers class-compiler-struct
@@ -135,6 +161,19 @@ Compiler* current = NULL;
 
 ClassCompiler* currentClass = NULL;
 //< Methods and Initializers current-class
+//> Optimization omit
+
+// The names the program assigns to anywhere. A local variable whose name
+// isn't among them keeps the value it was initialized with, so closures can
+// copy it.
+typedef struct {
+  Token* names;
+  int count;
+  int capacity;
+} AssignedNames;
+
+AssignedNames assignedNames;
+//< Optimization omit
 //> Compiling Expressions compiling-chunk
 
 /* Compiling Expressions compiling-chunk < Calls and Functions current-chunk
@@ -234,11 +273,21 @@ static void emitBytes(uint8_t byte1, uint8_t byte2) {
 static void emitLoop(int loopStart) {
   emitByte(OP_LOOP);
 
+/* Jumping Back and Forth emit-loop < Optimization omit
   int offset = currentChunk()->count - loopStart + 2;
+*/
+//> Optimization omit
+  // The offset is relative to the end of the instruction, past the loop's
+  // index operand.
+  int offset = currentChunk()->count - loopStart + 3;
+//< Optimization omit
   if (offset > UINT16_MAX) error("Loop body too large.");
 
   emitByte((offset >> 8) & 0xff);
   emitByte(offset & 0xff);
+//> Optimization omit
+  emitByte(addLoop(currentChunk(), loopStart));
+//< Optimization omit
 }
 //< Jumping Back and Forth emit-loop
 //> Jumping Back and Forth emit-jump
@@ -249,6 +298,58 @@ static int emitJump(uint8_t instruction) {
   return currentChunk()->count - 2;
 }
 //< Jumping Back and Forth emit-jump
+//> Optimization omit
+// If the last instruction emitted was a [length]-byte [instruction], turns
+// it into the superinstruction [fused] and returns true. The caller then
+// emits any operands [fused] has beyond those it inherited.
+static bool fuseLastInstruction(OpCode instruction, int length,
+                                OpCode fused) {
+  Chunk* chunk = currentChunk();
+  int last = current->lastInstruction;
+  if (last == -1 || last != chunk->count - length ||
+      chunk->code[last] != instruction) {
+    return false;
+  }
+
+  chunk->code[last] = fused;
+  return true;
+}
+
+// Emits a jump taken when the condition on top of the stack is false. When
+// the condition is a comparison, the two are fused into a compare-and-branch
+// that pops the operands and pushes false only when it jumps, so the code at
+// the target sees the same stack as it would after OP_JUMP_IF_FALSE.
+static int emitJumpIfFalse() {
+  if (fuseLastInstruction(OP_LESS, 1, OP_JUMP_IF_NOT_LESS) ||
+      fuseLastInstruction(OP_GREATER, 1, OP_JUMP_IF_NOT_GREATER) ||
+      fuseLastInstruction(OP_EQUAL, 1, OP_JUMP_IF_NOT_EQUAL)) {
+    emitByte(0xff);
+    emitByte(0xff);
+    return currentChunk()->count - 2;
+  }
+
+  return emitJump(OP_JUMP_IF_FALSE);
+}
+
+// Pops the condition on the path that falls through a jump emitted by
+// emitJumpIfFalse(), unless a compare-and-branch already did.
+static void emitConditionPop() {
+  Chunk* chunk = currentChunk();
+  int last = current->lastInstruction;
+  if (last != -1 && last == chunk->count - 3) {
+    switch (chunk->code[last]) {
+      case OP_JUMP_IF_NOT_LESS:
+      case OP_JUMP_IF_NOT_GREATER:
+      case OP_JUMP_IF_NOT_EQUAL:
+        return;
+      default:
+        break;
+    }
+  }
+
+  emitByte(OP_POP);
+}
+//< Optimization omit
 //> Compiling Expressions emit-return
 static void emitReturn() {
 /* Calls and Functions return-nil < Methods and Initializers return-this
@@ -278,6 +379,9 @@ static uint8_t makeConstant(Value value) {
 //< Compiling Expressions make-constant
 //> Compiling Expressions emit-constant
 static void emitConstant(Value value) {
+//> Optimization omit
+  current->lastInstruction = currentChunk()->count;
+//< Optimization omit
   emitBytes(OP_CONSTANT, makeConstant(value));
 }
 //< Compiling Expressions emit-constant
@@ -292,6 +396,9 @@ static void patchJump(int offset) {
 
   currentChunk()->code[offset] = (jump >> 8) & 0xff;
   currentChunk()->code[offset + 1] = jump & 0xff;
+//> Optimization omit
+  current->lastInstruction = -1;
+//< Optimization omit
 }
 //< Jumping Back and Forth patch-jump
 //> Local Variables init-compiler
@@ -308,6 +415,10 @@ static void initCompiler(Compiler* compiler, FunctionType type) {
 //< Calls and Functions init-compiler
   compiler->localCount = 0;
   compiler->scopeDepth = 0;
+//> Optimization omit
+  compiler->lastInstruction = -1;
+  compiler->lastCallee = -1;
+//< Optimization omit
 //> Calls and Functions init-function
   compiler->function = newFunction();
 //< Calls and Functions init-function
@@ -326,6 +437,10 @@ static void initCompiler(Compiler* compiler, FunctionType type) {
 //> Closures init-zero-local-is-captured
   local->isCaptured = false;
 //< Closures init-zero-local-is-captured
+//> Optimization omit
+  local->function = NULL;
+  local->escapes = false;
+//< Optimization omit
 /* Calls and Functions init-function-slot < Methods and Initializers slot-zero
   local->name.start = "";
   local->name.length = 0;
@@ -342,6 +457,842 @@ static void initCompiler(Compiler* compiler, FunctionType type) {
 //< Calls and Functions init-function-slot
 }
 //< Local Variables init-compiler
+//> Optimization omit
+#ifdef REGISTER_VM
+// The register VM runs code translated from each function's finished stack
+// bytecode. The compiler always knows how deep the stack is, so every slot
+// an instruction pushes or pops is at a fixed offset in the call frame and
+// can be named as a register. Straight translation leaves behind the copies
+// that pushing locals and constants made, so a few passes then forward
+// operands through them and delete the ones nothing reads. That turns
+// `i = i + 1` into a single ADD_K. A function the translator can't handle
+// keeps running on the stack VM.
+
+typedef struct {
+  RegisterOpCode op;
+  int a;
+  int b;
+  int c;
+  // Offset of the stack instruction this was translated from.
+  int source;
+  // For jumps, the offset of the stack instruction jumped to and the stack
+  // depth there once any POPs at the target have run.
+  int target;
+  int targetDepth;
+  // The lowest the stack gets after this op and before the next one.
+  // Registers at or above it hold dead values.
+  int depth;
+  int line;
+  bool isLabel;
+  bool isDeleted;
+} RegisterOp;
+
+typedef struct {
+  Chunk* chunk;
+  RegisterOp* ops;
+  int count;
+  int capacity;
+  // Stack depth before each stack instruction, or -1 if not yet known.
+  int* depths;
+  // Index of the first op translated from each stack instruction or one
+  // after it.
+  int* firstOps;
+  // Registers any closure in the function captures as an upvalue.
+  bool captured[UINT8_COUNT];
+  int registerCount;
+  bool failed;
+} Translator;
+
+static bool isRegisterJump(RegisterOpCode op) {
+  return op >= REG_JUMP && op <= REG_JUMP_IF_NOT_EQUAL_K;
+}
+
+static bool isRegisterCall(RegisterOpCode op) {
+  return op == REG_CALL || op == REG_TAIL_CALL || op == REG_INVOKE ||
+         op == REG_SUPER_INVOKE;
+}
+
+// Returns the register [op] stores into, or -1 if it doesn't.
+static int registerWritten(RegisterOp* op) {
+  switch (op->op) {
+    case REG_DEFINE_GLOBAL:
+    case REG_SET_GLOBAL:
+    case REG_SET_UPVALUE:
+    case REG_PRINT:
+    case REG_JUMP:
+    case REG_JUMP_IF_FALSE:
+    case REG_CLOSE_UPVALUE:
+    case REG_RETURN:
+    case REG_INHERIT:
+    case REG_METHOD:
+      return -1;
+    default:
+      return op->a;
+  }
+}
+
+static bool readsRegister(Translator* translator, RegisterOp* op, int reg) {
+  switch (op->op) {
+    case REG_LOAD_CONSTANT:
+    case REG_LOAD_NIL:
+    case REG_LOAD_TRUE:
+    case REG_LOAD_FALSE:
+    case REG_GET_GLOBAL:
+    case REG_GET_UPVALUE:
+    case REG_GET_CAPTURE:
+    case REG_CLASS:
+    case REG_JUMP:
+      return false;
+    case REG_MOVE:
+    case REG_GET_PROPERTY:
+    case REG_NOT:
+    case REG_NEGATE:
+    case REG_EQUAL_K:
+    case REG_GREATER_K:
+    case REG_LESS_K:
+    case REG_ADD_K:
+    case REG_SUBTRACT_K:
+    case REG_MULTIPLY_K:
+    case REG_DIVIDE_K:
+    case REG_JUMP_IF_NOT_LESS_K:
+    case REG_JUMP_IF_NOT_GREATER_K:
+    case REG_JUMP_IF_NOT_EQUAL_K:
+      return op->b == reg;
+    case REG_DEFINE_GLOBAL:
+    case REG_SET_GLOBAL:
+    case REG_SET_UPVALUE:
+    case REG_PRINT:
+    case REG_JUMP_IF_FALSE:
+    case REG_CLOSE_UPVALUE:
+    case REG_RETURN:
+      return op->a == reg;
+    case REG_SET_PROPERTY:
+    case REG_METHOD:
+      return op->a == reg || op->c == reg;
+    case REG_GET_SUPER:
+    case REG_INHERIT:
+    case REG_EQUAL:
+    case REG_GREATER:
+    case REG_LESS:
+    case REG_ADD:
+    case REG_SUBTRACT:
+    case REG_MULTIPLY:
+    case REG_DIVIDE:
+    case REG_JUMP_IF_NOT_LESS:
+    case REG_JUMP_IF_NOT_GREATER:
+    case REG_JUMP_IF_NOT_EQUAL:
+      return op->b == reg || op->c == reg ||
+             (op->op == REG_GET_SUPER && op->a == reg) ||
+             (op->op == REG_INHERIT && op->a == reg);
+    case REG_CALL:
+    case REG_TAIL_CALL:
+      return reg >= op->a && reg <= op->a + op->b;
+    case REG_INVOKE:
+      return reg >= op->a && reg <= op->a + op->c;
+    case REG_SUPER_INVOKE:
+      return reg >= op->a && reg <= op->a + op->c + 1;
+    case REG_CLOSURE: {
+      Chunk* chunk = translator->chunk;
+      ObjFunction* function = AS_FUNCTION(chunk->constants.values[op->b]);
+      uint8_t* upvalues = &chunk->code[op->source + 2];
+      int count = function->upvalueCount + function->captureCount;
+      for (int i = 0; i < count; i++) {
+        if (upvalues[i * 2] && upvalues[i * 2 + 1] == reg) return true;
+      }
+      return false;
+    }
+  }
+
+  return true; // Unreachable.
+}
+
+static void addRegisterOp(Translator* translator, RegisterOpCode opCode,
+                          int a, int b, int c, int source, int depth) {
+  if (translator->capacity < translator->count + 1) {
+    int oldCapacity = translator->capacity;
+    translator->capacity = GROW_CAPACITY(oldCapacity);
+    translator->ops = GROW_ARRAY(RegisterOp, translator->ops,
+                                 oldCapacity, translator->capacity);
+  }
+
+  RegisterOp* op = &translator->ops[translator->count++];
+  op->op = opCode;
+  op->a = a;
+  op->b = b;
+  op->c = c;
+  op->source = source;
+  op->target = -1;
+  op->targetDepth = 0;
+  op->depth = depth;
+  op->line = translator->chunk->lines[source];
+  op->isLabel = false;
+  op->isDeleted = false;
+}
+
+static void recordJumpDepth(Translator* translator, int target, int depth) {
+  if (target > translator->chunk->count) {
+    translator->failed = true;
+  } else if (translator->depths[target] == -1) {
+    translator->depths[target] = depth;
+  } else if (translator->depths[target] != depth) {
+    translator->failed = true;
+  }
+}
+
+// Maps each stack instruction to the registers it works on. Returns false
+// if the function uses anything the register VM doesn't support.
+static bool translateInstructions(Translator* translator,
+                                  ObjFunction* function) {
+  Chunk* chunk = translator->chunk;
+  int depth = function->arity + 1;
+  bool isReachable = true;
+
+  for (int offset = 0; offset < chunk->count;) {
+    // Code after a jump or return is only reached by jumping to it, so the
+    // depth the jumps recorded wins over the fall through one.
+    if (translator->depths[offset] != -1) {
+      if (isReachable && translator->depths[offset] != depth) return false;
+      depth = translator->depths[offset];
+    }
+    translator->depths[offset] = depth;
+    translator->firstOps[offset] = translator->count;
+    isReachable = true;
+
+    uint8_t* code = &chunk->code[offset];
+    int length = instructionLength(chunk, offset);
+    int d = depth;
+#define ADD_OP(op, a, b, c, after) \
+    addRegisterOp(translator, op, a, b, c, offset, depth = (after))
+#define ADD_JUMP(op, a, b, c, after, jumpDepth, jump) \
+    do { \
+      ADD_OP(op, a, b, c, after); \
+      translator->ops[translator->count - 1].target = offset + length + \
+          (jump); \
+      recordJumpDepth(translator, offset + length + (jump), jumpDepth); \
+    } while (false)
+
+    switch (code[0]) {
+      case OP_CONSTANT: ADD_OP(REG_LOAD_CONSTANT, d, code[1], 0, d + 1); break;
+      case OP_NIL:      ADD_OP(REG_LOAD_NIL, d, 0, 0, d + 1); break;
+      case OP_TRUE:     ADD_OP(REG_LOAD_TRUE, d, 0, 0, d + 1); break;
+      case OP_FALSE:    ADD_OP(REG_LOAD_FALSE, d, 0, 0, d + 1); break;
+      case OP_POP:
+        depth = d - 1;
+        if (translator->count > 0) {
+          RegisterOp* last = &translator->ops[translator->count - 1];
+          if (depth < last->depth) last->depth = depth;
+        }
+        break;
+      case OP_GET_LOCAL: ADD_OP(REG_MOVE, d, code[1], 0, d + 1); break;
+      case OP_SET_LOCAL: ADD_OP(REG_MOVE, code[1], d - 1, 0, d); break;
+      // The global's slot is stored low byte first, in B then C.
+      case OP_GET_GLOBAL:
+        ADD_OP(REG_GET_GLOBAL, d, code[2], code[1], d + 1);
+        break;
+      case OP_DEFINE_GLOBAL:
+        ADD_OP(REG_DEFINE_GLOBAL, d - 1, code[2], code[1], d - 1);
+        break;
+      case OP_SET_GLOBAL:
+        ADD_OP(REG_SET_GLOBAL, d - 1, code[2], code[1], d);
+        break;
+      case OP_GET_UPVALUE:
+        ADD_OP(REG_GET_UPVALUE, d, code[1], 0, d + 1);
+        break;
+      case OP_GET_CAPTURE:
+        ADD_OP(REG_GET_CAPTURE, d, code[1], 0, d + 1);
+        break;
+      case OP_SET_UPVALUE:
+        ADD_OP(REG_SET_UPVALUE, d - 1, code[1], 0, d);
+        break;
+      case OP_GET_PROPERTY:
+      case OP_GET_FIELD:
+        ADD_OP(REG_GET_PROPERTY, d - 1, d - 1, code[1], d);
+        break;
+      case OP_GET_LOCAL_PROPERTY:
+      case OP_GET_LOCAL_FIELD:
+        ADD_OP(REG_GET_PROPERTY, d, code[1], code[2], d + 1);
+        break;
+      case OP_SET_PROPERTY:
+        ADD_OP(REG_SET_PROPERTY, d - 2, code[1], d - 1, d - 1);
+        break;
+      case OP_GET_SUPER:
+        ADD_OP(REG_GET_SUPER, d - 2, d - 1, code[1], d - 1);
+        break;
+      case OP_EQUAL:    ADD_OP(REG_EQUAL, d - 2, d - 2, d - 1, d - 1); break;
+      case OP_GREATER:  ADD_OP(REG_GREATER, d - 2, d - 2, d - 1, d - 1); break;
+      case OP_LESS:     ADD_OP(REG_LESS, d - 2, d - 2, d - 1, d - 1); break;
+      case OP_ADD:
+      case OP_ADD_NUMBER:
+      case OP_ADD_STRING:
+        ADD_OP(REG_ADD, d - 2, d - 2, d - 1, d - 1);
+        break;
+      case OP_SUBTRACT:
+        ADD_OP(REG_SUBTRACT, d - 2, d - 2, d - 1, d - 1);
+        break;
+      case OP_SUBTRACT_CONSTANT:
+        ADD_OP(REG_SUBTRACT_K, d - 1, d - 1, code[1], d);
+        break;
+      case OP_MULTIPLY:
+        ADD_OP(REG_MULTIPLY, d - 2, d - 2, d - 1, d - 1);
+        break;
+      case OP_DIVIDE:   ADD_OP(REG_DIVIDE, d - 2, d - 2, d - 1, d - 1); break;
+      case OP_NOT:      ADD_OP(REG_NOT, d - 1, d - 1, 0, d); break;
+      case OP_NEGATE:   ADD_OP(REG_NEGATE, d - 1, d - 1, 0, d); break;
+      case OP_PRINT:    ADD_OP(REG_PRINT, d - 1, 0, 0, d - 1); break;
+      case OP_JUMP:
+        ADD_JUMP(REG_JUMP, 0, 0, 0, d, d, (code[1] << 8) | code[2]);
+        isReachable = false;
+        break;
+      case OP_JUMP_IF_FALSE:
+        ADD_JUMP(REG_JUMP_IF_FALSE, d - 1, 0, 0, d, d,
+                 (code[1] << 8) | code[2]);
+        break;
+      case OP_JUMP_IF_NOT_LESS:
+        ADD_JUMP(REG_JUMP_IF_NOT_LESS, d - 2, d - 2, d - 1, d - 2, d - 1,
+                 (code[1] << 8) | code[2]);
+        break;
+      case OP_JUMP_IF_NOT_GREATER:
+        ADD_JUMP(REG_JUMP_IF_NOT_GREATER, d - 2, d - 2, d - 1, d - 2, d - 1,
+                 (code[1] << 8) | code[2]);
+        break;
+      case OP_JUMP_IF_NOT_EQUAL:
+        ADD_JUMP(REG_JUMP_IF_NOT_EQUAL, d - 2, d - 2, d - 1, d - 2, d - 1,
+                 (code[1] << 8) | code[2]);
+        break;
+      case OP_LOOP: {
+        int jump = -((code[1] << 8) | code[2]);
+        if (translator->depths[offset + length + jump] != d) return false;
+        ADD_JUMP(REG_JUMP, code[3], 0, 0, d, d, jump);
+        isReachable = false;
+        break;
+      }
+      case OP_CALL:
+      case OP_CALL_GLOBAL:
+        ADD_OP(REG_CALL, d - code[1] - 1, code[1], 0, d - code[1]);
+        break;
+      case OP_TAIL_CALL:
+        ADD_OP(REG_TAIL_CALL, d - code[1] - 1, code[1], 0, d - code[1]);
+        break;
+      case OP_INVOKE:
+        ADD_OP(REG_INVOKE, d - code[2] - 1, code[1], code[2], d - code[2]);
+        break;
+      case OP_SUPER_INVOKE:
+        ADD_OP(REG_SUPER_INVOKE, d - code[2] - 2, code[1], code[2],
+               d - code[2] - 1);
+        break;
+      case OP_CLOSURE: {
+        ADD_OP(REG_CLOSURE, d, code[1], 0, d + 1);
+        // Only the upvalues alias the registers. Copied variables are
+        // just read.
+        ObjFunction* inner = AS_FUNCTION(chunk->constants.values[code[1]]);
+        for (int i = 0; i < inner->upvalueCount; i++) {
+          if (code[2 + i * 2]) translator->captured[code[3 + i * 2]] = true;
+        }
+        break;
+      }
+      case OP_CLOSE_UPVALUE:
+        ADD_OP(REG_CLOSE_UPVALUE, d - 1, 0, 0, d - 1);
+        break;
+      case OP_RETURN:
+        ADD_OP(REG_RETURN, d - 1, 0, 0, d - 1);
+        isReachable = false;
+        break;
+      case OP_CLASS:    ADD_OP(REG_CLASS, d, code[1], 0, d + 1); break;
+      case OP_INHERIT:  ADD_OP(REG_INHERIT, d - 2, d - 1, 0, d - 1); break;
+      case OP_METHOD:
+        ADD_OP(REG_METHOD, d - 2, code[1], d - 1, d - 1);
+        break;
+      default:
+        return false;
+    }
+#undef ADD_OP
+#undef ADD_JUMP
+
+    if (d > translator->registerCount) translator->registerCount = d;
+    if (depth > translator->registerCount) translator->registerCount = depth;
+    if (translator->failed || depth < 1) return false;
+    offset += length;
+  }
+
+  // Every frame has at least one register for the returned value.
+  return translator->registerCount <= UINT8_COUNT;
+}
+
+static void markLabels(Translator* translator) {
+  Chunk* chunk = translator->chunk;
+  for (int i = 0; i < translator->count; i++) {
+    RegisterOp* op = &translator->ops[i];
+    if (op->target == -1) continue;
+
+    // The POPs at a jump target don't become ops, so find how low they
+    // take the stack before the first op there runs.
+    int offset = op->target;
+    int depth = translator->depths[offset];
+    while (offset < chunk->count && chunk->code[offset] == OP_POP) {
+      offset++;
+      depth--;
+    }
+    op->targetDepth = depth;
+
+    int label = translator->firstOps[op->target];
+    if (label < translator->count) translator->ops[label].isLabel = true;
+  }
+}
+
+// Returns the index of the op that last stored into [reg] before the op at
+// [index], or -1 if there isn't one in the same basic block. Calls end the
+// search too, since they might clobber anything.
+static int findDefinition(Translator* translator, int index, int reg) {
+  for (int i = index - 1; i >= 0; i--) {
+    if (translator->ops[i + 1].isLabel) return -1;
+
+    RegisterOp* op = &translator->ops[i];
+    if (op->isDeleted) continue;
+    if (isRegisterCall(op->op)) return -1;
+    if (registerWritten(op) == reg) return i;
+  }
+
+  return -1;
+}
+
+// Returns true if [reg] keeps the value it had after the op at [from] until
+// the op at [to]. A register the stack has popped counts as changed even if
+// nothing writes it, since passes rely on dead registers staying dead.
+static bool isUnchangedBetween(Translator* translator, int from, int to,
+                               int reg) {
+  for (int i = from; i < to; i++) {
+    RegisterOp* op = &translator->ops[i];
+    if (op->depth <= reg) return false;
+    if (i > from && !op->isDeleted && registerWritten(op) == reg) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Returns true if the value in [reg] after the op at [index] runs can
+// never be read.
+static bool isDeadAfter(Translator* translator, int index, int reg) {
+  if (translator->captured[reg]) return false;
+
+  for (int i = index; i < translator->count; i++) {
+    RegisterOp* op = &translator->ops[i];
+    if (i > index && !op->isDeleted) {
+      if (readsRegister(translator, op, reg)) return false;
+
+      if (isRegisterJump(op->op)) {
+        // The compare and jumps overwrite A before jumping.
+        bool isDeadAtTarget = op->targetDepth <= reg ||
+            (op->op >= REG_JUMP_IF_NOT_LESS && op->a == reg);
+        if (!isDeadAtTarget) return false;
+        if (op->op == REG_JUMP) return true;
+      } else if (op->op == REG_RETURN || registerWritten(op) == reg) {
+        return true;
+      }
+    }
+
+    if (op->depth <= reg) return true;
+  }
+
+  return true;
+}
+
+// Replaces the register in [operand] with the one it was copied from, or
+// with the constant it was loaded from if [constantOp] gives a variant of
+// the op that takes one. Returns true if it became a constant.
+static bool forwardOperand(Translator* translator, int index, int* operand,
+                           RegisterOpCode constantOp) {
+  int definition = findDefinition(translator, index, *operand);
+  if (definition == -1) return false;
+
+  RegisterOp* source = &translator->ops[definition];
+  if (source->op == REG_MOVE &&
+      isUnchangedBetween(translator, definition, index, source->b)) {
+    *operand = source->b;
+  } else if (source->op == REG_LOAD_CONSTANT && constantOp != REG_MOVE) {
+    *operand = source->b;
+    translator->ops[index].op = constantOp;
+    return true;
+  }
+
+  return false;
+}
+
+static void forwardOperands(Translator* translator) {
+  for (int i = 0; i < translator->count; i++) {
+    RegisterOp* op = &translator->ops[i];
+    switch (op->op) {
+      case REG_MOVE:
+      case REG_GET_PROPERTY:
+      case REG_NOT:
+      case REG_NEGATE:
+      case REG_EQUAL_K:
+      case REG_GREATER_K:
+      case REG_LESS_K:
+      case REG_ADD_K:
+      case REG_SUBTRACT_K:
+      case REG_MULTIPLY_K:
+      case REG_DIVIDE_K:
+        forwardOperand(translator, i, &op->b, REG_MOVE);
+        break;
+      case REG_DEFINE_GLOBAL:
+      case REG_SET_GLOBAL:
+      case REG_SET_UPVALUE:
+      case REG_PRINT:
+      case REG_JUMP_IF_FALSE:
+      case REG_RETURN:
+        forwardOperand(translator, i, &op->a, REG_MOVE);
+        break;
+      case REG_SET_PROPERTY:
+        forwardOperand(translator, i, &op->c, REG_MOVE);
+        break;
+      case REG_EQUAL:
+      case REG_GREATER:
+      case REG_LESS:
+      case REG_ADD:
+      case REG_SUBTRACT:
+      case REG_MULTIPLY:
+      case REG_DIVIDE:
+      case REG_JUMP_IF_NOT_LESS:
+      case REG_JUMP_IF_NOT_GREATER:
+      case REG_JUMP_IF_NOT_EQUAL: {
+        // The constant forms are laid out in the same order.
+        RegisterOpCode constantOp = op->op <= REG_DIVIDE
+            ? (RegisterOpCode)(op->op - REG_EQUAL + REG_EQUAL_K)
+            : (RegisterOpCode)(op->op - REG_JUMP_IF_NOT_LESS +
+                               REG_JUMP_IF_NOT_LESS_K);
+        forwardOperand(translator, i, &op->c, constantOp);
+        forwardOperand(translator, i, &op->b, REG_MOVE);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+static bool isRetargetable(RegisterOpCode op) {
+  switch (op) {
+    case REG_MOVE:
+    case REG_LOAD_CONSTANT:
+    case REG_LOAD_NIL:
+    case REG_LOAD_TRUE:
+    case REG_LOAD_FALSE:
+    case REG_GET_GLOBAL:
+    case REG_GET_UPVALUE:
+    case REG_GET_CAPTURE:
+    case REG_GET_PROPERTY:
+    case REG_NOT:
+    case REG_NEGATE:
+      return true;
+    default:
+      return op >= REG_EQUAL && op <= REG_DIVIDE_K;
+  }
+}
+
+// Where an op computes a temporary only for a following MOVE to store it
+// into a local, has the op store into the local directly.
+static void forwardDestinations(Translator* translator) {
+  for (int i = 0; i < translator->count; i++) {
+    RegisterOp* move = &translator->ops[i];
+    if (move->isDeleted || move->op != REG_MOVE || move->a == move->b) {
+      continue;
+    }
+
+    int definition = findDefinition(translator, i, move->b);
+    if (definition == -1) continue;
+    if (!isRetargetable(translator->ops[definition].op)) continue;
+
+    // The local must already be live at the definition, or the passes
+    // would take the earlier write for a dead one.
+    bool isSafe = true;
+    for (int j = definition; j < i && isSafe; j++) {
+      RegisterOp* op = &translator->ops[j];
+      if (op->depth <= move->a) isSafe = false;
+      if (op->isDeleted || j == definition) continue;
+      if (readsRegister(translator, op, move->b) ||
+          readsRegister(translator, op, move->a) ||
+          registerWritten(op) == move->a) {
+        isSafe = false;
+      }
+    }
+
+    if (!isSafe || !isDeadAfter(translator, i, move->b)) continue;
+    translator->ops[definition].a = move->a;
+    move->isDeleted = true;
+  }
+}
+
+static void deleteDeadMoves(Translator* translator) {
+  bool changed;
+  do {
+    changed = false;
+    for (int i = translator->count - 1; i >= 0; i--) {
+      RegisterOp* op = &translator->ops[i];
+      if (op->isDeleted) continue;
+
+      bool isDead;
+      switch (op->op) {
+        case REG_MOVE:
+          isDead = op->a == op->b || isDeadAfter(translator, i, op->a);
+          break;
+        case REG_LOAD_CONSTANT:
+        case REG_LOAD_NIL:
+        case REG_LOAD_TRUE:
+        case REG_LOAD_FALSE:
+          isDead = isDeadAfter(translator, i, op->a);
+          break;
+        default:
+          isDead = false;
+          break;
+      }
+
+      if (!isDead) continue;
+      op->isDeleted = true;
+      changed = true;
+    }
+  } while (changed);
+}
+
+static bool hasInlineCache(RegisterOpCode op) {
+  return op == REG_GET_PROPERTY || op == REG_SET_PROPERTY ||
+         op == REG_INVOKE || op == REG_SUPER_INVOKE;
+}
+
+static int registerOpLength(Translator* translator, RegisterOp* op) {
+  if (isRegisterJump(op->op)) return 2;
+  if (hasInlineCache(op->op)) return 2;
+  if (op->op == REG_CLOSURE) {
+    ObjFunction* function =
+        AS_FUNCTION(translator->chunk->constants.values[op->b]);
+    return 1 + function->upvalueCount + function->captureCount;
+  }
+  return 1;
+}
+
+static void emitRegisterCode(Translator* translator) {
+  // Lay out the surviving ops. Deleted ones take up no space, so a label on
+  // one falls through to the next op that is kept.
+  int* positions = ALLOCATE(int, translator->count + 1);
+  int count = 0;
+  for (int i = 0; i < translator->count; i++) {
+    positions[i] = count;
+    RegisterOp* op = &translator->ops[i];
+    if (!op->isDeleted) count += registerOpLength(translator, op);
+  }
+  positions[translator->count] = count;
+
+  RegisterChunk* registers = ALLOCATE(RegisterChunk, 1);
+  registers->count = count;
+  registers->code = ALLOCATE(Instruction, count);
+  registers->lines = ALLOCATE(int, count);
+  registers->registerCount = translator->registerCount;
+
+  Chunk* chunk = translator->chunk;
+  int position = 0;
+  for (int i = 0; i < translator->count; i++) {
+    RegisterOp* op = &translator->ops[i];
+    if (op->isDeleted) continue;
+
+    int length = registerOpLength(translator, op);
+    for (int j = 0; j < length; j++) registers->lines[position + j] = op->line;
+
+    registers->code[position] = REG_INSTRUCTION(op->op, op->a, op->b, op->c);
+    if (isRegisterJump(op->op)) {
+      int target = positions[translator->firstOps[op->target]];
+      registers->code[position + 1] =
+          (Instruction)(int32_t)(target - (position + 2));
+    } else if (hasInlineCache(op->op)) {
+      // The op shares the stack instruction's inline cache, whose index is
+      // its last operand.
+      int source = op->source + instructionLength(chunk, op->source);
+      registers->code[position + 1] = chunk->code[source - 1];
+    } else if (op->op == REG_CLOSURE) {
+      uint8_t* upvalues = &chunk->code[op->source + 2];
+      for (int j = 1; j < length; j++) {
+        registers->code[position + j] =
+            upvalues[j * 2 - 2] | (upvalues[j * 2 - 1] << 8);
+      }
+    }
+
+    position += length;
+  }
+
+  FREE_ARRAY(int, positions, translator->count + 1);
+  chunk->registers = registers;
+}
+
+static void translateToRegisters(ObjFunction* function) {
+  Chunk* chunk = &function->chunk;
+
+  Translator translator;
+  translator.chunk = chunk;
+  translator.ops = NULL;
+  translator.count = 0;
+  translator.capacity = 0;
+  translator.depths = ALLOCATE(int, chunk->count + 1);
+  translator.firstOps = ALLOCATE(int, chunk->count + 1);
+  for (int i = 0; i <= chunk->count; i++) {
+    translator.depths[i] = -1;
+    translator.firstOps[i] = 0;
+  }
+  for (int i = 0; i < UINT8_COUNT; i++) translator.captured[i] = false;
+  translator.registerCount = 0;
+  translator.failed = false;
+
+  if (translateInstructions(&translator, function)) {
+    translator.firstOps[chunk->count] = translator.count;
+    markLabels(&translator);
+    forwardOperands(&translator);
+    forwardDestinations(&translator);
+    deleteDeadMoves(&translator);
+    emitRegisterCode(&translator);
+  }
+
+  FREE_ARRAY(RegisterOp, translator.ops, translator.capacity);
+  FREE_ARRAY(int, translator.depths, chunk->count + 1);
+  FREE_ARRAY(int, translator.firstOps, chunk->count + 1);
+
+  // The VM makes room for all of a register frame's registers.
+  if (chunk->registers != NULL &&
+      chunk->registers->registerCount > function->maxSlots) {
+    function->maxSlots = chunk->registers->registerCount;
+  }
+}
+#endif
+
+static void recordJumpHeight(int* heights, int target, int height) {
+  if (heights[target] < height) heights[target] = height;
+}
+
+// Works out the most values [function] has on the stack at once, so that a
+// call to it only has to check the stack has room once. Code after a jump
+// can be reached from elsewhere, so it starts at the height of the highest
+// stack anything reaching it leaves.
+static int maxStackHeight(ObjFunction* function) {
+  Chunk* chunk = &function->chunk;
+  int* heights = ALLOCATE(int, chunk->count + 1);
+  for (int i = 0; i <= chunk->count; i++) heights[i] = 0;
+
+  int height = function->arity + 1;
+  int max = height;
+  for (int offset = 0; offset < chunk->count;) {
+    if (heights[offset] > height) height = heights[offset];
+
+    uint8_t* code = &chunk->code[offset];
+    int next = offset + instructionLength(chunk, offset);
+    switch (code[0]) {
+      case OP_CONSTANT:
+      case OP_NIL:
+      case OP_TRUE:
+      case OP_FALSE:
+      case OP_GET_LOCAL:
+      case OP_GET_GLOBAL:
+      case OP_GET_UPVALUE:
+      case OP_GET_CAPTURE:
+      case OP_GET_LOCAL_PROPERTY:
+      case OP_GET_LOCAL_FIELD:
+      case OP_CLOSURE:
+      case OP_CLASS:
+        height++;
+        break;
+
+      case OP_POP:
+      case OP_DEFINE_GLOBAL:
+      case OP_SET_PROPERTY:
+      case OP_GET_SUPER:
+      case OP_EQUAL:
+      case OP_GREATER:
+      case OP_LESS:
+      case OP_ADD:
+      case OP_ADD_NUMBER:
+      case OP_ADD_STRING:
+      case OP_SUBTRACT:
+      case OP_MULTIPLY:
+      case OP_DIVIDE:
+      case OP_PRINT:
+      case OP_CLOSE_UPVALUE:
+      case OP_RETURN:
+      case OP_INHERIT:
+      case OP_METHOD:
+        height--;
+        break;
+
+      case OP_JUMP:
+      case OP_JUMP_IF_FALSE:
+        recordJumpHeight(heights, next + ((code[1] << 8) | code[2]), height);
+        break;
+
+      case OP_JUMP_IF_NOT_LESS:
+      case OP_JUMP_IF_NOT_GREATER:
+      case OP_JUMP_IF_NOT_EQUAL:
+        // The jump leaves false in place of the operands.
+        recordJumpHeight(heights, next + ((code[1] << 8) | code[2]),
+                         height - 1);
+        height -= 2;
+        break;
+
+      case OP_CALL:
+      case OP_TAIL_CALL:
+      case OP_CALL_GLOBAL:
+        height -= code[1];
+        break;
+      case OP_INVOKE:
+        height -= code[2];
+        break;
+      case OP_SUPER_INVOKE:
+        height -= code[2] + 1;
+        break;
+
+      default:
+        // The rest leave the height as it is.
+        break;
+    }
+
+    if (height > max) max = height;
+    offset = next;
+  }
+
+  FREE_ARRAY(int, heights, chunk->count + 1);
+  return max;
+}
+
+// Notes in [function], a method, whether its body is only one of the
+// field accesses an AccessorKind names.
+static void findAccessor(ObjFunction* function) {
+  Chunk* chunk = &function->chunk;
+  uint8_t* code = chunk->code;
+  AccessorKind kind;
+  int field;
+
+  if (function->arity == 0 && chunk->count >= 5 &&
+      code[0] == OP_GET_LOCAL_PROPERTY && code[1] == 0 &&
+      code[4] == OP_RETURN) {
+    kind = ACCESSOR_GET;
+    field = 2;
+  } else if (function->arity == 1 && chunk->count >= 8 &&
+             code[0] == OP_GET_LOCAL && code[1] == 0 &&
+             code[2] == OP_GET_LOCAL && code[3] == 1 &&
+             code[4] == OP_SET_PROPERTY) {
+    field = 5;
+    if (code[7] == OP_RETURN) {
+      kind = ACCESSOR_SET_RETURN;
+    } else if (chunk->count >= 10 && code[7] == OP_POP &&
+               code[8] == OP_NIL && code[9] == OP_RETURN) {
+      kind = ACCESSOR_SET;
+    } else {
+      return;
+    }
+  } else {
+    return;
+  }
+
+  function->accessor = kind;
+  function->accessorField = AS_STRING(chunk->constants.values[code[field]]);
+  function->accessorCache = code[field + 1];
+}
+//< Optimization omit
 //> Compiling Expressions end-compiler
 /* Compiling Expressions end-compiler < Calls and Functions end-compiler
 static void endCompiler() {
@@ -354,6 +1305,15 @@ static ObjFunction* endCompiler() {
   ObjFunction* function = current->function;
 
 //< Calls and Functions end-function
+//> Optimization omit
+  if (!parser.hadError) function->maxSlots = maxStackHeight(function);
+  if (!parser.hadError && current->type == TYPE_METHOD) {
+    findAccessor(function);
+  }
+#ifdef REGISTER_VM
+  if (!parser.hadError) translateToRegisters(function);
+#endif
+//< Optimization omit
 //> dump-chunk
 #ifdef DEBUG_PRINT_CODE
   if (!parser.hadError) {
@@ -364,6 +1324,12 @@ static ObjFunction* endCompiler() {
     disassembleChunk(currentChunk(),
         function->name != NULL ? function->name->chars : "<script>");
 //< Calls and Functions disassemble-end
+//> Optimization omit
+#ifdef REGISTER_VM
+    disassembleRegisterChunk(&function->chunk,
+        function->name != NULL ? function->name->chars : "<script>");
+#endif
+//< Optimization omit
   }
 #endif
 //< dump-chunk
@@ -420,6 +1386,31 @@ static uint8_t identifierConstant(Token* name) {
   return makeConstant(OBJ_VAL(copyString(name->start, name->length)));
 }
 //< Global Variables identifier-constant
+//> Optimization omit
+// Returns the slot of the global variable [name], giving it one if this is
+// the first time any code has mentioned it.
+static uint16_t globalVariable(Token* name) {
+  int slot = globalSlot(copyString(name->start, name->length));
+  if (slot == -1) {
+    error("Too many global variables.");
+    return 0;
+  }
+
+  return (uint16_t)slot;
+}
+
+// Emits [op] with the local, upvalue or global slot [arg]. A global's slot
+// takes two bytes.
+static void emitVariable(OpCode op, int arg) {
+  if (op == OP_GET_GLOBAL || op == OP_SET_GLOBAL || op == OP_DEFINE_GLOBAL) {
+    emitByte(op);
+    emitByte((arg >> 8) & 0xff);
+    emitByte(arg & 0xff);
+  } else {
+    emitBytes(op, (uint8_t)arg);
+  }
+}
+//< Optimization omit
 //> Local Variables identifiers-equal
 static bool identifiersEqual(Token* a, Token* b) {
   if (a->length != b->length) return false;
@@ -443,16 +1434,70 @@ static int resolveLocal(Compiler* compiler, Token* name) {
   return -1;
 }
 //< Local Variables resolve-local
+//> Optimization omit
+static bool isAssigned(Token* name) {
+  for (int i = 0; i < assignedNames.count; i++) {
+    if (identifiersEqual(name, &assignedNames.names[i])) return true;
+  }
+  return false;
+}
+
+// Scans the whole program for identifiers followed by "=" that aren't
+// property names or variable declarations.
+static void findAssignedNames(const char* source) {
+  initScanner(source);
+  TokenType before = TOKEN_EOF;
+  Token token = scanToken();
+  while (token.type != TOKEN_EOF) {
+    Token next = scanToken();
+    if (token.type == TOKEN_IDENTIFIER && next.type == TOKEN_EQUAL &&
+        before != TOKEN_DOT && before != TOKEN_VAR && !isAssigned(&token)) {
+      if (assignedNames.capacity < assignedNames.count + 1) {
+        int oldCapacity = assignedNames.capacity;
+        assignedNames.capacity = GROW_CAPACITY(oldCapacity);
+        assignedNames.names = GROW_ARRAY(Token, assignedNames.names,
+                                         oldCapacity, assignedNames.capacity);
+      }
+      assignedNames.names[assignedNames.count++] = token;
+    }
+
+    before = token.type;
+    token = next;
+  }
+}
+
+//< Optimization omit
 //> Closures add-upvalue
+/* Closures add-upvalue < Optimization omit
 static int addUpvalue(Compiler* compiler, uint8_t index, bool isLocal) {
   int upvalueCount = compiler->function->upvalueCount;
+*/
+//> Optimization omit
+static int addUpvalue(Compiler* compiler, uint8_t index, bool isLocal,
+                      bool byValue) {
+  // Copied variables are numbered apart from upvalues.
+  int upvalueCount = compiler->function->upvalueCount +
+                     compiler->function->captureCount;
+  int slot = 0;
+//< Optimization omit
 //> existing-upvalue
 
   for (int i = 0; i < upvalueCount; i++) {
     Upvalue* upvalue = &compiler->upvalues[i];
+//> Optimization omit
+    if (upvalue->byValue != byValue) continue;
+//< Optimization omit
     if (upvalue->index == index && upvalue->isLocal == isLocal) {
+/* Closures existing-upvalue < Optimization omit
       return i;
+*/
+//> Optimization omit
+      return slot;
+//< Optimization omit
     }
+//> Optimization omit
+    slot++;
+//< Optimization omit
   }
 
 //< existing-upvalue
@@ -465,31 +1510,92 @@ static int addUpvalue(Compiler* compiler, uint8_t index, bool isLocal) {
 //< too-many-upvalues
   compiler->upvalues[upvalueCount].isLocal = isLocal;
   compiler->upvalues[upvalueCount].index = index;
+//> Optimization omit
+  compiler->upvalues[upvalueCount].byValue = byValue;
+  if (byValue) return compiler->function->captureCount++;
+//< Optimization omit
   return compiler->function->upvalueCount++;
 }
 //< Closures add-upvalue
 //> Closures resolve-upvalue
+/* Closures resolve-upvalue < Optimization omit
 static int resolveUpvalue(Compiler* compiler, Token* name) {
+*/
+//> Optimization omit
+// Sets [byValue] to whether the variable is copied into the closure.
+static int resolveUpvalue(Compiler* compiler, Token* name, bool* byValue) {
+//< Optimization omit
   if (compiler->enclosing == NULL) return -1;
 
   int local = resolveLocal(compiler->enclosing, name);
   if (local != -1) {
+//> Optimization omit
+    // A function declared in a block may refer to itself, but the closure
+    // isn't in its variable yet while its captures are being made.
+    *byValue = !isAssigned(name) &&
+               !(compiler->type == TYPE_FUNCTION &&
+                 local == compiler->enclosing->localCount - 1);
+    if (*byValue) return addUpvalue(compiler, (uint8_t)local, true, true);
+
+//< Optimization omit
 //> mark-local-captured
     compiler->enclosing->locals[local].isCaptured = true;
 //< mark-local-captured
+/* Closures resolve-upvalue < Optimization omit
     return addUpvalue(compiler, (uint8_t)local, true);
+*/
+//> Optimization omit
+    return addUpvalue(compiler, (uint8_t)local, true, false);
+//< Optimization omit
   }
 //> resolve-upvalue-recurse
 
+/* Closures resolve-upvalue-recurse < Optimization omit
   int upvalue = resolveUpvalue(compiler->enclosing, name);
+*/
+//> Optimization omit
+  int upvalue = resolveUpvalue(compiler->enclosing, name, byValue);
+//< Optimization omit
   if (upvalue != -1) {
+/* Closures resolve-upvalue-recurse < Optimization omit
     return addUpvalue(compiler, (uint8_t)upvalue, false);
+*/
+//> Optimization omit
+    return addUpvalue(compiler, (uint8_t)upvalue, false, *byValue);
+//< Optimization omit
   }
 //< resolve-upvalue-recurse
 
   return -1;
 }
 //< Closures resolve-upvalue
+//> Optimization omit
+static void markEscapes(Local* local) {
+  local->escapes = true;
+  if (local->function != NULL) local->function->escapes = true;
+}
+
+// Notes a read of the variable [name], which is the callee of a call if
+// [isCallee] is true. Reading a local function for anything else, or from
+// a closure other than its own, lets it escape.
+static void useVariable(Token* name, bool isCallee) {
+  for (Compiler* compiler = current; compiler != NULL;
+       compiler = compiler->enclosing) {
+    for (int i = compiler->localCount - 1; i >= 0; i--) {
+      Local* local = &compiler->locals[i];
+      if (!identifiersEqual(name, &local->name)) continue;
+
+      bool isSelf = compiler == current->enclosing &&
+                    current->type == TYPE_FUNCTION &&
+                    i == compiler->localCount - 1;
+      if (!isCallee || (compiler != current && !isSelf)) {
+        markEscapes(local);
+      }
+      return;
+    }
+  }
+}
+//< Optimization omit
 //> Local Variables add-local
 static void addLocal(Token name) {
 //> too-many-locals
@@ -510,6 +1616,10 @@ static void addLocal(Token name) {
 //> Closures init-is-captured
   local->isCaptured = false;
 //< Closures init-is-captured
+//> Optimization omit
+  local->function = NULL;
+  local->escapes = false;
+//< Optimization omit
 }
 //< Local Variables add-local
 //> Local Variables declare-variable
@@ -535,7 +1645,12 @@ static void declareVariable() {
 }
 //< Local Variables declare-variable
 //> Global Variables parse-variable
+/* Global Variables parse-variable < Optimization omit
 static uint8_t parseVariable(const char* errorMessage) {
+*/
+//> Optimization omit
+static uint16_t parseVariable(const char* errorMessage) {
+//< Optimization omit
   consume(TOKEN_IDENTIFIER, errorMessage);
 //> Local Variables parse-local
 
@@ -543,7 +1658,12 @@ static uint8_t parseVariable(const char* errorMessage) {
   if (current->scopeDepth > 0) return 0;
 
 //< Local Variables parse-local
+/* Global Variables parse-variable < Optimization omit
   return identifierConstant(&parser.previous);
+*/
+//> Optimization omit
+  return globalVariable(&parser.previous);
+//< Optimization omit
 }
 //< Global Variables parse-variable
 //> Local Variables mark-initialized
@@ -556,7 +1676,12 @@ static void markInitialized() {
 }
 //< Local Variables mark-initialized
 //> Global Variables define-variable
+/* Global Variables define-variable < Optimization omit
 static void defineVariable(uint8_t global) {
+*/
+//> Optimization omit
+static void defineVariable(uint16_t global) {
+//< Optimization omit
 //> Local Variables define-variable
   if (current->scopeDepth > 0) {
 //> define-local
@@ -566,7 +1691,12 @@ static void defineVariable(uint8_t global) {
   }
 
 //< Local Variables define-variable
+/* Global Variables define-variable < Optimization omit
   emitBytes(OP_DEFINE_GLOBAL, global);
+*/
+//> Optimization omit
+  emitVariable(OP_DEFINE_GLOBAL, global);
+//< Optimization omit
 }
 //< Global Variables define-variable
 //> Calls and Functions argument-list
@@ -591,9 +1721,16 @@ static uint8_t argumentList() {
 //< Calls and Functions argument-list
 //> Jumping Back and Forth and
 static void and_(bool canAssign) {
+/* Jumping Back and Forth and < Optimization omit
   int endJump = emitJump(OP_JUMP_IF_FALSE);
 
   emitByte(OP_POP);
+*/
+//> Optimization omit
+  int endJump = emitJumpIfFalse();
+
+  emitConditionPop();
+//< Optimization omit
   parsePrecedence(PREC_AND);
 
   patchJump(endJump);
@@ -612,6 +1749,15 @@ static void binary(bool canAssign) {
   // Compile the right operand.
   ParseRule* rule = getRule(operatorType);
   parsePrecedence((Precedence)(rule->precedence + 1));
+//> Optimization omit
+
+  if (operatorType == TOKEN_MINUS &&
+      fuseLastInstruction(OP_CONSTANT, 2, OP_SUBTRACT_CONSTANT)) {
+    return;
+  }
+
+  current->lastInstruction = currentChunk()->count;
+//< Optimization omit
 
   // Emit the operator instruction.
   switch (operatorType) {
@@ -634,7 +1780,29 @@ static void binary(bool canAssign) {
 //< Compiling Expressions binary
 //> Calls and Functions compile-call
 static void call(bool canAssign) {
+//> Optimization omit
+  // The callee's global is still read before the arguments are evaluated,
+  // so calling a global only changes how the call itself is made.
+  Chunk* chunk = currentChunk();
+  int last = current->lastInstruction;
+  bool calleeIsGlobal = last != -1 && last == chunk->count - 3 &&
+                        chunk->code[last] == OP_GET_GLOBAL;
+  int callee = -1;
+  if (last != -1 && last == chunk->count - 2 &&
+      chunk->code[last] == OP_GET_LOCAL) {
+    callee = chunk->code[last + 1];
+  }
+//< Optimization omit
   uint8_t argCount = argumentList();
+//> Optimization omit
+  current->lastCallee = callee;
+  current->lastInstruction = currentChunk()->count;
+  if (calleeIsGlobal) {
+    emitBytes(OP_CALL_GLOBAL, argCount);
+    emitByte(addCallCache(currentChunk()));
+    return;
+  }
+//< Optimization omit
   emitBytes(OP_CALL, argCount);
 }
 //< Calls and Functions compile-call
@@ -646,14 +1814,27 @@ static void dot(bool canAssign) {
   if (canAssign && match(TOKEN_EQUAL)) {
     expression();
     emitBytes(OP_SET_PROPERTY, name);
+//> Optimization omit
+    emitByte(addPropertyCache(currentChunk()));
+//< Optimization omit
 //> Methods and Initializers parse-call
   } else if (match(TOKEN_LEFT_PAREN)) {
     uint8_t argCount = argumentList();
     emitBytes(OP_INVOKE, name);
     emitByte(argCount);
+//> Optimization omit
+    emitByte(addInvokeCache(currentChunk()));
+//< Optimization omit
 //< Methods and Initializers parse-call
+//> Optimization omit
+  } else if (fuseLastInstruction(OP_GET_LOCAL, 2, OP_GET_LOCAL_PROPERTY)) {
+    emitBytes(name, addPropertyCache(currentChunk()));
+//< Optimization omit
   } else {
     emitBytes(OP_GET_PROPERTY, name);
+//> Optimization omit
+    emitByte(addPropertyCache(currentChunk()));
+//< Optimization omit
   }
 }
 //< Classes and Instances compile-dot
@@ -736,16 +1917,31 @@ static void namedVariable(Token name, bool canAssign) {
 //> Local Variables named-local
   uint8_t getOp, setOp;
   int arg = resolveLocal(current, &name);
+//> Optimization omit
+  bool byValue;
+//< Optimization omit
   if (arg != -1) {
     getOp = OP_GET_LOCAL;
     setOp = OP_SET_LOCAL;
 //> Closures named-variable-upvalue
+/* Closures named-variable-upvalue < Optimization omit
   } else if ((arg = resolveUpvalue(current, &name)) != -1) {
     getOp = OP_GET_UPVALUE;
+*/
+//> Optimization omit
+  } else if ((arg = resolveUpvalue(current, &name, &byValue)) != -1) {
+    // A copied variable is never assigned, so it has no set instruction.
+    getOp = byValue ? OP_GET_CAPTURE : OP_GET_UPVALUE;
+//< Optimization omit
     setOp = OP_SET_UPVALUE;
 //< Closures named-variable-upvalue
   } else {
+/* Local Variables named-local < Optimization omit
     arg = identifierConstant(&name);
+*/
+//> Optimization omit
+    arg = globalVariable(&name);
+//< Optimization omit
     getOp = OP_GET_GLOBAL;
     setOp = OP_SET_GLOBAL;
   }
@@ -766,14 +1962,26 @@ static void namedVariable(Token name, bool canAssign) {
     emitBytes(OP_SET_GLOBAL, arg);
 */
 //> Local Variables emit-set
+/* Local Variables emit-set < Optimization omit
     emitBytes(setOp, (uint8_t)arg);
+*/
+//> Optimization omit
+    emitVariable(setOp, arg);
+//< Optimization omit
 //< Local Variables emit-set
   } else {
 /* Global Variables named-variable < Local Variables emit-get
     emitBytes(OP_GET_GLOBAL, arg);
 */
 //> Local Variables emit-get
+/* Local Variables emit-get < Optimization omit
     emitBytes(getOp, (uint8_t)arg);
+*/
+//> Optimization omit
+    useVariable(&name, check(TOKEN_LEFT_PAREN));
+    current->lastInstruction = currentChunk()->count;
+    emitVariable(getOp, arg);
+//< Optimization omit
 //< Local Variables emit-get
   }
 //< named-variable
@@ -824,6 +2032,9 @@ static void super_(bool canAssign) {
     namedVariable(syntheticToken("super"), false);
     emitBytes(OP_SUPER_INVOKE, name);
     emitByte(argCount);
+//> Optimization omit
+    emitByte(addInvokeCache(currentChunk()));
+//< Optimization omit
   } else {
     namedVariable(syntheticToken("super"), false);
     emitBytes(OP_GET_SUPER, name);
@@ -1091,10 +2302,23 @@ static void function(FunctionType type) {
 //< Closures emit-closure
 //> Closures capture-upvalues
 
+/* Closures capture-upvalues < Optimization omit
   for (int i = 0; i < function->upvalueCount; i++) {
     emitByte(compiler.upvalues[i].isLocal ? 1 : 0);
     emitByte(compiler.upvalues[i].index);
   }
+*/
+//> Optimization omit
+  // The variables captured by upvalue come first, then those copied.
+  int upvalueCount = function->upvalueCount + function->captureCount;
+  for (int byValue = 0; byValue <= 1; byValue++) {
+    for (int i = 0; i < upvalueCount; i++) {
+      if (compiler.upvalues[i].byValue != byValue) continue;
+      emitByte(compiler.upvalues[i].isLocal ? 1 : 0);
+      emitByte(compiler.upvalues[i].index);
+    }
+  }
+//< Optimization omit
 //< Closures capture-upvalues
 }
 //< Calls and Functions compile-function
@@ -1102,6 +2326,9 @@ static void function(FunctionType type) {
 static void method() {
   consume(TOKEN_IDENTIFIER, "Expect method name.");
   uint8_t constant = identifierConstant(&parser.previous);
+//> Optimization omit
+  selectorOf(AS_STRING(currentChunk()->constants.values[constant]));
+//< Optimization omit
 //> method-body
 
 //< method-body
@@ -1134,7 +2361,12 @@ static void classDeclaration() {
   declareVariable();
 
   emitBytes(OP_CLASS, nameConstant);
+/* Classes and Instances class-declaration < Optimization omit
   defineVariable(nameConstant);
+*/
+//> Optimization omit
+  defineVariable(current->scopeDepth > 0 ? 0 : globalVariable(&className));
+//< Optimization omit
 
 //> Methods and Initializers create-class-compiler
   ClassCompiler classCompiler;
@@ -1198,15 +2430,38 @@ static void classDeclaration() {
 //< Classes and Instances class-declaration
 //> Calls and Functions fun-declaration
 static void funDeclaration() {
+/* Calls and Functions fun-declaration < Optimization omit
   uint8_t global = parseVariable("Expect function name.");
+*/
+//> Optimization omit
+  uint16_t global = parseVariable("Expect function name.");
+//< Optimization omit
   markInitialized();
+//> Optimization omit
+  int closure = currentChunk()->count;
+//< Optimization omit
   function(TYPE_FUNCTION);
+//> Optimization omit
+  // A local function's closure doesn't escape unless a use of it says so.
+  if (current->scopeDepth > 0 && !parser.hadError) {
+    Local* local = &current->locals[current->localCount - 1];
+    Chunk* chunk = currentChunk();
+    local->function = AS_FUNCTION(
+        chunk->constants.values[chunk->code[closure + 1]]);
+    local->function->escapes = local->escapes;
+  }
+//< Optimization omit
   defineVariable(global);
 }
 //< Calls and Functions fun-declaration
 //> Global Variables var-declaration
 static void varDeclaration() {
+/* Global Variables var-declaration < Optimization omit
   uint8_t global = parseVariable("Expect variable name.");
+*/
+//> Optimization omit
+  uint16_t global = parseVariable("Expect variable name.");
+//< Optimization omit
 
   if (match(TOKEN_EQUAL)) {
     expression();
@@ -1257,8 +2512,14 @@ static void forStatement() {
     consume(TOKEN_SEMICOLON, "Expect ';' after loop condition.");
 
     // Jump out of the loop if the condition is false.
+/* Jumping Back and Forth for-exit < Optimization omit
     exitJump = emitJump(OP_JUMP_IF_FALSE);
     emitByte(OP_POP); // Condition.
+*/
+//> Optimization omit
+    exitJump = emitJumpIfFalse();
+    emitConditionPop();
+//< Optimization omit
   }
 
 //< for-exit
@@ -1302,9 +2563,19 @@ static void ifStatement() {
   expression();
   consume(TOKEN_RIGHT_PAREN, "Expect ')' after condition."); // [paren]
 
+/* Jumping Back and Forth if-statement < Optimization omit
   int thenJump = emitJump(OP_JUMP_IF_FALSE);
+*/
+//> Optimization omit
+  int thenJump = emitJumpIfFalse();
+//< Optimization omit
 //> pop-then
+/* Jumping Back and Forth pop-then < Optimization omit
   emitByte(OP_POP);
+*/
+//> Optimization omit
+  emitConditionPop();
+//< Optimization omit
 //< pop-then
   statement();
 
@@ -1351,6 +2622,18 @@ static void returnStatement() {
 //< Methods and Initializers return-from-init
     expression();
     consume(TOKEN_SEMICOLON, "Expect ';' after return value.");
+//> Optimization omit
+    // A call whose result is returned can reuse the caller's frame. The
+    // OP_RETURN stays for callees that don't, like natives.
+    if (fuseLastInstruction(OP_CALL_GLOBAL, 3, OP_TAIL_CALL)) {
+      // A tail call has no use for the cache.
+      currentChunk()->count--;
+    } else if (fuseLastInstruction(OP_CALL, 2, OP_TAIL_CALL) &&
+               current->lastCallee != -1) {
+      // The callee outlives the frame it replaces.
+      markEscapes(&current->locals[current->lastCallee]);
+    }
+//< Optimization omit
     emitByte(OP_RETURN);
   }
 }
@@ -1365,9 +2648,16 @@ static void whileStatement() {
   expression();
   consume(TOKEN_RIGHT_PAREN, "Expect ')' after condition.");
 
+/* Jumping Back and Forth while-statement < Optimization omit
   int exitJump = emitJump(OP_JUMP_IF_FALSE);
 
   emitByte(OP_POP);
+*/
+//> Optimization omit
+  int exitJump = emitJumpIfFalse();
+
+  emitConditionPop();
+//< Optimization omit
   statement();
 //> loop
 
@@ -1480,6 +2770,9 @@ bool compile(const char* source, Chunk* chunk) {
 //> Calls and Functions compile-signature
 ObjFunction* compile(const char* source) {
 //< Calls and Functions compile-signature
+//> Optimization omit
+  findAssignedNames(source);
+//< Optimization omit
   initScanner(source);
 /* Scanning on Demand dump-tokens < Compiling Expressions compile-chunk
   int line = -1;
@@ -1536,6 +2829,12 @@ ObjFunction* compile(const char* source) {
 */
 //> Calls and Functions call-end-compiler
   ObjFunction* function = endCompiler();
+//> Optimization omit
+  FREE_ARRAY(Token, assignedNames.names, assignedNames.capacity);
+  assignedNames.names = NULL;
+  assignedNames.count = 0;
+  assignedNames.capacity = 0;
+//< Optimization omit
   return parser.hadError ? NULL : function;
 //< Calls and Functions call-end-compiler
 }
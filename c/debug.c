@@ -8,6 +8,9 @@
 //> debug-include-value
 #include "value.h"
 //< debug-include-value
+//> Optimization omit
+#include "vm.h"
+//< Optimization omit
 
 void disassembleChunk(Chunk* chunk, const char* name) {
   printf("== %s ==\n", name);
@@ -35,8 +38,14 @@ static int invokeInstruction(const char* name, Chunk* chunk,
   uint8_t argCount = chunk->code[offset + 2];
   printf("%-16s (%d args) %4d '", name, argCount, constant);
   printValue(chunk->constants.values[constant]);
+/* Methods and Initializers invoke-instruction < Optimization omit
   printf("'\n");
   return offset + 3;
+*/
+//> Optimization omit
+  printf("' (cache %d)\n", chunk->code[offset + 3]);
+  return offset + 4;
+//< Optimization omit
 }
 //< Methods and Initializers invoke-instruction
 //> simple-instruction
@@ -52,6 +61,43 @@ static int byteInstruction(const char* name, Chunk* chunk, int offset) {
   return offset + 2; // [debug]
 }
 //< Local Variables byte-instruction
+//> Optimization omit
+static int globalInstruction(const char* name, Chunk* chunk, int offset) {
+  uint16_t slot = (uint16_t)(chunk->code[offset + 1] << 8);
+  slot |= chunk->code[offset + 2];
+  printf("%-16s %4d '", name, slot);
+  printValue(vm.globalNames.values[slot]);
+  printf("'\n");
+  return offset + 3;
+}
+
+static int propertyInstruction(const char* name, Chunk* chunk, int offset) {
+  uint8_t constant = chunk->code[offset + 1];
+  printf("%-16s %4d '", name, constant);
+  printValue(chunk->constants.values[constant]);
+  printf("' (cache %d)\n", chunk->code[offset + 2]);
+  return offset + 3;
+}
+
+static int localPropertyInstruction(const char* name, Chunk* chunk,
+                                    int offset) {
+  uint8_t slot = chunk->code[offset + 1];
+  uint8_t constant = chunk->code[offset + 2];
+  printf("%-16s %4d %4d '", name, slot, constant);
+  printValue(chunk->constants.values[constant]);
+  printf("' (cache %d)\n", chunk->code[offset + 3]);
+  return offset + 4;
+}
+
+static int loopInstruction(const char* name, Chunk* chunk, int offset) {
+  uint16_t jump = (uint16_t)(chunk->code[offset + 1] << 8);
+  jump |= chunk->code[offset + 2];
+  uint8_t loop = chunk->code[offset + 3];
+  printf("%-16s %4d -> %d (loop %d)\n", name, offset, offset + 4 - jump,
+         loop);
+  return offset + 4;
+}
+//< Optimization omit
 //> Jumping Back and Forth jump-instruction
 static int jumpInstruction(const char* name, int sign, Chunk* chunk,
                            int offset) {
@@ -98,28 +144,65 @@ int disassembleInstruction(Chunk* chunk, int offset) {
 //< Local Variables disassemble-local
 //> Global Variables disassemble-get-global
     case OP_GET_GLOBAL:
+/* Global Variables disassemble-get-global < Optimization omit
       return constantInstruction("OP_GET_GLOBAL", chunk, offset);
+*/
+//> Optimization omit
+      return globalInstruction("OP_GET_GLOBAL", chunk, offset);
+//< Optimization omit
 //< Global Variables disassemble-get-global
 //> Global Variables disassemble-define-global
     case OP_DEFINE_GLOBAL:
+/* Global Variables disassemble-define-global < Optimization omit
       return constantInstruction("OP_DEFINE_GLOBAL", chunk, offset);
+*/
+//> Optimization omit
+      return globalInstruction("OP_DEFINE_GLOBAL", chunk, offset);
+//< Optimization omit
 //< Global Variables disassemble-define-global
 //> Global Variables disassemble-set-global
     case OP_SET_GLOBAL:
+/* Global Variables disassemble-set-global < Optimization omit
       return constantInstruction("OP_SET_GLOBAL", chunk, offset);
+*/
+//> Optimization omit
+      return globalInstruction("OP_SET_GLOBAL", chunk, offset);
+//< Optimization omit
 //< Global Variables disassemble-set-global
 //> Closures disassemble-upvalue-ops
     case OP_GET_UPVALUE:
       return byteInstruction("OP_GET_UPVALUE", chunk, offset);
+//> Optimization omit
+    case OP_GET_CAPTURE:
+      return byteInstruction("OP_GET_CAPTURE", chunk, offset);
+//< Optimization omit
     case OP_SET_UPVALUE:
       return byteInstruction("OP_SET_UPVALUE", chunk, offset);
 //< Closures disassemble-upvalue-ops
 //> Classes and Instances disassemble-property-ops
     case OP_GET_PROPERTY:
+/* Classes and Instances disassemble-property-ops < Optimization omit
       return constantInstruction("OP_GET_PROPERTY", chunk, offset);
+*/
+//> Optimization omit
+      return propertyInstruction("OP_GET_PROPERTY", chunk, offset);
+//< Optimization omit
     case OP_SET_PROPERTY:
+/* Classes and Instances disassemble-property-ops < Optimization omit
       return constantInstruction("OP_SET_PROPERTY", chunk, offset);
+*/
+//> Optimization omit
+      return propertyInstruction("OP_SET_PROPERTY", chunk, offset);
+//< Optimization omit
 //< Classes and Instances disassemble-property-ops
+//> Optimization omit
+    case OP_GET_LOCAL_PROPERTY:
+      return localPropertyInstruction("OP_GET_LOCAL_PROPERTY", chunk, offset);
+    case OP_GET_FIELD:
+      return propertyInstruction("OP_GET_FIELD", chunk, offset);
+    case OP_GET_LOCAL_FIELD:
+      return localPropertyInstruction("OP_GET_LOCAL_FIELD", chunk, offset);
+//< Optimization omit
 //> Superclasses disassemble-get-super
     case OP_GET_SUPER:
       return constantInstruction("OP_GET_SUPER", chunk, offset);
@@ -146,6 +229,14 @@ int disassembleInstruction(Chunk* chunk, int offset) {
       return simpleInstruction("OP_NOT", offset);
 //< Types of Values disassemble-not
 //< A Virtual Machine disassemble-binary
+//> Optimization omit
+    case OP_ADD_NUMBER:
+      return simpleInstruction("OP_ADD_NUMBER", offset);
+    case OP_ADD_STRING:
+      return simpleInstruction("OP_ADD_STRING", offset);
+    case OP_SUBTRACT_CONSTANT:
+      return constantInstruction("OP_SUBTRACT_CONSTANT", chunk, offset);
+//< Optimization omit
 //> A Virtual Machine disassemble-negate
     case OP_NEGATE:
       return simpleInstruction("OP_NEGATE", offset);
@@ -160,14 +251,35 @@ int disassembleInstruction(Chunk* chunk, int offset) {
     case OP_JUMP_IF_FALSE:
       return jumpInstruction("OP_JUMP_IF_FALSE", 1, chunk, offset);
 //< Jumping Back and Forth disassemble-jump
+//> Optimization omit
+    case OP_JUMP_IF_NOT_LESS:
+      return jumpInstruction("OP_JUMP_IF_NOT_LESS", 1, chunk, offset);
+    case OP_JUMP_IF_NOT_GREATER:
+      return jumpInstruction("OP_JUMP_IF_NOT_GREATER", 1, chunk, offset);
+    case OP_JUMP_IF_NOT_EQUAL:
+      return jumpInstruction("OP_JUMP_IF_NOT_EQUAL", 1, chunk, offset);
+//< Optimization omit
 //> Jumping Back and Forth disassemble-loop
     case OP_LOOP:
+/* Jumping Back and Forth disassemble-loop < Optimization omit
       return jumpInstruction("OP_LOOP", -1, chunk, offset);
+*/
+//> Optimization omit
+      return loopInstruction("OP_LOOP", chunk, offset);
+//< Optimization omit
 //< Jumping Back and Forth disassemble-loop
 //> Calls and Functions disassemble-call
     case OP_CALL:
       return byteInstruction("OP_CALL", chunk, offset);
 //< Calls and Functions disassemble-call
+//> Optimization omit
+    case OP_TAIL_CALL:
+      return byteInstruction("OP_TAIL_CALL", chunk, offset);
+    case OP_CALL_GLOBAL:
+      printf("%-16s %4d (cache %d)\n", "OP_CALL_GLOBAL",
+             chunk->code[offset + 1], chunk->code[offset + 2]);
+      return offset + 3;
+//< Optimization omit
 //> Methods and Initializers disassemble-invoke
     case OP_INVOKE:
       return invokeInstruction("OP_INVOKE", chunk, offset);
@@ -193,6 +305,14 @@ int disassembleInstruction(Chunk* chunk, int offset) {
         printf("%04d      |                     %s %d\n",
                offset - 2, isLocal ? "local" : "upvalue", index);
       }
+//> Optimization omit
+      for (int j = 0; j < function->captureCount; j++) {
+        int isLocal = chunk->code[offset++];
+        int index = chunk->code[offset++];
+        printf("%04d      |                     copy %s %d\n",
+               offset - 2, isLocal ? "local" : "capture", index);
+      }
+//< Optimization omit
       
 //< disassemble-upvalues
       return offset;
@@ -222,3 +342,158 @@ int disassembleInstruction(Chunk* chunk, int offset) {
   }
 }
 //< disassemble-instruction
+//> Optimization omit
+#ifdef REGISTER_VM
+
+static const char* registerOpNames[] = {
+  [REG_MOVE]                  = "REG_MOVE",
+  [REG_LOAD_CONSTANT]         = "REG_LOAD_CONSTANT",
+  [REG_LOAD_NIL]              = "REG_LOAD_NIL",
+  [REG_LOAD_TRUE]             = "REG_LOAD_TRUE",
+  [REG_LOAD_FALSE]            = "REG_LOAD_FALSE",
+  [REG_GET_GLOBAL]            = "REG_GET_GLOBAL",
+  [REG_DEFINE_GLOBAL]         = "REG_DEFINE_GLOBAL",
+  [REG_SET_GLOBAL]            = "REG_SET_GLOBAL",
+  [REG_GET_UPVALUE]           = "REG_GET_UPVALUE",
+  [REG_SET_UPVALUE]           = "REG_SET_UPVALUE",
+  [REG_GET_CAPTURE]           = "REG_GET_CAPTURE",
+  [REG_GET_PROPERTY]          = "REG_GET_PROPERTY",
+  [REG_SET_PROPERTY]          = "REG_SET_PROPERTY",
+  [REG_GET_SUPER]             = "REG_GET_SUPER",
+  [REG_EQUAL]                 = "REG_EQUAL",
+  [REG_GREATER]               = "REG_GREATER",
+  [REG_LESS]                  = "REG_LESS",
+  [REG_ADD]                   = "REG_ADD",
+  [REG_SUBTRACT]              = "REG_SUBTRACT",
+  [REG_MULTIPLY]              = "REG_MULTIPLY",
+  [REG_DIVIDE]                = "REG_DIVIDE",
+  [REG_EQUAL_K]               = "REG_EQUAL_K",
+  [REG_GREATER_K]             = "REG_GREATER_K",
+  [REG_LESS_K]                = "REG_LESS_K",
+  [REG_ADD_K]                 = "REG_ADD_K",
+  [REG_SUBTRACT_K]            = "REG_SUBTRACT_K",
+  [REG_MULTIPLY_K]            = "REG_MULTIPLY_K",
+  [REG_DIVIDE_K]              = "REG_DIVIDE_K",
+  [REG_NOT]                   = "REG_NOT",
+  [REG_NEGATE]                = "REG_NEGATE",
+  [REG_PRINT]                 = "REG_PRINT",
+  [REG_JUMP]                  = "REG_JUMP",
+  [REG_JUMP_IF_FALSE]         = "REG_JUMP_IF_FALSE",
+  [REG_JUMP_IF_NOT_LESS]      = "REG_JUMP_IF_NOT_LESS",
+  [REG_JUMP_IF_NOT_GREATER]   = "REG_JUMP_IF_NOT_GREATER",
+  [REG_JUMP_IF_NOT_EQUAL]     = "REG_JUMP_IF_NOT_EQUAL",
+  [REG_JUMP_IF_NOT_LESS_K]    = "REG_JUMP_IF_NOT_LESS_K",
+  [REG_JUMP_IF_NOT_GREATER_K] = "REG_JUMP_IF_NOT_GREATER_K",
+  [REG_JUMP_IF_NOT_EQUAL_K]   = "REG_JUMP_IF_NOT_EQUAL_K",
+  [REG_CALL]                  = "REG_CALL",
+  [REG_TAIL_CALL]             = "REG_TAIL_CALL",
+  [REG_INVOKE]                = "REG_INVOKE",
+  [REG_SUPER_INVOKE]          = "REG_SUPER_INVOKE",
+  [REG_CLOSURE]               = "REG_CLOSURE",
+  [REG_CLOSE_UPVALUE]         = "REG_CLOSE_UPVALUE",
+  [REG_RETURN]                = "REG_RETURN",
+  [REG_CLASS]                 = "REG_CLASS",
+  [REG_INHERIT]               = "REG_INHERIT",
+  [REG_METHOD]                = "REG_METHOD",
+};
+
+void disassembleRegisterChunk(Chunk* chunk, const char* name) {
+  RegisterChunk* registers = chunk->registers;
+  if (registers == NULL) {
+    printf("== %s (stack VM only) ==\n", name);
+    return;
+  }
+
+  printf("== %s (%d registers) ==\n", name, registers->registerCount);
+  for (int offset = 0; offset < registers->count;) {
+    offset = disassembleRegisterInstruction(chunk, offset);
+  }
+}
+
+static void printConstant(Chunk* chunk, int constant) {
+  printf(" '");
+  printValue(chunk->constants.values[constant]);
+  printf("'");
+}
+
+int disassembleRegisterInstruction(Chunk* chunk, int offset) {
+  RegisterChunk* registers = chunk->registers;
+  printf("%04d ", offset);
+  if (offset > 0 &&
+      registers->lines[offset] == registers->lines[offset - 1]) {
+    printf("   | ");
+  } else {
+    printf("%4d ", registers->lines[offset]);
+  }
+
+  Instruction instruction = registers->code[offset];
+  RegisterOpCode op = (RegisterOpCode)REG_OP(instruction);
+  int b = REG_B(instruction);
+  int c = REG_C(instruction);
+  printf("%-25s %3d %3d %3d", registerOpNames[op], REG_A(instruction), b, c);
+
+  switch (op) {
+    case REG_GET_GLOBAL:
+    case REG_DEFINE_GLOBAL:
+    case REG_SET_GLOBAL:
+      printf(" '");
+      printValue(vm.globalNames.values[REG_BC(instruction)]);
+      printf("'");
+      break;
+    case REG_LOAD_CONSTANT:
+    case REG_SET_PROPERTY:
+    case REG_INVOKE:
+    case REG_SUPER_INVOKE:
+    case REG_CLASS:
+    case REG_METHOD:
+      printConstant(chunk, b);
+      break;
+    case REG_GET_PROPERTY:
+    case REG_GET_SUPER:
+    case REG_EQUAL_K:
+    case REG_GREATER_K:
+    case REG_LESS_K:
+    case REG_ADD_K:
+    case REG_SUBTRACT_K:
+    case REG_MULTIPLY_K:
+    case REG_DIVIDE_K:
+    case REG_JUMP_IF_NOT_LESS_K:
+    case REG_JUMP_IF_NOT_GREATER_K:
+    case REG_JUMP_IF_NOT_EQUAL_K:
+      printConstant(chunk, c);
+      break;
+    default:
+      break;
+  }
+
+  if (op >= REG_JUMP && op <= REG_JUMP_IF_NOT_EQUAL_K) {
+    int32_t jump = (int32_t)registers->code[offset + 1];
+    printf(" -> %d\n", offset + 2 + jump);
+    return offset + 2;
+  }
+
+  if (op == REG_GET_PROPERTY || op == REG_SET_PROPERTY ||
+      op == REG_INVOKE || op == REG_SUPER_INVOKE) {
+    printf(" (cache %d)\n", registers->code[offset + 1]);
+    return offset + 2;
+  }
+
+  printf("\n");
+  if (op == REG_CLOSURE) {
+    ObjFunction* function = AS_FUNCTION(chunk->constants.values[b]);
+    int count = function->upvalueCount + function->captureCount;
+    for (int j = 1; j <= count; j++) {
+      Instruction upvalue = registers->code[offset + j];
+      bool byValue = j > function->upvalueCount;
+      printf("%04d      |                     %s%s %d\n",
+             offset + j, byValue ? "copy " : "",
+             (upvalue & 0xff) ? "local" : (byValue ? "capture" : "upvalue"),
+             upvalue >> 8);
+    }
+    return offset + 1 + count;
+  }
+
+  return offset + 1;
+}
+#endif
+//< Optimization omit
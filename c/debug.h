@@ -6,5 +6,11 @@
 
 void disassembleChunk(Chunk* chunk, const char* name);
 int disassembleInstruction(Chunk* chunk, int offset);
+//> Optimization omit
+#ifdef REGISTER_VM
+void disassembleRegisterChunk(Chunk* chunk, const char* name);
+int disassembleRegisterInstruction(Chunk* chunk, int offset);
+#endif
+//< Optimization omit
 
 #endif
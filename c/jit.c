@@ -0,0 +1,532 @@
+//> Optimization omit
+#include <stdlib.h>
+
+#include "assembler.h"
+#include "common.h"
+#include "jit.h"
+#include "memory.h"
+
+#ifdef BASELINE_JIT
+// A baseline template JIT. Each bytecode instruction is translated on its
+// own into a fixed sequence of x86-64 machine code that does what run()
+// does for it, with no analysis across instructions. Values stay on the VM's
+// stack in memory, exactly where the interpreter would have them, so the GC
+// and runtime errors work unchanged and a frame can move between compiled
+// code and the interpreter at any call boundary.
+//
+// Loading and storing locals and upvalues, jumps, and arithmetic and
+// comparisons on numbers are compiled inline. Everything else, and the slow
+// paths when an operand isn't a number, calls one of the jit...() helpers in
+// vm.c, which share their code with the interpreter.
+//
+// Compiled code and the interpreter call each other's functions directly.
+// When compiled code calls a function that hasn't been compiled, though, it
+// returns to run(), which runs the callee. When the callee returns, run()
+// resumes the caller's compiled code at the instruction after the call.
+
+// A jump to a bytecode offset, patched once all the instructions have been
+// compiled and the target's address is known.
+typedef struct {
+  int patch;
+  int target;
+} JumpFixup;
+
+typedef struct {
+  Assembler as;
+  Chunk* chunk;
+
+  // The offset in code of each bytecode instruction, indexed by its offset
+  // in the chunk.
+  int* offsets;
+
+  JumpFixup* fixups;
+  int fixupCount;
+  int fixupCapacity;
+} JitCompiler;
+
+// Jumps to the instruction at bytecode offset [target].
+static void emitBytecodeJump(JitCompiler* jit, Condition condition,
+                             int target) {
+  if (jit->fixupCapacity < jit->fixupCount + 1) {
+    int oldCapacity = jit->fixupCapacity;
+    jit->fixupCapacity = GROW_CAPACITY(oldCapacity);
+    jit->fixups = GROW_ARRAY(JumpFixup, jit->fixups,
+        oldCapacity, jit->fixupCapacity);
+  }
+
+  JumpFixup* fixup = &jit->fixups[jit->fixupCount++];
+  fixup->patch = emitJump(&jit->as, condition);
+  fixup->target = target;
+}
+
+// Spends one of the budget's back-edges or calls. If it has run out, calls
+// jitBudget() with the frame at [ip], and returns to run() there unless the
+// hook lets the code carry on. The budget is spent before a call rather
+// than after, since the callee may run compiled code nested in the helper.
+static void emitSpendBudget(JitCompiler* jit, uint8_t* ip) {
+  Assembler* as = &jit->as;
+  emitAluMemory64(as, IMM_SUB, VM_REG, offsetof(VM, budget), 1);
+  int left = emitJump(as, CC_G);
+
+  emitRuntimeCall(as, ip, ADDRESS(jitBudget), 0, 0, false);
+  emitBytes(as, 0x85, 0xc0); // test eax, eax
+  int resume = emitJump(as, CC_E);
+  emitByte(as, 0x3d); // cmp eax, imm32
+  emitInt32(as, INTERPRET_RUNTIME_ERROR);
+  emitJumpTo(as, CC_E, as->exitError);
+  emitJumpTo(as, CC_ALWAYS, as->exitSuspended);
+
+  patchJump(as, left);
+  patchJump(as, resume);
+}
+
+// Calls one of the helpers that return a JitCallResult for the call
+// instruction at [code]. If the callee has to be run by the interpreter,
+// returns to run().
+static void emitCall(JitCompiler* jit, uint8_t* code, uint8_t* next,
+                     uint64_t helper, uint64_t arg1, uint64_t arg2) {
+  Assembler* as = &jit->as;
+  emitSpendBudget(jit, code);
+  emitRuntimeCall(as, next, helper, arg1, arg2, false);
+
+  emitByte(as, 0x3d); // cmp eax, imm32
+  emitInt32(as, JIT_CALL_RETURNED);
+  int returned = emitJump(as, CC_E);
+  emitBytes(as, 0x85, 0xc0); // test eax, eax
+  emitJumpTo(as, CC_E, as->exitError);
+  emitByte(as, 0x3d); // cmp eax, imm32
+  emitInt32(as, JIT_CALL_SUSPENDED);
+  emitJumpTo(as, CC_E, as->exitSuspended);
+  emitJumpTo(as, CC_ALWAYS, as->exitOk);
+  patchJump(as, returned);
+}
+
+// Returns from a function with no upvalues to close to a caller. Returning
+// from the first frame in a segment of the stack, like the script's, or
+// closing upvalues is left to jitReturn().
+static void emitReturn(JitCompiler* jit, uint8_t* next) {
+  Assembler* as = &jit->as;
+  emitLoad(as, RAX, VM_REG, offsetof(VM, openUpvalues));
+  emitAlu(as, ALU_TEST, RAX, RAX);
+  int noUpvalues = emitJump(as, CC_E);
+  emitLoad(as, RAX, RAX, offsetof(ObjUpvalue, location));
+  emitAlu(as, ALU_CMP, RAX, SLOTS_REG);
+  int closeUpvalues = emitJump(as, CC_AE);
+  patchJump(as, noUpvalues);
+
+  emitLoad(as, RAX, VM_REG, offsetof(VM, stack));
+  emitAlu(as, ALU_CMP, RAX, SLOTS_REG);
+  int firstFrame = emitJump(as, CC_E);
+  emitAluMemory32(as, IMM_SUB, VM_REG, offsetof(VM, frameCount), 1);
+
+  // Replace the callee with the result.
+  emitPeek(as, RAX, 0);
+  emitStore(as, SLOTS_REG, 0, RAX);
+  emitAlu(as, ALU_MOV, RCX, SLOTS_REG);
+  emitAluImmediate(as, IMM_ADD, RCX, sizeof(Value));
+  emitStore(as, VM_REG, offsetof(VM, stackTop), RCX);
+  emitJumpTo(as, CC_ALWAYS, as->exitOk);
+
+  patchJump(as, closeUpvalues);
+  patchJump(as, firstFrame);
+  emitRuntimeCall(as, next, ADDRESS(jitReturn), 0, 0, false);
+  emitJumpTo(as, CC_ALWAYS, as->exitOk);
+}
+
+// Arithmetic and comparison instructions on two numbers. Anything else goes
+// to jitBinaryOp().
+static void emitBinaryOp(JitCompiler* jit, OpCode instruction,
+                         uint8_t* next) {
+  Assembler* as = &jit->as;
+  emitPeek(as, RAX, 1);
+  emitPeek(as, RCX, 0);
+  int aNotNumber = emitJumpIfNotNumber(as, RAX);
+  int bNotNumber = emitJumpIfNotNumber(as, RCX);
+
+  emitMoveToXmm(as, 0, RAX);
+  emitMoveToXmm(as, 1, RCX);
+  switch (instruction) {
+    case OP_GREATER:
+      emitCompareDoubles(as, 0, 1);
+      emitSetAl(as, CC_A);
+      emitBoolFromAl(as);
+      break;
+
+    case OP_LESS:
+      emitCompareDoubles(as, 1, 0);
+      emitSetAl(as, CC_A);
+      emitBoolFromAl(as);
+      break;
+
+    default: {
+      SseOp op = SSE_ADD;
+      if (instruction == OP_SUBTRACT) op = SSE_SUB;
+      if (instruction == OP_MULTIPLY) op = SSE_MUL;
+      if (instruction == OP_DIVIDE) op = SSE_DIV;
+      emitSse(as, op, 0, 1);
+      emitMoveFromXmm(as, RAX, 0);
+      break;
+    }
+  }
+  emitStore(as, STACK_REG, -2 * (int32_t)sizeof(Value), RAX);
+  emitDrop(as, 1);
+  int done = emitJump(as, CC_ALWAYS);
+
+  patchJump(as, aNotNumber);
+  patchJump(as, bNotNumber);
+  emitRuntimeCall(as, next, ADDRESS(jitBinaryOp), instruction, 0, true);
+  patchJump(as, done);
+}
+
+// OP_JUMP_IF_NOT_LESS and OP_JUMP_IF_NOT_GREATER.
+static void emitJumpUnless(JitCompiler* jit, OpCode comparison,
+                           uint8_t* next, int target) {
+  Assembler* as = &jit->as;
+  emitPeek(as, RAX, 1);
+  emitPeek(as, RCX, 0);
+  int aNotNumber = emitJumpIfNotNumber(as, RAX);
+  int bNotNumber = emitJumpIfNotNumber(as, RCX);
+
+  emitMoveToXmm(as, 0, RAX);
+  emitMoveToXmm(as, 1, RCX);
+  emitDrop(as, 2);
+  if (comparison == OP_LESS) {
+    emitCompareDoubles(as, 1, 0);
+  } else {
+    emitCompareDoubles(as, 0, 1);
+  }
+  int passed = emitJump(as, CC_A);
+  emitPushConstant(as, FALSE_VAL);
+  emitBytecodeJump(jit, CC_ALWAYS, target);
+
+  // Only reports the error.
+  patchJump(as, aNotNumber);
+  patchJump(as, bNotNumber);
+  emitRuntimeCall(as, next, ADDRESS(jitBinaryOp), comparison, 0, false);
+  emitJumpTo(as, CC_ALWAYS, as->exitError);
+
+  patchJump(as, passed);
+}
+
+// Compiles the instruction at [offset]. Returns false if it can't.
+static bool compileInstruction(JitCompiler* jit, int offset) {
+  Assembler* as = &jit->as;
+  Chunk* chunk = jit->chunk;
+  uint8_t* code = chunk->code + offset;
+  Value* constants = chunk->constants.values;
+  int next = offset + instructionLength(chunk, offset);
+  uint8_t* resume = chunk->code + next;
+
+#define READ_SHORT(index) ((uint16_t)((code[index] << 8) | code[(index) + 1]))
+#define CONSTANT(index) ADDRESS(AS_OBJ(constants[code[index]]))
+
+  switch ((OpCode)code[0]) {
+    case OP_CONSTANT: emitPushConstant(as, constants[code[1]]); break;
+    case OP_NIL:      emitPushConstant(as, NIL_VAL); break;
+    case OP_TRUE:     emitPushConstant(as, TRUE_VAL); break;
+    case OP_FALSE:    emitPushConstant(as, FALSE_VAL); break;
+    case OP_POP:      emitDrop(as, 1); break;
+    case OP_GET_LOCAL: emitGetLocal(as, code[1]); break;
+
+    case OP_SET_LOCAL:
+      emitPeek(as, RAX, 0);
+      emitStore(as, SLOTS_REG, sizeof(Value) * code[1], RAX);
+      break;
+
+    case OP_GET_GLOBAL: {
+      // Only reading an undefined global, to report it, needs the helper.
+      int undefined = emitLoadGlobal(as, READ_SHORT(1));
+      emitPush(as, RAX);
+      int done = emitJump(as, CC_ALWAYS);
+      patchJump(as, undefined);
+      emitRuntimeCall(as, resume, ADDRESS(jitGetGlobal),
+          READ_SHORT(1), 0, true);
+      patchJump(as, done);
+      break;
+    }
+
+    case OP_DEFINE_GLOBAL:
+      emitRuntimeCall(as, resume, ADDRESS(jitDefineGlobal),
+          READ_SHORT(1), 0, false);
+      break;
+
+    case OP_SET_GLOBAL: {
+      int undefined = emitLoadGlobal(as, READ_SHORT(1));
+      emitPeek(as, RAX, 0);
+      emitStore(as, R9, 0, RAX);
+      int done = emitJump(as, CC_ALWAYS);
+      patchJump(as, undefined);
+      emitRuntimeCall(as, resume, ADDRESS(jitSetGlobal),
+          READ_SHORT(1), 0, true);
+      patchJump(as, done);
+      break;
+    }
+
+    case OP_GET_UPVALUE:
+    case OP_SET_UPVALUE:
+      emitUpvalueLocation(as, RAX, code[1]);
+      if (code[0] == OP_GET_UPVALUE) {
+        emitLoad(as, RAX, RAX, 0);
+        emitPush(as, RAX);
+      } else {
+        emitPeek(as, RCX, 0);
+        emitStore(as, RAX, 0, RCX);
+      }
+      break;
+
+    case OP_GET_CAPTURE:
+      emitGetCapture(as, code[1]);
+      break;
+
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_GET_LOCAL_FIELD:
+      emitGetLocal(as, code[1]);
+      emitRuntimeCall(as, resume, ADDRESS(jitGetProperty),
+          CONSTANT(2), 0, true);
+      break;
+
+    case OP_GET_PROPERTY:
+    case OP_GET_FIELD:
+      emitRuntimeCall(as, resume, ADDRESS(jitGetProperty),
+          CONSTANT(1), 0, true);
+      break;
+
+    case OP_SET_PROPERTY:
+      emitRuntimeCall(as, resume, ADDRESS(jitSetProperty),
+          CONSTANT(1), 0, true);
+      break;
+
+    case OP_GET_SUPER:
+      emitRuntimeCall(as, resume, ADDRESS(jitGetSuper),
+          CONSTANT(1), 0, true);
+      break;
+
+    case OP_EQUAL:
+      emitValuesEqual(as);
+      emitBoolFromAl(as);
+      emitStore(as, STACK_REG, -2 * (int32_t)sizeof(Value), RAX);
+      emitDrop(as, 1);
+      break;
+
+    case OP_GREATER:  emitBinaryOp(jit, OP_GREATER, resume); break;
+    case OP_LESS:     emitBinaryOp(jit, OP_LESS, resume); break;
+    case OP_ADD:
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+      emitBinaryOp(jit, OP_ADD, resume);
+      break;
+    case OP_SUBTRACT: emitBinaryOp(jit, OP_SUBTRACT, resume); break;
+    case OP_MULTIPLY: emitBinaryOp(jit, OP_MULTIPLY, resume); break;
+    case OP_DIVIDE:   emitBinaryOp(jit, OP_DIVIDE, resume); break;
+
+    case OP_SUBTRACT_CONSTANT:
+      emitPushConstant(as, constants[code[1]]);
+      emitBinaryOp(jit, OP_SUBTRACT, resume);
+      break;
+
+    case OP_NOT:
+      emitPeek(as, RAX, 0);
+      emitTestFalsey(as, RAX);
+      emitSetAl(as, CC_BE);
+      emitBoolFromAl(as);
+      emitStore(as, STACK_REG, -(int32_t)sizeof(Value), RAX);
+      break;
+
+    case OP_NEGATE: {
+      emitPeek(as, RAX, 0);
+      int notNumber = emitJumpIfNotNumber(as, RAX);
+      emitMoveImmediate(as, RCX, SIGN_BIT);
+      emitAlu(as, ALU_XOR, RAX, RCX);
+      emitStore(as, STACK_REG, -(int32_t)sizeof(Value), RAX);
+      int done = emitJump(as, CC_ALWAYS);
+
+      patchJump(as, notNumber);
+      emitRuntimeCall(as, resume, ADDRESS(jitNegate), 0, 0, true);
+      patchJump(as, done);
+      break;
+    }
+
+    case OP_PRINT:
+      emitRuntimeCall(as, resume, ADDRESS(jitPrint), 0, 0, false);
+      break;
+
+    case OP_JUMP:
+      emitBytecodeJump(jit, CC_ALWAYS, next + READ_SHORT(1));
+      break;
+
+    case OP_JUMP_IF_FALSE:
+      emitPeek(as, RAX, 0);
+      emitTestFalsey(as, RAX);
+      emitBytecodeJump(jit, CC_BE, next + READ_SHORT(1));
+      break;
+
+    case OP_JUMP_IF_NOT_LESS:
+      emitJumpUnless(jit, OP_LESS, resume, next + READ_SHORT(1));
+      break;
+
+    case OP_JUMP_IF_NOT_GREATER:
+      emitJumpUnless(jit, OP_GREATER, resume, next + READ_SHORT(1));
+      break;
+
+    case OP_JUMP_IF_NOT_EQUAL: {
+      emitValuesEqual(as);
+      emitDrop(as, 2);
+      emitBytes(as, 0x84, 0xc0); // test al, al
+      int equal = emitJump(as, CC_NE);
+      emitPushConstant(as, FALSE_VAL);
+      emitBytecodeJump(jit, CC_ALWAYS, next + READ_SHORT(1));
+      patchJump(as, equal);
+      break;
+    }
+
+    case OP_LOOP:
+      emitSpendBudget(jit, resume - READ_SHORT(1));
+      emitBytecodeJump(jit, CC_ALWAYS, next - READ_SHORT(1));
+      break;
+
+    case OP_CALL:
+      emitCall(jit, code, resume, ADDRESS(jitCall), code[1], 0);
+      break;
+
+    case OP_TAIL_CALL:
+      emitCall(jit, code, resume, ADDRESS(jitTailCall), code[1], 0);
+      break;
+
+    case OP_CALL_GLOBAL:
+      emitCall(jit, code, resume, ADDRESS(jitCallGlobal), code[1], 0);
+      break;
+
+    case OP_INVOKE:
+      emitCall(jit, code, resume, ADDRESS(jitInvoke), CONSTANT(1),
+               code[2]);
+      break;
+
+    case OP_SUPER_INVOKE:
+      emitCall(jit, code, resume, ADDRESS(jitSuperInvoke), CONSTANT(1),
+               code[2]);
+      break;
+
+    case OP_CLOSURE:
+      emitRuntimeCall(as, resume, ADDRESS(jitClosure),
+          CONSTANT(1), ADDRESS(code + 2), false);
+      break;
+
+    case OP_CLOSE_UPVALUE:
+      emitRuntimeCall(as, resume, ADDRESS(jitCloseUpvalue), 0, 0, false);
+      break;
+
+    case OP_RETURN: emitReturn(jit, resume); break;
+
+    case OP_CLASS:
+      emitRuntimeCall(as, resume, ADDRESS(jitClass), CONSTANT(1), 0, false);
+      break;
+
+    case OP_INHERIT:
+      emitRuntimeCall(as, resume, ADDRESS(jitInherit), 0, 0, true);
+      break;
+
+    case OP_METHOD:
+      emitRuntimeCall(as, resume, ADDRESS(jitMethod), CONSTANT(1), 0, false);
+      break;
+
+    default:
+      return false;
+  }
+
+#undef READ_SHORT
+#undef CONSTANT
+  return true;
+}
+
+void jitCompile(ObjFunction* function) {
+  // The call count that makes a function hot comes around again if it
+  // wraps.
+  if (function->jitCode != NULL) return;
+
+  Chunk* chunk = &function->chunk;
+
+  JitCompiler jit;
+  initAssembler(&jit.as);
+  jit.chunk = chunk;
+  jit.fixups = NULL;
+  jit.fixupCount = 0;
+  jit.fixupCapacity = 0;
+  jit.offsets = ALLOCATE(int, chunk->count);
+
+  int entry = emitEntryAndExits(&jit.as);
+
+  bool compiled = true;
+  for (int offset = 0; offset < chunk->count;
+       offset += instructionLength(chunk, offset)) {
+    jit.offsets[offset] = jit.as.count;
+    if (!compileInstruction(&jit, offset)) {
+      compiled = false;
+      break;
+    }
+  }
+
+  uint8_t* code = NULL;
+  if (compiled) {
+    for (int i = 0; i < jit.fixupCount; i++) {
+      JumpFixup* fixup = &jit.fixups[i];
+      patchJumpTo(&jit.as, fixup->patch, jit.offsets[fixup->target]);
+    }
+
+    code = makeExecutable(&jit.as);
+  }
+
+  if (code != NULL) {
+    JitCode* jitCode = ALLOCATE(JitCode, 1);
+    jitCode->code = code;
+    jitCode->enter = (JitFunction)(code + entry);
+    jitCode->entryCount = chunk->count;
+    jitCode->entries = ALLOCATE(void*, chunk->count);
+    for (int offset = 0; offset < chunk->count; offset++) {
+      jitCode->entries[offset] = NULL;
+    }
+
+    // A frame can start running compiled code when it's called, and resume
+    // in it when it's returned to.
+    jitCode->entries[0] = code + jit.offsets[0];
+    for (int offset = 0; offset < chunk->count;) {
+      OpCode instruction = (OpCode)chunk->code[offset];
+      offset += instructionLength(chunk, offset);
+      if ((instruction == OP_CALL || instruction == OP_CALL_GLOBAL ||
+           instruction == OP_INVOKE || instruction == OP_SUPER_INVOKE) &&
+          offset < chunk->count) {
+        jitCode->entries[offset] = code + jit.offsets[offset];
+      }
+    }
+
+    function->jitCode = jitCode;
+  }
+
+  freeAssembler(&jit.as);
+  FREE_ARRAY(JumpFixup, jit.fixups, jit.fixupCapacity);
+  FREE_ARRAY(int, jit.offsets, chunk->count);
+}
+
+void jitFree(ObjFunction* function) {
+  JitCode* jitCode = function->jitCode;
+  if (jitCode == NULL) return;
+
+  FREE_ARRAY(void*, jitCode->entries, jitCode->entryCount);
+  FREE(JitCode, jitCode);
+  function->jitCode = NULL;
+}
+
+void jitFreeCode() {
+  freeExecutableCode();
+}
+
+void* jitEntry(CallFrame* frame) {
+  ObjFunction* function = frame->closure->function;
+  if (function->jitCode == NULL) return NULL;
+  return function->jitCode->entries[frame->ip - function->chunk.code];
+}
+
+InterpretResult jitRun(CallFrame* frame) {
+  return frame->closure->function->jitCode->enter(frame, jitEntry(frame));
+}
+#endif
+//< Optimization omit
@@ -0,0 +1,81 @@
+//> Optimization omit
+#ifndef clox_jit_h
+#define clox_jit_h
+
+#include "common.h"
+#include "object.h"
+#include "vm.h"
+
+#ifdef BASELINE_JIT
+// Runs compiled code for [frame], starting at [entry], until the frame
+// returns, calls a function that the interpreter has to run, or a runtime
+// error occurs.
+typedef InterpretResult (*JitFunction)(CallFrame* frame, void* entry);
+
+// The machine code compiled from a function's bytecode.
+typedef struct sJitCode {
+  uint8_t* code;
+  JitFunction enter;
+  // For each bytecode offset, the address in code to resume a frame at that
+  // point. Only the start of the function and the instructions after calls
+  // are resumable. The others are NULL.
+  void** entries;
+  int entryCount;
+} JitCode;
+
+// What a call from compiled code did.
+typedef enum {
+  JIT_CALL_ERROR,
+  // The callee's result is on the stack.
+  JIT_CALL_RETURNED,
+  // Left frames on the call stack that run() has to run before the caller
+  // can resume.
+  JIT_CALL_ENTERED,
+  // The budget hook suspended the VM while the callee ran.
+  JIT_CALL_SUSPENDED
+} JitCallResult;
+
+void jitCompile(ObjFunction* function);
+void jitFree(ObjFunction* function);
+void jitFreeCode();
+void* jitEntry(CallFrame* frame);
+InterpretResult jitRun(CallFrame* frame);
+
+// Calls from compiled code, which return a JitCallResult.
+int jitCall(int argCount);
+int jitCallGlobal(int argCount);
+int jitInvoke(ObjString* name, int argCount);
+int jitSuperInvoke(ObjString* name, int argCount);
+int jitTailCall(int argCount);
+
+// Called by compiled code when it runs out of budget, with the frame's ip
+// where the VM carries on.
+InterpretResult jitBudget();
+#endif
+
+#if defined(BASELINE_JIT) || defined(AOT_RUNTIME)
+// Runtime helpers in vm.c that compiled code calls for anything more than
+// moving values around and doing arithmetic on numbers. Compiled code keeps
+// the stack in memory, and it writes vm.stackTop and the frame's ip back
+// before calling one, so that the GC and runtimeError() see the same state
+// they would in the interpreter. Code compiled ahead of time to C uses them
+// too.
+bool jitGetGlobal(int slot);
+void jitDefineGlobal(int slot);
+bool jitSetGlobal(int slot);
+bool jitGetProperty(ObjString* name);
+bool jitSetProperty(ObjString* name);
+bool jitGetSuper(ObjString* name);
+bool jitBinaryOp(int instruction);
+bool jitNegate();
+void jitPrint();
+void jitClosure(ObjFunction* function, uint8_t* upvalues);
+void jitCloseUpvalue();
+void jitReturn();
+void jitClass(ObjString* name);
+bool jitInherit();
+void jitMethod(ObjString* name);
+#endif
+
+#endif
+//< Optimization omit
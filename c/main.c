@@ -1,11 +1,24 @@
 //> Chunks of Bytecode main-c
+//> Optimization omit
+// SIGUSR1 isn't part of C99.
+#define _DEFAULT_SOURCE
+
+//< Optimization omit
 //> Scanning on Demand main-includes
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+//> Optimization omit
+#include <limits.h>
+#include <signal.h>
+//< Optimization omit
 
 //< Scanning on Demand main-includes
 #include "common.h"
+//> Optimization omit
+#include "aot.h"
+#include "compiler.h"
+//< Optimization omit
 //> main-include-chunk
 #include "chunk.h"
 //< main-include-chunk
@@ -67,16 +80,178 @@ static char* readFile(const char* path) {
   return buffer;
 }
 //< Scanning on Demand read-file
+//> Optimization omit
+// What the budget hook --on-budget installs does, and the budget it gives
+// the script each time.
+static BudgetAction budgetAction = BUDGET_ABORT;
+static bool restartOnBudget = false;
+static int64_t budgetSize = NO_BUDGET;
+
+static BudgetAction budgetExhausted() {
+  printf("budget exhausted\n");
+  vm.budget = budgetSize;
+  return budgetAction;
+}
+
+//< Optimization omit
 //> Scanning on Demand run-file
 static void runFile(const char* path) {
   char* source = readFile(path);
   InterpretResult result = interpret(source);
+//> Optimization omit
+  // A script the budget hook suspended either carries on where it left
+  // off, or starts over without a budget, abandoning the suspended run.
+  while (result == INTERPRET_SUSPENDED) {
+    if (restartOnBudget) {
+      vm.budget = NO_BUDGET;
+      result = interpret(source);
+    } else {
+      result = resumeVM();
+    }
+  }
+//< Optimization omit
   free(source); // [owner]
 
   if (result == INTERPRET_COMPILE_ERROR) exit(65);
   if (result == INTERPRET_RUNTIME_ERROR) exit(70);
 }
 //< Scanning on Demand run-file
+//> Optimization omit
+// Turns execution tracing on or off, so "kill -USR1" can look inside a
+// script that's already running.
+static void toggleTracing(int signal) {
+  vm.traceExecution = !vm.traceExecution;
+}
+
+// The tier-up hooks that --log-tier-up wrapped.
+static HotFunctionHook loggedHotFunction = NULL;
+static HotLoopHook loggedHotLoop = NULL;
+
+static void logHotFunction(ObjFunction* function) {
+  printf("hot function %s\n",
+         function->name == NULL ? "script" : function->name->chars);
+  if (loggedHotFunction != NULL) loggedHotFunction(function);
+}
+
+static bool logHotLoop(Loop* loop) {
+  // Once the hook has installed code, it's called at every back-edge.
+  if (loop->optimized == NULL) {
+    Chunk* chunk = &FRAME_AT(vm.frameCount - 1)->closure->function->chunk;
+    printf("hot loop at line %d\n", chunk->lines[loop->header]);
+  }
+  return loggedHotLoop == NULL || loggedHotLoop(loop);
+}
+
+static void usage() {
+  fprintf(stderr,
+          "Usage: clox [options] [path]\n"
+          "       clox --emit-c path\n"
+          "\n"
+          "Options:\n"
+          "  --max-depth n    Allow calls to nest n deep.\n"
+          "  --trace          Print each instruction before it runs.\n"
+          "  --hot-calls n    Make functions hot after n calls.\n"
+          "  --hot-loops n    Make loops hot after n back-edges.\n"
+          "  --log-tier-up    Print when functions and loops get hot.\n"
+          "  --no-tier-up     Remove the tier-up hooks.\n"
+          "  --budget n       Stop after n calls and loop iterations.\n"
+          "  --on-budget a    Then continue, abort, suspend and resume, or\n"
+          "                   restart the script.\n");
+}
+
+// Parses the number [text] given to [option]. Exits if it isn't one, or is
+// less than [min].
+static int numberOption(const char* option, const char* text, int min) {
+  char* end;
+  long number = strtol(text, &end, 10);
+  if (*text == '\0' || *end != '\0' || number < min || number > INT_MAX) {
+    fprintf(stderr, "%s needs a number of at least %d.\n", option, min);
+    exit(64);
+  }
+
+  return (int)number;
+}
+
+// Applies the option at the start of the [argc] arguments in [argv].
+// Returns how many arguments it used, or 0 if it isn't an option.
+static int parseOption(int argc, const char* argv[]) {
+  const char* option = argv[0];
+  if (strcmp(option, "--trace") == 0) {
+    vm.traceExecution = true;
+    return 1;
+  }
+
+  if (strcmp(option, "--log-tier-up") == 0) {
+    loggedHotFunction = vm.onHotFunction;
+    loggedHotLoop = vm.onHotLoop;
+    vm.onHotFunction = logHotFunction;
+    vm.onHotLoop = logHotLoop;
+    return 1;
+  }
+
+  if (strcmp(option, "--no-tier-up") == 0) {
+    vm.onHotFunction = NULL;
+    vm.onHotLoop = NULL;
+    return 1;
+  }
+
+  if (argc < 2) return 0;
+
+  if (strcmp(option, "--max-depth") == 0) {
+    vm.maxFrames = numberOption(option, argv[1], 1);
+    return 2;
+  }
+
+  if (strcmp(option, "--hot-calls") == 0) {
+    vm.hotCallThreshold = (unsigned int)numberOption(option, argv[1], 0);
+    return 2;
+  }
+
+  if (strcmp(option, "--hot-loops") == 0) {
+    vm.hotLoopThreshold = (unsigned int)numberOption(option, argv[1], 1);
+    return 2;
+  }
+
+  if (strcmp(option, "--budget") == 0) {
+    budgetSize = numberOption(option, argv[1], 1);
+    vm.budget = budgetSize;
+    return 2;
+  }
+
+  if (strcmp(option, "--on-budget") == 0) {
+    const char* action = argv[1];
+    if (strcmp(action, "continue") == 0) {
+      budgetAction = BUDGET_CONTINUE;
+    } else if (strcmp(action, "abort") == 0) {
+      budgetAction = BUDGET_ABORT;
+    } else if (strcmp(action, "suspend") == 0) {
+      budgetAction = BUDGET_SUSPEND;
+    } else if (strcmp(action, "restart") == 0) {
+      budgetAction = BUDGET_SUSPEND;
+      restartOnBudget = true;
+    } else {
+      fprintf(stderr,
+              "--on-budget needs continue, abort, suspend or restart.\n");
+      exit(64);
+    }
+
+    vm.onBudgetExhausted = budgetExhausted;
+    return 2;
+  }
+
+  return 0;
+}
+
+// Writes the C translation of the script at [path] to stdout.
+static void emitC(const char* path) {
+  char* source = readFile(path);
+  ObjFunction* function = compile(source);
+  if (function == NULL) exit(65);
+
+  aotEmit(stdout, source, function);
+  free(source);
+}
+//< Optimization omit
 
 int main(int argc, const char* argv[]) {
 //> A Virtual Machine main-init-vm
@@ -132,12 +307,36 @@ int main(int argc, const char* argv[]) {
   interpret(&chunk);
 */
 //> Scanning on Demand args
+//> Optimization omit
+  // Options come before the script's path.
+  while (argc >= 2 && strncmp(argv[1], "--", 2) == 0) {
+    int used = parseOption(argc - 1, argv + 1);
+    if (used == 0) break;
+
+    argc -= used;
+    argv += used;
+  }
+
+#ifdef SIGUSR1
+  signal(SIGUSR1, toggleTracing);
+#endif
+
+//< Optimization omit
   if (argc == 1) {
     repl();
   } else if (argc == 2) {
     runFile(argv[1]);
+//> Optimization omit
+  } else if (argc == 3 && strcmp(argv[1], "--emit-c") == 0) {
+    emitC(argv[2]);
+//< Optimization omit
   } else {
+/* Scanning on Demand args < Optimization omit
     fprintf(stderr, "Usage: clox [path]\n");
+*/
+//> Optimization omit
+    usage();
+//< Optimization omit
     exit(64);
   }
   
@@ -4,7 +4,13 @@
 //> Garbage Collection memory-include-compiler
 #include "compiler.h"
 //< Garbage Collection memory-include-compiler
+//> Optimization omit
+#include "jit.h"
+//< Optimization omit
 #include "memory.h"
+//> Optimization omit
+#include "trace.h"
+//< Optimization omit
 //> Strings memory-include-vm
 #include "vm.h"
 //< Strings memory-include-vm
@@ -91,6 +97,30 @@ static void markArray(ValueArray* array) {
   }
 }
 //< Garbage Collection mark-array
+//> Optimization omit
+// Inline caches keep the classes, closures and shapes they hold alive, so
+// that one freed and another allocated in its place can't hit an old
+// entry.
+static void markInlineCaches(Chunk* chunk) {
+  for (int i = 0; i < chunk->invokeCacheCount; i++) {
+    InvokeCache* cache = &chunk->invokeCaches[i];
+    for (int j = 0; j < cache->count; j++) {
+      markObject((Obj*)cache->classes[j]);
+      markObject((Obj*)cache->methods[j]);
+    }
+  }
+
+  for (int i = 0; i < chunk->propertyCacheCount; i++) {
+    PropertyCache* cache = &chunk->propertyCaches[i];
+    markObject((Obj*)cache->shape);
+    markObject((Obj*)cache->transition);
+  }
+
+  for (int i = 0; i < chunk->callCacheCount; i++) {
+    markObject((Obj*)chunk->callCaches[i].closure);
+  }
+}
+//< Optimization omit
 //> Garbage Collection blacken-object
 static void blackenObject(Obj* object) {
 //> log-blacken-object
@@ -116,8 +146,18 @@ static void blackenObject(Obj* object) {
       ObjClass* klass = (ObjClass*)object;
       markObject((Obj*)klass->name);
 //> Methods and Initializers mark-methods
+/* Methods and Initializers mark-methods < Optimization omit
       markTable(&klass->methods);
+*/
+//> Optimization omit
+      for (int i = 0; i < klass->methodCapacity; i++) {
+        markObject((Obj*)klass->methods[i]);
+      }
+//< Optimization omit
 //< Methods and Initializers mark-methods
+//> Optimization omit
+      markObject((Obj*)klass->emptyShape);
+//< Optimization omit
       break;
     }
 
@@ -126,6 +166,16 @@ static void blackenObject(Obj* object) {
     case OBJ_CLOSURE: {
       ObjClosure* closure = (ObjClosure*)object;
       markObject((Obj*)closure->function);
+//> Optimization omit
+      for (int i = 0; i < closure->captureCount; i++) {
+        markValue(closure->captures[i]);
+      }
+
+      // A closure that doesn't escape is only reachable while the frame
+      // that created it runs, and that frame's closure keeps the upvalues
+      // it shares alive. The rest live on the stack.
+      if (!closure->function->escapes) break;
+//< Optimization omit
       for (int i = 0; i < closure->upvalueCount; i++) {
         markObject((Obj*)closure->upvalues[i]);
       }
@@ -138,6 +188,12 @@ static void blackenObject(Obj* object) {
       ObjFunction* function = (ObjFunction*)object;
       markObject((Obj*)function->name);
       markArray(&function->chunk.constants);
+//> Optimization omit
+      markInlineCaches(&function->chunk);
+#ifdef TRACE_JIT
+      markTraces(&function->chunk);
+#endif
+//< Optimization omit
       break;
     }
 
@@ -146,7 +202,15 @@ static void blackenObject(Obj* object) {
     case OBJ_INSTANCE: {
       ObjInstance* instance = (ObjInstance*)object;
       markObject((Obj*)instance->klass);
+/* Classes and Instances blacken-instance < Optimization omit
       markTable(&instance->fields);
+*/
+//> Optimization omit
+      markObject((Obj*)instance->shape);
+      for (int i = 0; i < instance->shape->fieldCount; i++) {
+        markValue(instance->fields[i]);
+      }
+//< Optimization omit
       break;
     }
 
@@ -157,6 +221,16 @@ static void blackenObject(Obj* object) {
       break;
 
 //< blacken-upvalue
+//> Optimization omit
+    case OBJ_SHAPE: {
+      ObjShape* shape = (ObjShape*)object;
+      markObject((Obj*)shape->klass);
+      markTable(&shape->slots);
+      markTable(&shape->transitions);
+      break;
+    }
+
+//< Optimization omit
     case OBJ_NATIVE:
     case OBJ_STRING:
       break;
@@ -182,7 +256,12 @@ static void freeObject(Obj* object) {
     case OBJ_CLASS: {
 //> Methods and Initializers free-methods
       ObjClass* klass = (ObjClass*)object;
+/* Methods and Initializers free-methods < Optimization omit
       freeTable(&klass->methods);
+*/
+//> Optimization omit
+      FREE_ARRAY(ObjClosure*, klass->methods, klass->methodCapacity);
+//< Optimization omit
 //< Methods and Initializers free-methods
       FREE(ObjClass, object);
       break;
@@ -193,8 +272,18 @@ static void freeObject(Obj* object) {
     case OBJ_CLOSURE: {
 //> free-upvalues
       ObjClosure* closure = (ObjClosure*)object;
+/* Closures free-upvalues < Optimization omit
       FREE_ARRAY(ObjUpvalue*, closure->upvalues, closure->upvalueCount);
+*/
+//> Optimization omit
+      reallocate(closure->upvalues,
+          upvalueArraySize(closure->upvalueCount,
+                           closure->stackUpvalues != NULL), 0);
+//< Optimization omit
 //< free-upvalues
+//> Optimization omit
+      FREE_ARRAY(Value, closure->captures, closure->captureCount);
+//< Optimization omit
       FREE(ObjClosure, object);
       break;
     }
@@ -203,6 +292,14 @@ static void freeObject(Obj* object) {
 //> Calls and Functions free-function
     case OBJ_FUNCTION: {
       ObjFunction* function = (ObjFunction*)object;
+//> Optimization omit
+#ifdef BASELINE_JIT
+      jitFree(function);
+#endif
+#ifdef TRACE_JIT
+      freeTraces(&function->chunk);
+#endif
+//< Optimization omit
       freeChunk(&function->chunk);
       FREE(ObjFunction, object);
       break;
@@ -212,8 +309,17 @@ static void freeObject(Obj* object) {
 //> Classes and Instances free-instance
     case OBJ_INSTANCE: {
       ObjInstance* instance = (ObjInstance*)object;
+/* Classes and Instances free-instance < Optimization omit
       freeTable(&instance->fields);
       FREE(ObjInstance, object);
+*/
+//> Optimization omit
+      if (instance->fields != instance->inlineFields) {
+        FREE_ARRAY(Value, instance->fields, instance->fieldCapacity);
+      }
+      reallocate(object, sizeof(ObjInstance) +
+          sizeof(Value) * instance->inlineFieldCount, 0);
+//< Optimization omit
       break;
     }
 
@@ -224,6 +330,16 @@ static void freeObject(Obj* object) {
       break;
 
 //< Calls and Functions free-native
+//> Optimization omit
+    case OBJ_SHAPE: {
+      ObjShape* shape = (ObjShape*)object;
+      freeTable(&shape->slots);
+      freeTable(&shape->transitions);
+      FREE(ObjShape, object);
+      break;
+    }
+
+//< Optimization omit
     case OBJ_STRING: {
       ObjString* string = (ObjString*)object;
       FREE_ARRAY(char, string->chars, string->length + 1);
@@ -241,13 +357,60 @@ static void freeObject(Obj* object) {
 //< Strings free-object
 //> Garbage Collection mark-roots
 static void markRoots() {
+/* Garbage Collection mark-roots < Optimization omit
   for (Value* slot = vm.stack; slot < vm.stackTop; slot++) {
     markValue(*slot);
   }
+*/
+//> Optimization omit
+  // Each segment of the stack below the top one is in use up to where the
+  // callee of the call moved out of it was.
+  StackSegment* segment = vm.stackSegment;
+  Value* top = vm.stackTop;
+  for (;;) {
+    for (Value* slot = segment->values; slot < top; slot++) {
+      markValue(*slot);
+    }
+
+    if (segment->previous == NULL) break;
+    top = segment->callerTop;
+    segment = segment->previous;
+  }
+#ifdef REGISTER_VM
+  // A register frame's GC roots include every register, even dead ones
+  // holding stale values until they are written again. A frame below the
+  // top can have registers past the top of its segment's stack that this
+  // collection won't keep alive, so clear them before the frame sees them
+  // again.
+  segment = vm.stackSegment;
+  top = vm.stackTop;
+  for (int i = vm.frameCount - 1; i >= 0; i--) {
+    CallFrame* frame = FRAME_AT(i);
+    RegisterChunk* registers = frame->closure->function->chunk.registers;
+    if (registers != NULL) {
+      Value* frameTop = frame->slots + registers->registerCount;
+      for (Value* slot = top; slot < frameTop; slot++) {
+        *slot = NIL_VAL;
+      }
+    }
+
+    // The frames below the first one in a segment are in the one before.
+    if (frame->slots == segment->values && segment->previous != NULL) {
+      top = segment->callerTop;
+      segment = segment->previous;
+    }
+  }
+#endif
+//< Optimization omit
 //> mark-closures
 
   for (int i = 0; i < vm.frameCount; i++) {
+/* Garbage Collection mark-closures < Optimization omit
     markObject((Obj*)vm.frames[i].closure);
+*/
+//> Optimization omit
+    markObject((Obj*)FRAME_AT(i)->closure);
+//< Optimization omit
   }
 //< mark-closures
 //> mark-open-upvalues
@@ -258,9 +421,30 @@ static void markRoots() {
     markObject((Obj*)upvalue);
   }
 //< mark-open-upvalues
+//> Optimization omit
+  for (StackSegment* segment = vm.stackSegment->previous;
+       segment != NULL;
+       segment = segment->previous) {
+    for (ObjUpvalue* upvalue = segment->openUpvalues;
+         upvalue != NULL;
+         upvalue = upvalue->next) {
+      markObject((Obj*)upvalue);
+    }
+  }
+#ifdef TRACE_JIT
+  markTraceRecording();
+#endif
+//< Optimization omit
 //> mark-globals
 
+/* Garbage Collection mark-globals < Optimization omit
   markTable(&vm.globals);
+*/
+//> Optimization omit
+  markTable(&vm.globalSlots);
+  markArray(&vm.globalNames);
+  markArray(&vm.globalValues);
+//< Optimization omit
 //< mark-globals
 //> call-mark-compiler-roots
   markCompilerRoots();
@@ -268,6 +452,9 @@ static void markRoots() {
 //> Methods and Initializers mark-init-string
   markObject((Obj*)vm.initString);
 //< Methods and Initializers mark-init-string
+//> Optimization omit
+  markArray(&vm.selectors);
+//< Optimization omit
 }
 //< Garbage Collection mark-roots
 //> Garbage Collection trace-references
@@ -46,31 +46,81 @@ ObjBoundMethod* newBoundMethod(Value receiver, ObjClosure* method) {
   return bound;
 }
 //< Methods and Initializers new-bound-method
+//> Optimization omit
+static ObjShape* newShape(ObjClass* klass) {
+  ObjShape* shape = ALLOCATE_OBJ(ObjShape, OBJ_SHAPE);
+  shape->klass = klass;
+  shape->fieldCount = 0;
+  initTable(&shape->slots);
+  initTable(&shape->transitions);
+  return shape;
+}
+//< Optimization omit
 //> Classes and Instances new-class
 ObjClass* newClass(ObjString* name) {
   ObjClass* klass = ALLOCATE_OBJ(ObjClass, OBJ_CLASS);
   klass->name = name; // [klass]
 //> Methods and Initializers init-methods
+/* Methods and Initializers init-methods < Optimization omit
   initTable(&klass->methods);
+*/
+//> Optimization omit
+  klass->methods = NULL;
+  klass->methodCapacity = 0;
+//< Optimization omit
 //< Methods and Initializers init-methods
+//> Optimization omit
+  klass->hasShadowingField = false;
+  klass->emptyShape = NULL;
+  klass->initializer = NULL;
+  klass->instanceFieldCount = 0;
+  push(OBJ_VAL(klass));
+  klass->emptyShape = newShape(klass);
+  pop();
+//< Optimization omit
   return klass;
 }
 //< Classes and Instances new-class
 //> Closures new-closure
 ObjClosure* newClosure(ObjFunction* function) {
 //> allocate-upvalue-array
+/* Closures allocate-upvalue-array < Optimization omit
   ObjUpvalue** upvalues = ALLOCATE(ObjUpvalue*, function->upvalueCount);
+*/
+//> Optimization omit
+  // A closure that doesn't escape keeps its upvalues right after the
+  // pointers to them.
+  ObjUpvalue** upvalues = (ObjUpvalue**)reallocate(NULL, 0,
+      upvalueArraySize(function->upvalueCount, !function->escapes));
+//< Optimization omit
   for (int i = 0; i < function->upvalueCount; i++) {
     upvalues[i] = NULL;
   }
 
 //< allocate-upvalue-array
+//> Optimization omit
+  Value* captures = ALLOCATE(Value, function->captureCount);
+  for (int i = 0; i < function->captureCount; i++) {
+    captures[i] = NIL_VAL;
+  }
+
+  ObjUpvalue* stackUpvalues = NULL;
+  if (!function->escapes && function->upvalueCount > 0) {
+    stackUpvalues = (ObjUpvalue*)(upvalues + function->upvalueCount);
+  }
+
+//< Optimization omit
   ObjClosure* closure = ALLOCATE_OBJ(ObjClosure, OBJ_CLOSURE);
   closure->function = function;
 //> init-upvalue-fields
   closure->upvalues = upvalues;
   closure->upvalueCount = function->upvalueCount;
 //< init-upvalue-fields
+//> Optimization omit
+  closure->captures = captures;
+  closure->captureCount = function->captureCount;
+  closure->stackUpvalues = stackUpvalues;
+//< Optimization omit
   return closure;
 }
 //< Closures new-closure
@@ -84,24 +134,167 @@ ObjFunction* newFunction() {
 //< Closures init-upvalue-count
   function->name = NULL;
   initChunk(&function->chunk);
+//> Optimization omit
+  function->captureCount = 0;
+  function->escapes = true;
+  function->accessor = ACCESSOR_NONE;
+  function->accessorField = NULL;
+  function->accessorCache = PROPERTY_UNCACHED;
+  function->maxSlots = 0;
+  function->callCount = 0;
+#ifdef BASELINE_JIT
+  function->jitCode = NULL;
+#endif
+#ifdef AOT_RUNTIME
+  function->aotCode = NULL;
+#endif
+//< Optimization omit
   return function;
 }
 //< Calls and Functions new-function
 //> Classes and Instances new-instance
 ObjInstance* newInstance(ObjClass* klass) {
+/* Classes and Instances new-instance < Optimization omit
   ObjInstance* instance = ALLOCATE_OBJ(ObjInstance, OBJ_INSTANCE);
+*/
+//> Optimization omit
+  int fieldCount = klass->instanceFieldCount;
+  ObjInstance* instance = (ObjInstance*)allocateObject(
+      sizeof(ObjInstance) + sizeof(Value) * fieldCount, OBJ_INSTANCE);
+//< Optimization omit
   instance->klass = klass;
+/* Classes and Instances new-instance < Optimization omit
   initTable(&instance->fields);
+*/
+//> Optimization omit
+  instance->shape = klass->emptyShape;
+  instance->fields = instance->inlineFields;
+  instance->fieldCapacity = fieldCount;
+  instance->inlineFieldCount = fieldCount;
+//< Optimization omit
   return instance;
 }
 //< Classes and Instances new-instance
 //> Calls and Functions new-native
+/* Calls and Functions new-native < Optimization omit
 ObjNative* newNative(NativeFn function) {
+*/
+//> Optimization omit
+ObjNative* newNative(NativeFn function, int arity, void* context,
+                     int flags) {
+//< Optimization omit
   ObjNative* native = ALLOCATE_OBJ(ObjNative, OBJ_NATIVE);
   native->function = function;
+//> Optimization omit
+  native->arity = arity;
+  native->context = context;
+  native->flags = flags;
+//< Optimization omit
   return native;
 }
 //< Calls and Functions new-native
+//> Optimization omit
+// Returns the slot instances of [shape] keep the field [name] in, or -1 if
+// they don't have it.
+int shapeSlot(ObjShape* shape, ObjString* name) {
+  Value slot;
+  if (!tableGet(&shape->slots, name, &slot)) return -1;
+  return (int)AS_NUMBER(slot);
+}
+
+// Returns the shape an instance of [shape] moves to when it gets the field
+// [name], which it doesn't have yet.
+ObjShape* shapeTransition(ObjShape* shape, ObjString* name) {
+  Value next;
+  if (tableGet(&shape->transitions, name, &next)) return AS_SHAPE(next);
+
+  ObjShape* added = newShape(shape->klass);
+  push(OBJ_VAL(added));
+  added->fieldCount = shape->fieldCount + 1;
+  tableAddAll(&shape->slots, &added->slots);
+  tableSet(&added->slots, name, NUMBER_VAL(shape->fieldCount));
+  tableSet(&shape->transitions, name, OBJ_VAL(added));
+  pop();
+
+  // Methods are only defined while a class is being declared, before it
+  // has any instances, so the first time a field shadowing one is added is
+  // always when its shape is made.
+  if (findMethod(shape->klass, name) != NULL) {
+    shape->klass->hasShadowingField = true;
+    vm.methodEpoch++;
+  }
+  return added;
+}
+
+// Stores [value] in a new field of [instance], moving it to [shape], which
+// has the instance's fields and that one.
+void addField(ObjInstance* instance, ObjShape* shape, Value value) {
+  int slot = instance->shape->fieldCount;
+  if (instance->fieldCapacity < slot + 1) {
+    int oldCapacity = instance->fieldCapacity;
+    int capacity = GROW_CAPACITY(oldCapacity);
+    if (instance->fields == instance->inlineFields) {
+      Value* fields = ALLOCATE(Value, capacity);
+      memcpy(fields, instance->fields, sizeof(Value) * oldCapacity);
+      instance->fields = fields;
+    } else {
+      instance->fields = GROW_ARRAY(Value, instance->fields,
+          oldCapacity, capacity);
+    }
+    instance->fieldCapacity = capacity;
+  }
+
+  instance->fields[slot] = value;
+  instance->shape = shape;
+
+  ObjClass* klass = instance->klass;
+  if (shape->fieldCount > klass->instanceFieldCount) {
+    klass->instanceFieldCount = shape->fieldCount;
+  }
+}
+
+// Returns the selector of the method name [name], giving it the next one if
+// it doesn't have one yet. The compiler does this for each method it
+// declares, so by the time a class is defined its methods' selectors all
+// exist. The name is kept alive from then on so that it keeps its selector.
+int selectorOf(ObjString* name) {
+  if (name->selector == -1) {
+    push(OBJ_VAL(name));
+    writeValueArray(&vm.selectors, OBJ_VAL(name));
+    pop();
+    name->selector = vm.selectors.count - 1;
+  }
+  return name->selector;
+}
+
+// Makes [method] the method [name] of [klass], replacing any it had.
+void setMethod(ObjClass* klass, ObjString* name, ObjClosure* method) {
+  int selector = selectorOf(name);
+  if (klass->methodCapacity <= selector) {
+    // Make room for every selector so far, so that a class's methods
+    // usually need only the one array.
+    int oldCapacity = klass->methodCapacity;
+    int capacity = vm.selectors.count;
+    klass->methods = GROW_ARRAY(ObjClosure*, klass->methods,
+        oldCapacity, capacity);
+    klass->methodCapacity = capacity;
+    for (int i = oldCapacity; i < capacity; i++) klass->methods[i] = NULL;
+  }
+
+  klass->methods[selector] = method;
+  if (name == vm.initString) klass->initializer = method;
+}
+
+// Copies the methods of [superclass] down into [subclass].
+void inheritMethods(ObjClass* superclass, ObjClass* subclass) {
+  for (int i = 0; i < superclass->methodCapacity; i++) {
+    ObjClosure* method = superclass->methods[i];
+    if (method != NULL) {
+      setMethod(subclass, AS_STRING(vm.selectors.values[i]), method);
+    }
+  }
+}
+//< Optimization omit
 
 /* Strings allocate-string < Hash Tables allocate-string
 static ObjString* allocateString(char* chars, int length) {
@@ -117,6 +310,9 @@ static ObjString* allocateString(char* chars, int length,
 //> Hash Tables allocate-store-hash
   string->hash = hash;
 //< Hash Tables allocate-store-hash
+//> Optimization omit
+  string->selector = -1;
+//< Optimization omit
 
 //> Garbage Collection push-string
   push(OBJ_VAL(string));
@@ -244,6 +440,11 @@ void printObject(Value value) {
     case OBJ_STRING:
       printf("%s", AS_CSTRING(value));
       break;
+//> Optimization omit
+    case OBJ_SHAPE:
+      printf("shape");
+      break;
+//< Optimization omit
 //> Closures print-upvalue
     case OBJ_UPVALUE:
       printf("upvalue");
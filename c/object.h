@@ -34,6 +34,9 @@
 //> Calls and Functions is-native
 #define IS_NATIVE(value)        isObjType(value, OBJ_NATIVE)
 //< Calls and Functions is-native
+//> Optimization omit
+#define IS_SHAPE(value)         isObjType(value, OBJ_SHAPE)
+//< Optimization omit
 #define IS_STRING(value)        isObjType(value, OBJ_STRING)
 //< is-string
 //> as-string
@@ -54,8 +57,16 @@
 #define AS_INSTANCE(value)      ((ObjInstance*)AS_OBJ(value))
 //< Classes and Instances as-instance
 //> Calls and Functions as-native
+/* Calls and Functions as-native < Optimization omit
 #define AS_NATIVE(value)        (((ObjNative*)AS_OBJ(value))->function)
+*/
+//> Optimization omit
+#define AS_NATIVE(value)        ((ObjNative*)AS_OBJ(value))
+//< Optimization omit
 //< Calls and Functions as-native
+//> Optimization omit
+#define AS_SHAPE(value)         ((ObjShape*)AS_OBJ(value))
+//< Optimization omit
 #define AS_STRING(value)        ((ObjString*)AS_OBJ(value))
 #define AS_CSTRING(value)       (((ObjString*)AS_OBJ(value))->chars)
 //< as-string
@@ -80,6 +91,9 @@ typedef enum {
 //> Calls and Functions obj-type-native
   OBJ_NATIVE,
 //< Calls and Functions obj-type-native
+//> Optimization omit
+  OBJ_SHAPE,
+//< Optimization omit
   OBJ_STRING,
 //> Closures obj-type-upvalue
   OBJ_UPVALUE
@@ -97,6 +111,16 @@ struct sObj {
 //< next-field
 };
 //> Calls and Functions obj-function
+//> Optimization omit
+
+// What a method does if its whole body gets or sets one field of this.
+typedef enum {
+  ACCESSOR_NONE,
+  ACCESSOR_GET,        // return this.field;
+  ACCESSOR_SET,        // this.field = value;
+  ACCESSOR_SET_RETURN, // return this.field = value;
+} AccessorKind;
+//< Optimization omit
 
 typedef struct {
   Obj obj;
@@ -106,15 +130,76 @@ typedef struct {
 //< Closures upvalue-count
   Chunk chunk;
   ObjString* name;
+//> Optimization omit
+  // How many variables the function's closures capture by copying their
+  // values rather than through an upvalue. Only variables that are never
+  // assigned after they are initialized are copied.
+  int captureCount;
+  // Whether the function's closures may outlive the frame that creates
+  // them. The compiler clears it for local functions that are only called.
+  bool escapes;
+  // Whether the function is a method that only gets or sets a field, so
+  // call sites can do that instead of calling it. The field's name is
+  // accessorField and accessorCache is the property cache of the
+  // instruction that does it.
+  AccessorKind accessor;
+  ObjString* accessorField;
+  uint8_t accessorCache;
+  // The most values a call to the function has on the stack at once,
+  // counting the callee and its arguments.
+  int maxSlots;
+  // How many times the function has been called.
+  unsigned int callCount;
+#ifdef BASELINE_JIT
+  // The function's machine code, or NULL if it hasn't been compiled.
+  struct sJitCode* jitCode;
+#endif
+#ifdef AOT_RUNTIME
+  // The C function compiled from the function ahead of time. It runs the
+  // frame on top of the call stack until it returns, and returns false if a
+  // runtime error occurs.
+  bool (*aotCode)();
+#endif
+//< Optimization omit
 } ObjFunction;
 //< Calls and Functions obj-function
 //> Calls and Functions obj-native
 
+/* Calls and Functions obj-native < Optimization omit
 typedef Value (*NativeFn)(int argCount, Value* args);
+*/
+//> Optimization omit
+// A native gets its arguments where they are on the stack and the context
+// it was defined with. It stores its result in [result] and returns true,
+// or returns what nativeError() does.
+typedef bool (*NativeFn)(int argCount, Value* args, void* context,
+                         Value* result);
+//< Optimization omit
 
+//> Optimization omit
+// What a native promises not to do, so calls to it can skip the work that
+// guards against it.
+typedef enum {
+  // It never allocates, so the GC doesn't need to see the stack.
+  NATIVE_NO_GC = 1 << 0,
+  // It never fails, so there's no error to report a line for. A pure native
+  // has to be NATIVE_NO_GC too.
+  NATIVE_PURE = 1 << 1,
+} NativeFlags;
+
+// Any number of arguments, for a native's arity.
+#define NATIVE_VARIADIC -1
+
+//< Optimization omit
 typedef struct {
   Obj obj;
   NativeFn function;
+//> Optimization omit
+  // How many arguments calls have to pass, checked before the native runs.
+  int arity;
+  void* context;
+  int flags;
+//< Optimization omit
 } ObjNative;
 //< Calls and Functions obj-native
 //> obj-string
@@ -126,6 +211,11 @@ struct sObjString {
 //> Hash Tables obj-string-hash
   uint32_t hash;
 //< Hash Tables obj-string-hash
+//> Optimization omit
+  // The selector of a method with this name, or -1 if no method has been
+  // given the name yet.
+  int selector;
+//< Optimization omit
 };
 //< obj-string
 //> Closures obj-upvalue
@@ -141,14 +231,35 @@ typedef struct sUpvalue {
 } ObjUpvalue;
 //< Closures obj-upvalue
 //> Closures obj-closure
+/* Closures obj-closure < Optimization omit
 typedef struct {
+*/
+//> Optimization omit
+typedef struct sObjClosure {
+//< Optimization omit
   Obj obj;
   ObjFunction* function;
 //> upvalue-fields
   ObjUpvalue** upvalues;
   int upvalueCount;
 //< upvalue-fields
+//> Optimization omit
+  Value* captures;
+  int captureCount;
+  // The upvalues of a closure that doesn't escape, which point straight at
+  // the stack slots they capture. They aren't objects of their own and are
+  // never closed. NULL if the closure may escape.
+  ObjUpvalue* stackUpvalues;
+//< Optimization omit
 } ObjClosure;
+//> Optimization omit
+
+// The size of a closure's array of [count] upvalue pointers, followed by
+// the upvalues themselves if they are kept [onStack].
+static inline size_t upvalueArraySize(int count, bool onStack) {
+  return (sizeof(ObjUpvalue*) + (onStack ? sizeof(ObjUpvalue) : 0)) * count;
+}
+//< Optimization omit
 //< Closures obj-closure
 //> Classes and Instances obj-class
 
@@ -156,16 +267,68 @@ typedef struct sObjClass {
   Obj obj;
   ObjString* name;
 //> Methods and Initializers class-methods
+/* Methods and Initializers class-methods < Optimization omit
   Table methods;
+*/
+//> Optimization omit
+  // The class's methods, indexed by selector. Selectors past the end and
+  // NULL entries are methods the class doesn't have.
+  struct sObjClosure** methods;
+  int methodCapacity;
+//< Optimization omit
 //< Methods and Initializers class-methods
+//> Optimization omit
+  // Whether an instance of the class has ever had a field with the same
+  // name as one of its methods. Until one does, invoking a method doesn't
+  // need to look in the instance's fields first.
+  bool hasShadowingField;
+  // The shape of the class's instances before they have any fields.
+  struct sObjShape* emptyShape;
+  // The class's init() method, or NULL if it doesn't have one.
+  struct sObjClosure* initializer;
+  // The most fields an instance of the class has had. New instances have
+  // room for that many in the same allocation.
+  int instanceFieldCount;
+//< Optimization omit
 } ObjClass;
 //< Classes and Instances obj-class
+//> Optimization omit
+
+// The layout of an instance's fields. Each class has a tree of shapes
+// rooted at its empty shape, and a shape's transitions lead to the shapes
+// an instance moves to when it gets one more field. Instances that got the
+// same fields in the same order share a shape, and the shape says which
+// slot of their field arrays each field is in.
+typedef struct sObjShape {
+  Obj obj;
+  ObjClass* klass;
+  // How many fields the shape has, which is also the slot the next field
+  // added goes in.
+  int fieldCount;
+  // Maps each field's name to its slot.
+  Table slots;
+  // Maps the name of a field to the shape adding it leads to.
+  Table transitions;
+} ObjShape;
+//< Optimization omit
 //> Classes and Instances obj-instance
 
 typedef struct {
   Obj obj;
   ObjClass* klass;
+/* Classes and Instances obj-instance < Optimization omit
   Table fields; // [fields]
+*/
+//> Optimization omit
+  ObjShape* shape;
+  // The field values, in the slots the shape puts them in.
+  Value* fields;
+  int fieldCapacity;
+  // The fields are in inlineFields until there are more than
+  // inlineFieldCount of them.
+  int inlineFieldCount;
+  Value inlineFields[];
+//< Optimization omit
 } ObjInstance;
 //< Classes and Instances obj-instance
 
@@ -193,8 +356,22 @@ ObjFunction* newFunction();
 ObjInstance* newInstance(ObjClass* klass);
 //< Classes and Instances new-instance-h
 //> Calls and Functions new-native-h
+/* Calls and Functions new-native-h < Optimization omit
 ObjNative* newNative(NativeFn function);
+*/
+//> Optimization omit
+ObjNative* newNative(NativeFn function, int arity, void* context,
+                     int flags);
+//< Optimization omit
 //< Calls and Functions new-native-h
+//> Optimization omit
+int shapeSlot(ObjShape* shape, ObjString* name);
+ObjShape* shapeTransition(ObjShape* shape, ObjString* name);
+void addField(ObjInstance* instance, ObjShape* shape, Value value);
+int selectorOf(ObjString* name);
+void setMethod(ObjClass* klass, ObjString* name, ObjClosure* method);
+void inheritMethods(ObjClass* superclass, ObjClass* subclass);
+//< Optimization omit
 //> take-string-h
 ObjString* takeString(char* chars, int length);
 //< take-string-h
@@ -214,4 +391,14 @@ static inline bool isObjType(Value value, ObjType type) {
 }
 
 //< is-obj-type
+//> Optimization omit
+// Returns the method [name] of [klass], or NULL if it doesn't have one.
+static inline ObjClosure* findMethod(ObjClass* klass, ObjString* name) {
+  if (name->selector < 0 || name->selector >= klass->methodCapacity) {
+    return NULL;
+  }
+  return klass->methods[name->selector];
+}
+
+//< Optimization omit
 #endif
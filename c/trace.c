@@ -0,0 +1,1311 @@
+//> Optimization omit
+#include <stdlib.h>
+
+#include "assembler.h"
+#include "common.h"
+#include "jit.h"
+#include "memory.h"
+#include "trace.h"
+
+#ifdef TRACE_JIT
+// A tracing JIT for hot loops. When a loop run by the interpreter gets hot,
+// the recorder runs one more iteration of it an instruction at a time,
+// noting the path it takes: which way each branch went, whether arithmetic
+// saw numbers, which closure each call reached. Calls to closures are
+// followed into the callee, so the trace covers everything the iteration
+// ran. If the iteration makes it back to the loop header, the trace is
+// compiled into straight-line machine code that jumps back to its own start.
+//
+// Everything the recording observed becomes a guard. When a guard fails,
+// the trace exits to the interpreter at the start of the instruction whose
+// assumption no longer holds, and that instruction runs again as usual.
+// Values live on the VM stack and inlined calls push real CallFrames, as in
+// the baseline JIT, so an exit only has to tell the interpreter where the
+// stack ends and which instruction is next for the frames to be complete.
+//
+// Since guards pin down the types flowing through the trace, most checks
+// are only needed once. The compiler tracks which stack slots are known to
+// hold numbers, and skips checking them again. Locals that hold numbers at
+// the header and still do when the trace jumps back to it are checked once
+// on entry, and not again inside the loop, so the loop variables stay raw
+// doubles for as long as the trace runs.
+
+// Traces longer than this, or that inline calls deeper than this, are
+// abandoned.
+#define MAX_TRACE_LENGTH 1000
+#define MAX_TRACE_DEPTH 16
+
+// A loop whose trace fails this many times runs in the interpreter for good.
+#define MAX_TRACE_FAILURES 4
+
+// A trace that exits this many times in a row before getting around the
+// loop once is thrown away.
+#define MAX_FRUITLESS_RUNS 8
+
+// What the recorder saw an instruction do.
+typedef enum {
+  STEP_NUMBERS = 1 << 0, // The operands were numbers.
+  STEP_TAKEN = 1 << 1,   // The branch was taken.
+  STEP_FIELD = 1 << 2    // The property was a field of an instance.
+} StepFlags;
+
+typedef struct {
+  ObjFunction* function;
+  uint8_t* ip;
+  // How many inlined calls deep the instruction is.
+  int depth;
+  // Where its frame's slots and the top of the stack were before it ran,
+  // counted from the loop's frame's slots.
+  int base;
+  int height;
+  uint8_t flags;
+  // The callee of a call, the receiver's shape for a field access or an
+  // invoke, or the superclass for a super invoke.
+  Obj* object;
+  // The closure a call ran, if any.
+  ObjClosure* callee;
+} TraceStep;
+
+struct sTrace {
+  JitFunction enter;
+  void* entry;
+  // How many times the trace has jumped back to its start.
+  int iterations;
+  int fruitlessRuns;
+  // The closures, shapes and classes its guards compare against, which must
+  // stay
+  // alive as long as the trace does.
+  Obj** objects;
+  int objectCount;
+};
+
+typedef struct {
+  Loop* loop;
+  // The index of the loop's frame in the call stack.
+  int frameIndex;
+  Value* slots;
+
+  TraceStep* steps;
+  int count;
+  int capacity;
+
+  // Which of the loop frame's slots held numbers when recording started.
+  int entryHeight;
+  bool* entryNumbers;
+} Recorder;
+
+// The recording in progress, whose objects the GC has to keep alive.
+static Recorder* recorder = NULL;
+
+typedef enum {
+  RECORD_CONTINUE,
+  RECORD_CLOSED,
+  RECORD_ABORT,
+  RECORD_ERROR
+} RecordResult;
+
+static bool isFalsey(Value value) {
+  return IS_NIL(value) || (IS_BOOL(value) && !AS_BOOL(value));
+}
+
+static Value peek(int distance) {
+  return vm.stackTop[-1 - distance];
+}
+
+// Notes in [step] whether [receiver] is an instance that already has the
+// field [name], along with its shape.
+static void recordField(TraceStep* step, Value receiver, ObjString* name) {
+  if (IS_INSTANCE(receiver) &&
+      shapeSlot(AS_INSTANCE(receiver)->shape, name) != -1) {
+    step->flags |= STEP_FIELD;
+    step->object = (Obj*)AS_INSTANCE(receiver)->shape;
+  }
+}
+
+static OpCode genericOp(OpCode instruction) {
+  switch (instruction) {
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+      return OP_ADD;
+    default:
+      return instruction;
+  }
+}
+
+// Runs the instruction at the frame's ip as run() would, noting what it saw
+// in [step]. Returns RECORD_ABORT without running it if the instruction is
+// one the trace can't follow.
+static RecordResult recordStep(Recorder* rec, CallFrame* frame,
+                               TraceStep* step) {
+  Value* constants = frame->closure->function->chunk.constants.values;
+
+#define READ_BYTE() (*frame->ip++)
+#define READ_SHORT() \
+    (frame->ip += 2, (uint16_t)((frame->ip[-2] << 8) | frame->ip[-1]))
+#define READ_CONSTANT() (constants[READ_BYTE()])
+#define READ_STRING() AS_STRING(READ_CONSTANT())
+#define CHECK(success) \
+    do { if (!(success)) return RECORD_ERROR; } while (false)
+
+  OpCode instruction = (OpCode)READ_BYTE();
+  switch (instruction) {
+    case OP_CONSTANT: push(READ_CONSTANT()); break;
+    case OP_NIL: push(NIL_VAL); break;
+    case OP_TRUE: push(BOOL_VAL(true)); break;
+    case OP_FALSE: push(BOOL_VAL(false)); break;
+    case OP_POP: pop(); break;
+    case OP_GET_LOCAL: push(frame->slots[READ_BYTE()]); break;
+    case OP_SET_LOCAL: frame->slots[READ_BYTE()] = peek(0); break;
+    case OP_GET_GLOBAL: CHECK(jitGetGlobal(READ_SHORT())); break;
+    case OP_DEFINE_GLOBAL: jitDefineGlobal(READ_SHORT()); break;
+    case OP_SET_GLOBAL: CHECK(jitSetGlobal(READ_SHORT())); break;
+
+    case OP_GET_UPVALUE: {
+      uint8_t slot = READ_BYTE();
+      push(*frame->closure->upvalues[slot]->location);
+      break;
+    }
+
+    case OP_SET_UPVALUE: {
+      uint8_t slot = READ_BYTE();
+      *frame->closure->upvalues[slot]->location = peek(0);
+      break;
+    }
+
+    case OP_GET_CAPTURE: push(frame->closure->captures[READ_BYTE()]); break;
+
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_GET_LOCAL_FIELD:
+      push(frame->slots[READ_BYTE()]);
+      // Fallthrough.
+    case OP_GET_PROPERTY:
+    case OP_GET_FIELD: {
+      ObjString* name = READ_STRING();
+      frame->ip++; // The property cache.
+      recordField(step, peek(0), name);
+      CHECK(jitGetProperty(name));
+      break;
+    }
+
+    case OP_SET_PROPERTY: {
+      ObjString* name = READ_STRING();
+      frame->ip++;
+      recordField(step, peek(1), name);
+      CHECK(jitSetProperty(name));
+      break;
+    }
+    case OP_GET_SUPER: CHECK(jitGetSuper(READ_STRING())); break;
+
+    case OP_EQUAL: {
+      Value b = pop();
+      Value a = pop();
+      push(BOOL_VAL(valuesEqual(a, b)));
+      break;
+    }
+
+    case OP_GREATER:
+    case OP_LESS:
+    case OP_ADD:
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+      if (IS_NUMBER(peek(0)) && IS_NUMBER(peek(1))) {
+        step->flags |= STEP_NUMBERS;
+      }
+      CHECK(jitBinaryOp(genericOp(instruction)));
+      break;
+
+    case OP_SUBTRACT_CONSTANT:
+      push(READ_CONSTANT());
+      if (IS_NUMBER(peek(0)) && IS_NUMBER(peek(1))) {
+        step->flags |= STEP_NUMBERS;
+      }
+      CHECK(jitBinaryOp(OP_SUBTRACT));
+      break;
+
+    case OP_NOT: push(BOOL_VAL(isFalsey(pop()))); break;
+
+    case OP_NEGATE:
+      if (IS_NUMBER(peek(0))) step->flags |= STEP_NUMBERS;
+      CHECK(jitNegate());
+      break;
+
+    case OP_PRINT: jitPrint(); break;
+
+    case OP_JUMP: {
+      uint16_t offset = READ_SHORT();
+      frame->ip += offset;
+      break;
+    }
+
+    case OP_JUMP_IF_FALSE: {
+      uint16_t offset = READ_SHORT();
+      if (isFalsey(peek(0))) {
+        step->flags |= STEP_TAKEN;
+        frame->ip += offset;
+      }
+      break;
+    }
+
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER: {
+      uint16_t offset = READ_SHORT();
+      OpCode comparison = instruction == OP_JUMP_IF_NOT_LESS
+          ? OP_LESS : OP_GREATER;
+      // Only reports the error.
+      if (!IS_NUMBER(peek(0)) || !IS_NUMBER(peek(1))) {
+        CHECK(jitBinaryOp(comparison));
+      }
+
+      step->flags |= STEP_NUMBERS;
+      double b = AS_NUMBER(pop());
+      double a = AS_NUMBER(pop());
+      if (comparison == OP_LESS ? !(a < b) : !(a > b)) {
+        step->flags |= STEP_TAKEN;
+        push(BOOL_VAL(false));
+        frame->ip += offset;
+      }
+      break;
+    }
+
+    case OP_JUMP_IF_NOT_EQUAL: {
+      uint16_t offset = READ_SHORT();
+      Value b = pop();
+      Value a = pop();
+      if (!valuesEqual(a, b)) {
+        step->flags |= STEP_TAKEN;
+        push(BOOL_VAL(false));
+        frame->ip += offset;
+      }
+      break;
+    }
+
+    case OP_LOOP: {
+      uint16_t offset = READ_SHORT();
+      frame->ip++; // The loop's index.
+      uint8_t* target = frame->ip - offset;
+
+      // Inner loops in the loop's own body are unrolled into the trace, but
+      // a callee's loops end the recording.
+      if (step->depth > 0) return RECORD_ABORT;
+      frame->ip = target;
+      if (target == frame->closure->function->chunk.code +
+                    rec->loop->header) {
+        return RECORD_CLOSED;
+      }
+      break;
+    }
+
+    case OP_CALL:
+    case OP_TAIL_CALL:
+    case OP_CALL_GLOBAL: {
+      int argCount = READ_BYTE();
+      // The trace guards on the callee itself, so it has no use for the
+      // call site's cache.
+      if (instruction == OP_CALL_GLOBAL) frame->ip++;
+      Value callee = peek(argCount);
+      if (!IS_OBJ(callee)) return RECORD_ABORT;
+
+      step->object = AS_OBJ(callee);
+      switch (OBJ_TYPE(callee)) {
+        case OBJ_CLOSURE:
+          step->callee = AS_CLOSURE(callee);
+          break;
+
+        case OBJ_BOUND_METHOD:
+          step->callee = AS_BOUND_METHOD(callee)->method;
+          break;
+
+        case OBJ_CLASS:
+          step->callee = AS_CLASS(callee)->initializer;
+          break;
+
+        case OBJ_NATIVE:
+          break;
+
+        default:
+          return RECORD_ABORT;
+      }
+
+      if (step->callee != NULL && step->depth + 1 == MAX_TRACE_DEPTH) {
+        return RECORD_ABORT;
+      }
+      CHECK(traceCall(argCount));
+      break;
+    }
+
+    case OP_INVOKE: {
+      ObjString* name = READ_STRING();
+      int argCount = READ_BYTE();
+      frame->ip++; // Traces guard the method themselves.
+      Value receiver = peek(argCount);
+      if (!IS_INSTANCE(receiver) ||
+          shapeSlot(AS_INSTANCE(receiver)->shape, name) != -1 ||
+          step->depth + 1 == MAX_TRACE_DEPTH) {
+        return RECORD_ABORT;
+      }
+
+      ObjClosure* method = findMethod(AS_INSTANCE(receiver)->klass, name);
+      if (method == NULL) return RECORD_ABORT;
+
+      step->object = (Obj*)AS_INSTANCE(receiver)->shape;
+      step->callee = method;
+      CHECK(traceInvoke(name, argCount));
+      break;
+    }
+
+    case OP_SUPER_INVOKE: {
+      ObjString* name = READ_STRING();
+      int argCount = READ_BYTE();
+      frame->ip++;
+      ObjClass* superclass = AS_CLASS(peek(0));
+      ObjClosure* method = findMethod(superclass, name);
+      if (method == NULL || step->depth + 1 == MAX_TRACE_DEPTH) {
+        return RECORD_ABORT;
+      }
+
+      step->object = (Obj*)superclass;
+      step->callee = method;
+      CHECK(traceSuperInvoke(name, argCount));
+      break;
+    }
+
+    case OP_CLOSURE: {
+      ObjFunction* function = AS_FUNCTION(READ_CONSTANT());
+      jitClosure(function, frame->ip);
+      frame->ip += (function->upvalueCount + function->captureCount) * 2;
+      break;
+    }
+
+    case OP_CLOSE_UPVALUE: jitCloseUpvalue(); break;
+
+    case OP_RETURN:
+      // Returning from the loop's own frame leaves the loop for good.
+      if (step->depth == 0) return RECORD_ABORT;
+      jitReturn();
+      break;
+
+    case OP_CLASS: jitClass(READ_STRING()); break;
+    case OP_INHERIT: CHECK(jitInherit()); break;
+    case OP_METHOD: jitMethod(READ_STRING()); break;
+
+    default:
+      return RECORD_ABORT;
+  }
+
+  return RECORD_CONTINUE;
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef READ_CONSTANT
+#undef READ_STRING
+#undef CHECK
+}
+
+// Records the next instruction the VM runs.
+static RecordResult recordInstruction(Recorder* rec) {
+  if (rec->count == MAX_TRACE_LENGTH) return RECORD_ABORT;
+
+  if (rec->capacity < rec->count + 1) {
+    int oldCapacity = rec->capacity;
+    rec->capacity = GROW_CAPACITY(oldCapacity);
+    rec->steps = GROW_ARRAY(TraceStep, rec->steps,
+        oldCapacity, rec->capacity);
+  }
+
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  TraceStep* step = &rec->steps[rec->count++];
+  step->function = frame->closure->function;
+  step->ip = frame->ip;
+  step->depth = vm.frameCount - 1 - rec->frameIndex;
+  step->base = (int)(frame->slots - rec->slots);
+  step->height = (int)(vm.stackTop - rec->slots);
+  step->flags = 0;
+  step->object = NULL;
+  step->callee = NULL;
+
+  RecordResult result = recordStep(rec, frame, step);
+  if (result == RECORD_ABORT) {
+    // Leave the instruction for the interpreter to run.
+    frame->ip = step->ip;
+    rec->count--;
+  }
+  return result;
+}
+
+void markTraceRecording() {
+  if (recorder == NULL) return;
+
+  for (int i = 0; i < recorder->count; i++) {
+    markObject(recorder->steps[i].object);
+    markObject((Obj*)recorder->steps[i].callee);
+  }
+}
+
+// A guard's way back to the interpreter, at the instruction at [ip].
+typedef struct {
+  int patch;
+  uint8_t* ip;
+} SideExit;
+
+typedef struct {
+  Assembler as;
+  Recorder* rec;
+  Trace* trace;
+
+  SideExit* exits;
+  int exitCount;
+  int exitCapacity;
+
+  // For each stack slot, counted from the loop frame's slots, whether it is
+  // known to hold a number, and the slot of the local it was copied from,
+  // or -1. Guarding a copy of a local tells us about the local too, as long
+  // as it hasn't been assigned since.
+  int slotCount;
+  bool* numbers;
+  int* sources;
+
+  // The loop frame's locals assumed to hold numbers at the header.
+  bool* stable;
+
+  // Whether closures have captured locals of the frame at each depth, so
+  // returning from it has to close upvalues.
+  bool captures[MAX_TRACE_DEPTH];
+
+  // Where the checks on entry start, and where the loop body after them
+  // starts, for the jump back.
+  int guards;
+  int loopStart;
+} TraceCompiler;
+
+static void addExit(TraceCompiler* tc, int patch, uint8_t* ip) {
+  if (tc->exitCapacity < tc->exitCount + 1) {
+    int oldCapacity = tc->exitCapacity;
+    tc->exitCapacity = GROW_CAPACITY(oldCapacity);
+    tc->exits = GROW_ARRAY(SideExit, tc->exits,
+        oldCapacity, tc->exitCapacity);
+  }
+
+  SideExit* exit = &tc->exits[tc->exitCount++];
+  exit->patch = patch;
+  exit->ip = ip;
+}
+
+// Leaves the trace for the instruction at [ip] if [condition] holds.
+static void emitExit(TraceCompiler* tc, Condition condition, uint8_t* ip) {
+  addExit(tc, emitJump(&tc->as, condition), ip);
+}
+
+// Records what's now in [slot].
+static void setSlot(TraceCompiler* tc, int slot, bool isNumber) {
+  tc->numbers[slot] = isNumber;
+  tc->sources[slot] = -1;
+  for (int i = 0; i < tc->slotCount; i++) {
+    if (tc->sources[i] == slot) tc->sources[i] = -1;
+  }
+}
+
+// Forgets everything known about the slots, when a local may have been
+// assigned through an upvalue.
+static void forgetSlots(TraceCompiler* tc) {
+  for (int i = 0; i < tc->slotCount; i++) {
+    tc->numbers[i] = false;
+    tc->sources[i] = -1;
+  }
+}
+
+// Leaves the trace for [ip] unless [reg], which holds the value in [slot],
+// is a number. Does nothing if it's already known to be.
+static void guardNumber(TraceCompiler* tc, Register reg, int slot,
+                        uint8_t* ip) {
+  if (tc->numbers[slot]) return;
+
+  addExit(tc, emitJumpIfNotNumber(&tc->as, reg), ip);
+  tc->numbers[slot] = true;
+  if (tc->sources[slot] != -1) tc->numbers[tc->sources[slot]] = true;
+}
+
+// Jumps to [patches] unless [reg] holds an object of [type], turning [reg]
+// into a pointer to the object if it does. Clobbers RDX.
+static void emitCheckObject(Assembler* as, Register reg, ObjType type,
+                            int patches[2]) {
+  emitAlu(as, ALU_MOV, RDX, reg);
+  emitMoveImmediate(as, reg == RCX ? RAX : RCX, SIGN_BIT | QNAN);
+  emitAlu(as, ALU_AND, RDX, reg == RCX ? RAX : RCX);
+  emitAlu(as, ALU_CMP, RDX, reg == RCX ? RAX : RCX);
+  patches[0] = emitJump(as, CC_NE);
+
+  emitMoveImmediate(as, RDX, ~(SIGN_BIT | QNAN));
+  emitAlu(as, ALU_AND, reg, RDX);
+  emitAluMemory32(as, IMM_CMP, reg, offsetof(Obj, type), type);
+  patches[1] = emitJump(as, CC_NE);
+}
+
+// Loads the field [name] of the instance in [distance] into RAX, with its
+// address in R9, or jumps to the returned patches if the value isn't an
+// instance of [shape].
+static void emitFindField(Assembler* as, int distance, ObjShape* shape,
+                          ObjString* name, int patches[3]) {
+  emitPeek(as, RAX, distance);
+  emitCheckObject(as, RAX, OBJ_INSTANCE, patches);
+  emitLoad(as, RCX, RAX, offsetof(ObjInstance, shape));
+  emitMoveImmediate(as, RDX, ADDRESS(shape));
+  emitAlu(as, ALU_CMP, RCX, RDX);
+  patches[2] = emitJump(as, CC_NE);
+  emitLoad(as, R9, RAX, offsetof(ObjInstance, fields));
+  emitAluImmediate(as, IMM_ADD, R9,
+                   shapeSlot(shape, name) * (int32_t)sizeof(Value));
+  emitLoad(as, RAX, R9, 0);
+}
+
+static void patchJumps(Assembler* as, int* patches, int count) {
+  for (int i = 0; i < count; i++) patchJump(as, patches[i]);
+}
+
+// Guards that the value in [distance] is an instance of [shape]. The
+// recorder only notes shapes without a field that shadows the method.
+static void guardShape(TraceCompiler* tc, int distance, ObjShape* shape,
+                       uint8_t* ip) {
+  Assembler* as = &tc->as;
+  int patches[2];
+  emitPeek(as, RAX, distance);
+  emitCheckObject(as, RAX, OBJ_INSTANCE, patches);
+  addExit(tc, patches[0], ip);
+  addExit(tc, patches[1], ip);
+  emitLoad(as, RCX, RAX, offsetof(ObjInstance, shape));
+  emitMoveImmediate(as, RDX, ADDRESS(shape));
+  emitAlu(as, ALU_CMP, RCX, RDX);
+  emitExit(tc, CC_NE, ip);
+}
+
+// Leaves the trace for [ip] unless the value in [distance] is [expected].
+static void guardValue(TraceCompiler* tc, int distance, Value expected,
+                       uint8_t* ip) {
+  emitPeek(&tc->as, RAX, distance);
+  emitMoveImmediate(&tc->as, RCX, expected);
+  emitAlu(&tc->as, ALU_CMP, RAX, RCX);
+  emitExit(tc, CC_NE, ip);
+}
+
+// Pushes a frame for [closure] as call() does. The caller's frame resumes
+// at [next] once the callee returns. A call that needs either stack to grow
+// leaves the trace for call() to do it, so the new frame is always next to
+// the caller's in the same segments.
+static void emitEnterFrame(TraceCompiler* tc, TraceStep* step,
+                           ObjClosure* closure, int argCount, uint8_t* next) {
+  Assembler* as = &tc->as;
+  emitLoad32(as, RAX, VM_REG, offsetof(VM, frameCount));
+  emitLoad32(as, RCX, VM_REG, offsetof(VM, maxFrames));
+  emitAlu(as, ALU_CMP, RAX, RCX);
+  emitExit(tc, CC_AE, step->ip);
+  emitAluImmediate(as, IMM_AND, RAX, FRAME_SEGMENT_SIZE - 1);
+  emitExit(tc, CC_E, step->ip);
+
+  int size = closure->function->maxSlots + STACK_HEADROOM;
+  emitAlu(as, ALU_MOV, RAX, STACK_REG);
+  emitAluImmediate(as, IMM_ADD, RAX,
+                   (int32_t)sizeof(Value) * (size - argCount - 1));
+  emitLoad(as, RCX, VM_REG, offsetof(VM, stackLimit));
+  emitAlu(as, ALU_CMP, RAX, RCX);
+  emitExit(tc, CC_A, step->ip);
+
+  emitMoveImmediate(as, RAX, ADDRESS(next));
+  emitStore(as, FRAME_REG, offsetof(CallFrame, ip), RAX);
+  emitAluImmediate(as, IMM_ADD, FRAME_REG, sizeof(CallFrame));
+  emitMoveImmediate(as, RAX, ADDRESS(closure));
+  emitStore(as, FRAME_REG, offsetof(CallFrame, closure), RAX);
+  emitAlu(as, ALU_MOV, SLOTS_REG, STACK_REG);
+  emitAluImmediate(as, IMM_SUB, SLOTS_REG, sizeof(Value) * (argCount + 1));
+  emitStore(as, FRAME_REG, offsetof(CallFrame, slots), SLOTS_REG);
+  emitAluMemory32(as, IMM_ADD, VM_REG, offsetof(VM, frameCount), 1);
+
+  tc->captures[step->depth + 1] = false;
+}
+
+// Returns from an inlined call.
+static void emitLeaveFrame(TraceCompiler* tc, TraceStep* step,
+                           uint8_t* next) {
+  Assembler* as = &tc->as;
+  int closeUpvalues = -1;
+  if (tc->captures[step->depth]) {
+    emitLoad(as, RAX, VM_REG, offsetof(VM, openUpvalues));
+    emitAlu(as, ALU_TEST, RAX, RAX);
+    int noUpvalues = emitJump(as, CC_E);
+    emitLoad(as, RAX, RAX, offsetof(ObjUpvalue, location));
+    emitAlu(as, ALU_CMP, RAX, SLOTS_REG);
+    closeUpvalues = emitJump(as, CC_AE);
+    patchJump(as, noUpvalues);
+  }
+
+  // Replace the callee with the result.
+  emitPeek(as, RAX, 0);
+  emitStore(as, SLOTS_REG, 0, RAX);
+  emitAlu(as, ALU_MOV, STACK_REG, SLOTS_REG);
+  emitAluImmediate(as, IMM_ADD, STACK_REG, sizeof(Value));
+  emitAluMemory32(as, IMM_SUB, VM_REG, offsetof(VM, frameCount), 1);
+
+  if (closeUpvalues != -1) {
+    int done = emitJump(as, CC_ALWAYS);
+    patchJump(as, closeUpvalues);
+    emitRuntimeCall(as, next, ADDRESS(jitReturn), 0, 0, false);
+    patchJump(as, done);
+  }
+
+  emitAluImmediate(as, IMM_SUB, FRAME_REG, sizeof(CallFrame));
+  emitLoad(as, SLOTS_REG, FRAME_REG, offsetof(CallFrame, slots));
+}
+
+// Arithmetic on two numbers, as the recording saw.
+static void emitArithmetic(TraceCompiler* tc, OpCode instruction,
+                           TraceStep* step) {
+  Assembler* as = &tc->as;
+  int height = step->height;
+  emitPeek(as, RAX, 1);
+  emitPeek(as, RCX, 0);
+  guardNumber(tc, RAX, height - 2, step->ip);
+  guardNumber(tc, RCX, height - 1, step->ip);
+
+  emitMoveToXmm(as, 0, RAX);
+  emitMoveToXmm(as, 1, RCX);
+  switch (instruction) {
+    case OP_GREATER:
+    case OP_LESS:
+      if (instruction == OP_GREATER) {
+        emitCompareDoubles(as, 0, 1);
+      } else {
+        emitCompareDoubles(as, 1, 0);
+      }
+      emitSetAl(as, CC_A);
+      emitBoolFromAl(as);
+      break;
+
+    default: {
+      SseOp op = SSE_ADD;
+      if (instruction == OP_SUBTRACT) op = SSE_SUB;
+      if (instruction == OP_MULTIPLY) op = SSE_MUL;
+      if (instruction == OP_DIVIDE) op = SSE_DIV;
+      emitSse(as, op, 0, 1);
+      emitMoveFromXmm(as, RAX, 0);
+      break;
+    }
+  }
+  emitStore(as, STACK_REG, -2 * (int32_t)sizeof(Value), RAX);
+  emitDrop(as, 1);
+  setSlot(tc, height - 2,
+          instruction != OP_GREATER && instruction != OP_LESS);
+}
+
+// How much of the budget an iteration of the recording spends: one for each
+// back-edge and call in it, as the interpreter counts them.
+static int iterationCost(Recorder* rec) {
+  int cost = 0;
+  for (int i = 0; i < rec->count; i++) {
+    switch ((OpCode)rec->steps[i].ip[0]) {
+      case OP_LOOP:
+      case OP_CALL:
+      case OP_TAIL_CALL:
+      case OP_CALL_GLOBAL:
+      case OP_INVOKE:
+      case OP_SUPER_INVOKE:
+        cost++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return cost;
+}
+
+// Compiles the recorded [step]. Returns false if it can't.
+static bool compileStep(TraceCompiler* tc, TraceStep* step, bool last) {
+  Assembler* as = &tc->as;
+  Chunk* chunk = &step->function->chunk;
+  uint8_t* code = step->ip;
+  Value* constants = chunk->constants.values;
+  uint8_t* next = code + instructionLength(chunk, (int)(code - chunk->code));
+  int height = step->height;
+
+#define CONSTANT(index) (constants[code[index]])
+#define STRING(index) AS_STRING(CONSTANT(index))
+#define SHORT(index) ((uint16_t)((code[index] << 8) | code[(index) + 1]))
+#define HELPER(helper, arg1, arg2, checked) \
+    emitRuntimeCall(as, next, ADDRESS(helper), arg1, arg2, checked)
+
+  OpCode instruction = (OpCode)code[0];
+  switch (instruction) {
+    case OP_CONSTANT:
+      emitPushConstant(as, CONSTANT(1));
+      setSlot(tc, height, IS_NUMBER(CONSTANT(1)));
+      break;
+
+    case OP_NIL:
+    case OP_TRUE:
+    case OP_FALSE:
+      emitPushConstant(as, instruction == OP_NIL ? NIL_VAL
+          : BOOL_VAL(instruction == OP_TRUE));
+      setSlot(tc, height, false);
+      break;
+
+    case OP_POP: emitDrop(as, 1); break;
+
+    case OP_GET_LOCAL: {
+      int local = step->base + code[1];
+      emitGetLocal(as, code[1]);
+      setSlot(tc, height, tc->numbers[local]);
+      tc->sources[height] = local;
+      break;
+    }
+
+    case OP_SET_LOCAL: {
+      emitPeek(as, RAX, 0);
+      emitStore(as, SLOTS_REG, sizeof(Value) * code[1], RAX);
+      bool isNumber = tc->numbers[height - 1];
+      setSlot(tc, step->base + code[1], isNumber);
+      break;
+    }
+
+    case OP_GET_GLOBAL: {
+      int undefined = emitLoadGlobal(as, SHORT(1));
+      emitPush(as, RAX);
+      int done = emitJump(as, CC_ALWAYS);
+      patchJump(as, undefined);
+      HELPER(jitGetGlobal, SHORT(1), 0, true);
+      patchJump(as, done);
+      setSlot(tc, height, false);
+      break;
+    }
+
+    case OP_SET_GLOBAL: {
+      int undefined = emitLoadGlobal(as, SHORT(1));
+      emitPeek(as, RAX, 0);
+      emitStore(as, R9, 0, RAX);
+      int done = emitJump(as, CC_ALWAYS);
+      patchJump(as, undefined);
+      HELPER(jitSetGlobal, SHORT(1), 0, true);
+      patchJump(as, done);
+      break;
+    }
+
+    case OP_DEFINE_GLOBAL:
+      HELPER(jitDefineGlobal, SHORT(1), 0, false);
+      break;
+
+    case OP_GET_UPVALUE:
+      emitUpvalueLocation(as, RAX, code[1]);
+      emitLoad(as, RAX, RAX, 0);
+      emitPush(as, RAX);
+      setSlot(tc, height, false);
+      break;
+
+    case OP_SET_UPVALUE:
+      emitUpvalueLocation(as, RAX, code[1]);
+      emitPeek(as, RCX, 0);
+      emitStore(as, RAX, 0, RCX);
+      // The upvalue may point at any captured local on the stack.
+      forgetSlots(tc);
+      break;
+
+    case OP_GET_CAPTURE:
+      emitGetCapture(as, code[1]);
+      setSlot(tc, height, false);
+      break;
+
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_GET_LOCAL_FIELD:
+    case OP_GET_PROPERTY:
+    case OP_GET_FIELD: {
+      bool local = instruction == OP_GET_LOCAL_PROPERTY ||
+                   instruction == OP_GET_LOCAL_FIELD;
+      ObjString* name = STRING(local ? 2 : 1);
+      if (local) {
+        emitGetLocal(as, code[1]);
+        height++;
+      }
+
+      if (step->flags & STEP_FIELD) {
+        int patches[3];
+        emitFindField(as, 0, (ObjShape*)step->object, name, patches);
+        emitStore(as, STACK_REG, -(int32_t)sizeof(Value), RAX);
+        int done = emitJump(as, CC_ALWAYS);
+        patchJumps(as, patches, 3);
+        HELPER(jitGetProperty, ADDRESS(name), 0, true);
+        patchJump(as, done);
+      } else {
+        HELPER(jitGetProperty, ADDRESS(name), 0, true);
+      }
+      setSlot(tc, height - 1, false);
+      break;
+    }
+
+    case OP_SET_PROPERTY: {
+      // Adding a field changes the instance's shape, so only stores to an
+      // existing field are done inline.
+      if (step->flags & STEP_FIELD) {
+        int patches[3];
+        emitFindField(as, 1, (ObjShape*)step->object, STRING(1), patches);
+        emitPeek(as, RAX, 0);
+        emitStore(as, R9, 0, RAX);
+        emitStore(as, STACK_REG, -2 * (int32_t)sizeof(Value), RAX);
+        emitDrop(as, 1);
+        int done = emitJump(as, CC_ALWAYS);
+        patchJumps(as, patches, 3);
+        HELPER(jitSetProperty, ADDRESS(STRING(1)), 0, true);
+        patchJump(as, done);
+      } else {
+        HELPER(jitSetProperty, ADDRESS(STRING(1)), 0, true);
+      }
+      setSlot(tc, height - 2, tc->numbers[height - 1]);
+      break;
+    }
+
+    case OP_GET_SUPER:
+      HELPER(jitGetSuper, ADDRESS(STRING(1)), 0, true);
+      setSlot(tc, height - 2, false);
+      break;
+
+    case OP_EQUAL:
+      emitValuesEqual(as);
+      emitBoolFromAl(as);
+      emitStore(as, STACK_REG, -2 * (int32_t)sizeof(Value), RAX);
+      emitDrop(as, 1);
+      setSlot(tc, height - 2, false);
+      break;
+
+    case OP_GREATER:
+    case OP_LESS:
+    case OP_ADD:
+    case OP_ADD_NUMBER:
+    case OP_ADD_STRING:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+      if (step->flags & STEP_NUMBERS) {
+        emitArithmetic(tc, genericOp(instruction), step);
+      } else {
+        HELPER(jitBinaryOp, genericOp(instruction), 0, true);
+        setSlot(tc, height - 2, false);
+      }
+      break;
+
+    case OP_SUBTRACT_CONSTANT:
+      emitPushConstant(as, CONSTANT(1));
+      setSlot(tc, height, IS_NUMBER(CONSTANT(1)));
+      step->height++;
+      if (step->flags & STEP_NUMBERS) {
+        emitArithmetic(tc, OP_SUBTRACT, step);
+      } else {
+        HELPER(jitBinaryOp, OP_SUBTRACT, 0, true);
+        setSlot(tc, height - 1, false);
+      }
+      step->height--;
+      break;
+
+    case OP_NOT:
+      emitPeek(as, RAX, 0);
+      emitTestFalsey(as, RAX);
+      emitSetAl(as, CC_BE);
+      emitBoolFromAl(as);
+      emitStore(as, STACK_REG, -(int32_t)sizeof(Value), RAX);
+      setSlot(tc, height - 1, false);
+      break;
+
+    case OP_NEGATE:
+      if (step->flags & STEP_NUMBERS) {
+        emitPeek(as, RAX, 0);
+        guardNumber(tc, RAX, height - 1, code);
+        emitMoveImmediate(as, RCX, SIGN_BIT);
+        emitAlu(as, ALU_XOR, RAX, RCX);
+        emitStore(as, STACK_REG, -(int32_t)sizeof(Value), RAX);
+        setSlot(tc, height - 1, true);
+      } else {
+        HELPER(jitNegate, 0, 0, true);
+        setSlot(tc, height - 1, false);
+      }
+      break;
+
+    case OP_PRINT: HELPER(jitPrint, 0, 0, false); break;
+    case OP_JUMP: break;
+
+    case OP_JUMP_IF_FALSE:
+      emitPeek(as, RAX, 0);
+      emitTestFalsey(as, RAX);
+      emitExit(tc, (step->flags & STEP_TAKEN) ? CC_A : CC_BE, code);
+      break;
+
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER:
+      emitPeek(as, RAX, 1);
+      emitPeek(as, RCX, 0);
+      guardNumber(tc, RAX, height - 2, code);
+      guardNumber(tc, RCX, height - 1, code);
+      emitMoveToXmm(as, 0, RAX);
+      emitMoveToXmm(as, 1, RCX);
+      if (instruction == OP_JUMP_IF_NOT_LESS) {
+        emitCompareDoubles(as, 1, 0);
+      } else {
+        emitCompareDoubles(as, 0, 1);
+      }
+      // The comparison passed if the flags are "above".
+      emitExit(tc, (step->flags & STEP_TAKEN) ? CC_A : CC_BE, code);
+      emitDrop(as, 2);
+      if (step->flags & STEP_TAKEN) {
+        emitPushConstant(as, FALSE_VAL);
+        setSlot(tc, height - 2, false);
+      }
+      break;
+
+    case OP_JUMP_IF_NOT_EQUAL:
+      emitValuesEqual(as);
+      emitBytes(as, 0x84, 0xc0); // test al, al
+      emitExit(tc, (step->flags & STEP_TAKEN) ? CC_NE : CC_E, code);
+      emitDrop(as, 2);
+      if (step->flags & STEP_TAKEN) {
+        emitPushConstant(as, FALSE_VAL);
+        setSlot(tc, height - 2, false);
+      }
+      break;
+
+    case OP_LOOP:
+      if (last) {
+        emitMoveImmediate(as, RAX, ADDRESS(&tc->trace->iterations));
+        emitAluMemory32(as, IMM_ADD, RAX, 0, 1);
+
+        // Out of budget, leave at the header for run() to call the hook.
+        // The whole iteration is spent here, so the hook may be called a
+        // few calls later than the interpreter would call it.
+        for (int cost = iterationCost(tc->rec); cost > 0; cost -= 127) {
+          emitAluMemory64(as, IMM_SUB, VM_REG, offsetof(VM, budget),
+                          cost > 127 ? 127 : cost);
+        }
+        emitExit(tc, CC_LE, tc->rec->steps[0].ip);
+        emitJumpTo(as, CC_ALWAYS, tc->loopStart);
+      }
+      break;
+
+    case OP_CALL:
+    case OP_TAIL_CALL:
+    case OP_CALL_GLOBAL: {
+      int argCount = code[1];
+      int calleeSlot = height - argCount - 1;
+      switch (step->object->type) {
+        case OBJ_BOUND_METHOD: {
+          int patches[2];
+          emitPeek(as, RAX, argCount);
+          emitCheckObject(as, RAX, OBJ_BOUND_METHOD, patches);
+          addExit(tc, patches[0], code);
+          addExit(tc, patches[1], code);
+          emitLoad(as, RCX, RAX, offsetof(ObjBoundMethod, method));
+          emitMoveImmediate(as, RDX, ADDRESS(step->callee));
+          emitAlu(as, ALU_CMP, RCX, RDX);
+          emitExit(tc, CC_NE, code);
+
+          emitLoad(as, RCX, RAX, offsetof(ObjBoundMethod, receiver));
+          emitStore(as, STACK_REG,
+                    -(int32_t)sizeof(Value) * (argCount + 1), RCX);
+          setSlot(tc, calleeSlot, false);
+          emitEnterFrame(tc, step, step->callee, argCount, next);
+          break;
+        }
+
+        case OBJ_CLASS:
+          guardValue(tc, argCount, OBJ_VAL(step->object), code);
+          if (step->callee != NULL) {
+            HELPER(traceInstantiate, argCount, 0, false);
+            emitEnterFrame(tc, step, step->callee, argCount, next);
+          } else {
+            HELPER(jitCall, argCount, 0, false);
+          }
+          setSlot(tc, calleeSlot, false);
+          break;
+
+        case OBJ_CLOSURE:
+          guardValue(tc, argCount, OBJ_VAL(step->object), code);
+          emitEnterFrame(tc, step, step->callee, argCount, next);
+          break;
+
+        default:
+          // A native function, which returns right away. Only a pure one
+          // can't fail.
+          guardValue(tc, argCount, OBJ_VAL(step->object), code);
+          HELPER(jitCall, argCount, 0,
+                 !(((ObjNative*)step->object)->flags & NATIVE_PURE));
+          setSlot(tc, calleeSlot, false);
+          break;
+      }
+      break;
+    }
+
+    case OP_INVOKE:
+      guardShape(tc, code[2], (ObjShape*)step->object, code);
+      emitEnterFrame(tc, step, step->callee, code[2], next);
+      break;
+
+    case OP_SUPER_INVOKE:
+      guardValue(tc, 0, OBJ_VAL(step->object), code);
+      emitDrop(as, 1);
+      emitEnterFrame(tc, step, step->callee, code[2], next);
+      break;
+
+    case OP_CLOSURE: {
+      ObjFunction* function = AS_FUNCTION(CONSTANT(1));
+      HELPER(jitClosure, ADDRESS(function), ADDRESS(code + 2), false);
+      for (int i = 0; i < function->upvalueCount; i++) {
+        if (code[2 + i * 2]) tc->captures[step->depth] = true;
+      }
+      setSlot(tc, height, false);
+      break;
+    }
+
+    case OP_CLOSE_UPVALUE: HELPER(jitCloseUpvalue, 0, 0, false); break;
+
+    case OP_RETURN: {
+      bool isNumber = tc->numbers[height - 1];
+      emitLeaveFrame(tc, step, next);
+      setSlot(tc, step->base, isNumber);
+      break;
+    }
+
+    case OP_CLASS:
+      HELPER(jitClass, ADDRESS(STRING(1)), 0, false);
+      setSlot(tc, height, false);
+      break;
+
+    case OP_INHERIT: HELPER(jitInherit, 0, 0, true); break;
+    case OP_METHOD: HELPER(jitMethod, ADDRESS(STRING(1)), 0, false); break;
+
+    default:
+      return false;
+  }
+
+#undef CONSTANT
+#undef STRING
+#undef SHORT
+#undef HELPER
+  return true;
+}
+
+// Compiles the whole recording, assuming the locals in tc->stable hold
+// numbers at the header. Returns the trace's entry point, or -1 on failure.
+static int compileTrace(TraceCompiler* tc) {
+  Recorder* rec = tc->rec;
+  Assembler* as = &tc->as;
+  uint8_t* header = rec->steps[0].ip;
+
+  initAssembler(as);
+  tc->exitCount = 0;
+  forgetSlots(tc);
+
+  int entry = emitEntryAndExits(as);
+  tc->guards = as->count;
+
+  // Check the loop's number locals once, on the way in.
+  for (int slot = 0; slot < rec->entryHeight; slot++) {
+    if (!tc->stable[slot]) continue;
+    emitLoad(as, RAX, SLOTS_REG, sizeof(Value) * slot);
+    addExit(tc, emitJumpIfNotNumber(as, RAX), header);
+    tc->numbers[slot] = true;
+  }
+
+  tc->loopStart = as->count;
+  tc->captures[0] = false;
+  for (int i = 0; i < rec->count; i++) {
+    if (!compileStep(tc, &rec->steps[i], i == rec->count - 1)) return -1;
+  }
+
+  // The exits write back what the interpreter reads.
+  for (int i = 0; i < tc->exitCount; i++) {
+    patchJump(as, tc->exits[i].patch);
+    emitStore(as, VM_REG, offsetof(VM, stackTop), STACK_REG);
+    emitMoveImmediate(as, RAX, ADDRESS(tc->exits[i].ip));
+    emitStore(as, FRAME_REG, offsetof(CallFrame, ip), RAX);
+    emitJumpTo(as, CC_ALWAYS, as->exitOk);
+  }
+
+  return entry;
+}
+
+static void addObject(Trace* trace, Obj* object) {
+  if (object == NULL) return;
+  for (int i = 0; i < trace->objectCount; i++) {
+    if (trace->objects[i] == object) return;
+  }
+
+  trace->objects = GROW_ARRAY(Obj*, trace->objects,
+      trace->objectCount, trace->objectCount + 1);
+  trace->objects[trace->objectCount++] = object;
+}
+
+static void freeTrace(Trace* trace) {
+  FREE_ARRAY(Obj*, trace->objects, trace->objectCount);
+  FREE(Trace, trace);
+}
+
+// Compiles a finished recording, or returns NULL if it can't.
+static Trace* compileRecording(Recorder* rec) {
+  Trace* trace = ALLOCATE(Trace, 1);
+  trace->iterations = 0;
+  trace->fruitlessRuns = 0;
+  trace->objects = NULL;
+  trace->objectCount = 0;
+
+  TraceCompiler tc;
+  tc.rec = rec;
+  tc.trace = trace;
+  tc.exits = NULL;
+  tc.exitCount = 0;
+  tc.exitCapacity = 0;
+  tc.slotCount = rec->entryHeight;
+  for (int i = 0; i < rec->count; i++) {
+    // SUBTRACT_CONSTANT and the local property gets push two values.
+    if (rec->steps[i].height + 2 > tc.slotCount) {
+      tc.slotCount = rec->steps[i].height + 2;
+    }
+  }
+  tc.numbers = ALLOCATE(bool, tc.slotCount);
+  tc.sources = ALLOCATE(int, tc.slotCount);
+  tc.stable = ALLOCATE(bool, rec->entryHeight);
+  for (int slot = 0; slot < rec->entryHeight; slot++) {
+    tc.stable[slot] = rec->entryNumbers[slot];
+  }
+
+  // A local is only stable if the trace leaves a number in it too. Drop the
+  // ones that don't and try again until nothing changes.
+  int entry;
+  for (;;) {
+    entry = compileTrace(&tc);
+    if (entry == -1) break;
+
+    bool changed = false;
+    for (int slot = 0; slot < rec->entryHeight; slot++) {
+      if (tc.stable[slot] && !tc.numbers[slot]) {
+        tc.stable[slot] = false;
+        changed = true;
+      }
+    }
+    if (!changed) break;
+    freeAssembler(&tc.as);
+  }
+
+  uint8_t* code = entry == -1 ? NULL : makeExecutable(&tc.as);
+  if (code != NULL) {
+    trace->enter = (JitFunction)(code + entry);
+    trace->entry = code + tc.guards;
+    for (int i = 0; i < rec->count; i++) {
+      addObject(trace, rec->steps[i].object);
+      addObject(trace, (Obj*)rec->steps[i].callee);
+    }
+  } else {
+    freeTrace(trace);
+    trace = NULL;
+  }
+
+  freeAssembler(&tc.as);
+  FREE_ARRAY(SideExit, tc.exits, tc.exitCapacity);
+  FREE_ARRAY(bool, tc.numbers, tc.slotCount);
+  FREE_ARRAY(int, tc.sources, tc.slotCount);
+  FREE_ARRAY(bool, tc.stable, rec->entryHeight);
+  return trace;
+}
+
+// Records an iteration of [loop], whose frame is on top of the call stack
+// at its header. Returns the compiled trace, or NULL if the recording was
+// abandoned or the VM hit a runtime error, which [result] reports.
+static Trace* recordTrace(Loop* loop, InterpretResult* result) {
+  Recorder rec;
+  rec.loop = loop;
+  rec.frameIndex = vm.frameCount - 1;
+  rec.slots = FRAME_AT(rec.frameIndex)->slots;
+  rec.steps = NULL;
+  rec.count = 0;
+  rec.capacity = 0;
+  rec.entryHeight = (int)(vm.stackTop - rec.slots);
+  rec.entryNumbers = ALLOCATE(bool, rec.entryHeight);
+  for (int slot = 0; slot < rec.entryHeight; slot++) {
+    rec.entryNumbers[slot] = IS_NUMBER(rec.slots[slot]);
+  }
+
+  recorder = &rec;
+  RecordResult recorded;
+  do {
+    recorded = recordInstruction(&rec);
+  } while (recorded == RECORD_CONTINUE);
+
+  *result = recorded == RECORD_ERROR ? INTERPRET_RUNTIME_ERROR
+                                     : INTERPRET_OK;
+  // Compiling allocates, so the recording's objects stay marked until the
+  // trace holds onto them.
+  Trace* trace = NULL;
+  if (recorded == RECORD_CLOSED) trace = compileRecording(&rec);
+  recorder = NULL;
+
+  FREE_ARRAY(TraceStep, rec.steps, rec.capacity);
+  FREE_ARRAY(bool, rec.entryNumbers, rec.entryHeight);
+  return trace;
+}
+
+// Backs off from tracing [loop] for a while, or for good once it has failed
+// too often.
+static void traceFailed(Loop* loop) {
+  loop->traceFailures++;
+  if (loop->traceFailures < MAX_TRACE_FAILURES) {
+    loop->hotAt = loop->backEdges +
+                  (vm.hotLoopThreshold << loop->traceFailures);
+  }
+}
+
+bool traceLoop(Loop* loop) {
+  if (loop->optimized == NULL) {
+    // The count wrapped around.
+    if (loop->traceFailures == MAX_TRACE_FAILURES) return true;
+
+    InterpretResult result;
+    loop->optimized = recordTrace(loop, &result);
+    if (result != INTERPRET_OK) return false;
+    if (loop->optimized == NULL) {
+      traceFailed(loop);
+      return true;
+    }
+  }
+
+  // Recording leaves the frame back at the header, so the trace can take
+  // over from there.
+  Trace* trace = (Trace*)loop->optimized;
+  int iterations = trace->iterations;
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  InterpretResult result = trace->enter(frame, trace->entry);
+  if (result != INTERPRET_OK) return false;
+
+  if (trace->iterations != iterations) {
+    trace->fruitlessRuns = 0;
+  } else if (++trace->fruitlessRuns == MAX_FRUITLESS_RUNS) {
+    // Its code stays around until the VM is freed, but is never run again.
+    freeTrace(trace);
+    loop->optimized = NULL;
+    traceFailed(loop);
+  }
+  return true;
+}
+
+void markTraces(Chunk* chunk) {
+  for (int i = 0; i < chunk->loopCount; i++) {
+    Trace* trace = (Trace*)chunk->loops[i].optimized;
+    if (trace == NULL) continue;
+
+    for (int j = 0; j < trace->objectCount; j++) {
+      markObject(trace->objects[j]);
+    }
+  }
+}
+
+void freeTraces(Chunk* chunk) {
+  for (int i = 0; i < chunk->loopCount; i++) {
+    Trace* trace = (Trace*)chunk->loops[i].optimized;
+    if (trace != NULL) freeTrace(trace);
+    chunk->loops[i].optimized = NULL;
+  }
+}
+#endif
+//< Optimization omit
@@ -0,0 +1,31 @@
+//> Optimization omit
+#ifndef clox_trace_h
+#define clox_trace_h
+
+#include "chunk.h"
+#include "common.h"
+#include "vm.h"
+
+#ifdef TRACE_JIT
+// A loop body compiled to machine code along the path it took while it was
+// recorded.
+typedef struct sTrace Trace;
+
+// The VM's hot loop hook. Records the loop if it has no trace yet, then
+// runs the trace. Returns with the VM wherever the trace left off, which
+// run() picks up from, or false on a runtime error.
+bool traceLoop(Loop* loop);
+
+void markTraceRecording();
+void markTraces(Chunk* chunk);
+void freeTraces(Chunk* chunk);
+
+// Runtime helpers in vm.c for the recorder and for traces.
+bool traceCall(int argCount);
+bool traceInvoke(ObjString* name, int argCount);
+bool traceSuperInvoke(ObjString* name, int argCount);
+void traceInstantiate(int argCount);
+#endif
+
+#endif
+//< Optimization omit
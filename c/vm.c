@@ -4,6 +4,9 @@
 //< Types of Values include-stdarg
 //> vm-include-stdio
 #include <stdio.h>
+//> Optimization omit
+#include <stdlib.h>
+//< Optimization omit
 //> Strings vm-include-string
 #include <string.h>
 //< Strings vm-include-string
@@ -19,6 +22,11 @@
 //> vm-include-debug
 #include "debug.h"
 //< vm-include-debug
+//> Optimization omit
+#include "aot.h"
+#include "jit.h"
+#include "trace.h"
+//< Optimization omit
 //> Strings vm-include-object-memory
 #include "object.h"
 #include "memory.h"
@@ -27,12 +35,140 @@
 
 VM vm; // [one]
 //> Calls and Functions clock-native
+/* Calls and Functions clock-native < Optimization omit
 static Value clockNative(int argCount, Value* args) {
   return NUMBER_VAL((double)clock() / CLOCKS_PER_SEC);
+*/
+//> Optimization omit
+static bool clockNative(int argCount, Value* args, void* context,
+                        Value* result) {
+  *result = NUMBER_VAL((double)clock() / CLOCKS_PER_SEC);
+  return true;
+//< Optimization omit
 }
 //< Calls and Functions clock-native
+//> Optimization omit
+static StackSegment* newStackSegment(int size) {
+  StackSegment* segment = (StackSegment*)malloc(
+      sizeof(StackSegment) + (sizeof(Value) + sizeof(ObjUpvalue*)) * size);
+  if (segment == NULL) exit(1);
+
+  segment->previous = NULL;
+  segment->callerTop = NULL;
+  segment->end = segment->values + size;
+  segment->slotUpvalues = (ObjUpvalue**)segment->end;
+  memset(segment->slotUpvalues, 0, sizeof(ObjUpvalue*) * size);
+  segment->openUpvalues = NULL;
+  return segment;
+}
+
+static void useStackSegment(StackSegment* segment) {
+  vm.stackSegment = segment;
+  vm.stack = segment->values;
+  vm.stackLimit = segment->end;
+}
+
+// Moves the callee and arguments on top of the stack to a new segment with
+// room for [size] values.
+static void growStack(int argCount, int size) {
+  StackSegment* segment = vm.spareStackSegment;
+  vm.spareStackSegment = NULL;
+  if (segment == NULL || segment->end - segment->values < size) {
+    free(segment);
+    segment = newStackSegment(size > STACK_SEGMENT_SIZE ? size
+                                                        : STACK_SEGMENT_SIZE);
+  }
+
+  Value* callee = vm.stackTop - argCount - 1;
+  memcpy(segment->values, callee, sizeof(Value) * (argCount + 1));
+
+  StackSegment* current = vm.stackSegment;
+  if (callee == current->values && current->previous != NULL) {
+    // A tail call from the only frame in this segment, which nothing will
+    // return to, so the new one replaces it. The tail call has closed the
+    // frame's upvalues.
+    segment->previous = current->previous;
+    segment->callerTop = current->callerTop;
+    free(current);
+  } else {
+    segment->previous = current;
+    segment->callerTop = callee;
+    current->openUpvalues = vm.openUpvalues;
+    vm.openUpvalues = NULL;
+  }
+
+  useStackSegment(segment);
+  vm.stackTop = segment->values + argCount + 1;
+}
+
+// Pops a returning frame's slots. The first frame in a segment returns to
+// the previous one, where its caller left the callee.
+static void dropSlots(Value* slots) {
+  StackSegment* segment = vm.stackSegment;
+  if (slots != segment->values || segment->previous == NULL) {
+    vm.stackTop = slots;
+    return;
+  }
+
+  // The returning frame has closed its upvalues.
+  vm.stackTop = segment->callerTop;
+  useStackSegment(segment->previous);
+  vm.openUpvalues = vm.stackSegment->openUpvalues;
+  vm.stackSegment->openUpvalues = NULL;
+  free(vm.spareStackSegment);
+  vm.spareStackSegment = segment;
+}
+
+// Prints the values on the stack up to [top] in [segment], starting with
+// the segments below it.
+static void printStack(StackSegment* segment, Value* top) {
+  if (segment->previous != NULL) {
+    printStack(segment->previous, segment->callerTop);
+  }
+
+  for (Value* slot = segment->values; slot < top; slot++) {
+    printf("[ ");
+    printValue(*slot);
+    printf(" ]");
+  }
+}
+
+// Adds a segment of frames to the call stack when it's full. Returns false
+// if it's already maxFrames deep.
+static bool growFrames() {
+  if (vm.frameCapacity >= vm.maxFrames) return false;
+
+  int count = vm.frameCapacity / FRAME_SEGMENT_SIZE;
+  vm.frameSegments = (CallFrame**)realloc(vm.frameSegments,
+                                          sizeof(CallFrame*) * (count + 1));
+  if (vm.frameSegments == NULL) exit(1);
+
+  vm.frameSegments[count] =
+      (CallFrame*)malloc(sizeof(CallFrame) * FRAME_SEGMENT_SIZE);
+  if (vm.frameSegments[count] == NULL) exit(1);
+
+  vm.frameCapacity += FRAME_SEGMENT_SIZE;
+  if (vm.frameCapacity > vm.maxFrames) vm.frameCapacity = vm.maxFrames;
+  return true;
+}
+//< Optimization omit
 //> reset-stack
 static void resetStack() {
+//> Optimization omit
+  while (vm.stackSegment->previous != NULL) {
+    StackSegment* segment = vm.stackSegment;
+    useStackSegment(segment->previous);
+    free(segment);
+  }
+
+  // Upvalues a runtime error leaves open stay open, but later captures of
+  // the same slots mustn't find them.
+  StackSegment* segment = vm.stackSegment;
+  memset(segment->slotUpvalues, 0,
+         sizeof(ObjUpvalue*) * (segment->end - segment->values));
+  segment->openUpvalues = NULL;
+
+//< Optimization omit
   vm.stackTop = vm.stack;
 //> Calls and Functions reset-frame-count
   vm.frameCount = 0;
@@ -64,18 +200,43 @@ static void runtimeError(const char* format, ...) {
 */
 //> Calls and Functions runtime-error-stack
   for (int i = vm.frameCount - 1; i >= 0; i--) {
+/* Calls and Functions runtime-error-stack < Optimization omit
     CallFrame* frame = &vm.frames[i];
+*/
+//> Optimization omit
+    CallFrame* frame = FRAME_AT(i);
+//< Optimization omit
 /* Calls and Functions runtime-error-stack < Closures runtime-error-function
     ObjFunction* function = frame->function;
 */
 //> Closures runtime-error-function
     ObjFunction* function = frame->closure->function;
 //< Closures runtime-error-function
+//> Optimization omit
+#ifdef REGISTER_VM
+    RegisterChunk* registers = function->chunk.registers;
+    if (registers != NULL) {
+      size_t instruction = frame->registerIp - registers->code - 1;
+      if (frame->registerIp == registers->code) instruction = 0;
+      fprintf(stderr, "[line %d] in ", registers->lines[instruction]);
+    } else {
+#endif
+//< Optimization omit
     // -1 because the IP is sitting on the next instruction to be
     // executed.
     size_t instruction = frame->ip - function->chunk.code - 1;
+//> Optimization omit
+    // The budget can run out before a frame's first instruction, on the call
+    // into it or on a loop that starts the function.
+    if (frame->ip == function->chunk.code) instruction = 0;
+//< Optimization omit
     fprintf(stderr, "[line %d] in ",
             function->chunk.lines[instruction]);
+//> Optimization omit
+#ifdef REGISTER_VM
+    }
+#endif
+//< Optimization omit
     if (function->name == NULL) {
       fprintf(stderr, "script\n");
     } else {
@@ -88,16 +249,53 @@ static void runtimeError(const char* format, ...) {
 }
 //< Types of Values runtime-error
 //> Calls and Functions define-native
+/* Calls and Functions define-native < Optimization omit
 static void defineNative(const char* name, NativeFn function) {
+*/
+//> Optimization omit
+void defineNative(const char* name, NativeFn function, int arity,
+                  void* context, int flags) {
+//< Optimization omit
   push(OBJ_VAL(copyString(name, (int)strlen(name))));
+/* Calls and Functions define-native < Optimization omit
   push(OBJ_VAL(newNative(function)));
+*/
+//> Optimization omit
+  push(OBJ_VAL(newNative(function, arity, context, flags)));
+//< Optimization omit
+/* Calls and Functions define-native < Optimization omit
   tableSet(&vm.globals, AS_STRING(vm.stack[0]), vm.stack[1]);
+*/
+//> Optimization omit
+  int slot = globalSlot(AS_STRING(vm.stackTop[-2]));
+  vm.globalValues.values[slot] = vm.stackTop[-1];
+//< Optimization omit
   pop();
   pop();
 }
+//> Optimization omit
+
+bool nativeError(const char* format, ...) {
+  char message[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  runtimeError("%s", message);
+  return false;
+}
+//< Optimization omit
 //< Calls and Functions define-native
 
 void initVM() {
+//> Optimization omit
+  useStackSegment(newStackSegment(STACK_SEGMENT_SIZE));
+  vm.spareStackSegment = NULL;
+  vm.frameSegments = NULL;
+  vm.frameCapacity = 0;
+  vm.maxFrames = FRAMES_MAX;
+
+//< Optimization omit
 //> call-reset-stack
   resetStack();
 //< call-reset-stack
@@ -116,7 +314,14 @@ void initVM() {
 //< Garbage Collection init-gray-stack
 //> Global Variables init-globals
 
+/* Global Variables init-globals < Optimization omit
   initTable(&vm.globals);
+*/
+//> Optimization omit
+  initTable(&vm.globalSlots);
+  initValueArray(&vm.globalNames);
+  initValueArray(&vm.globalValues);
+//< Optimization omit
 //< Global Variables init-globals
 //> Hash Tables init-strings
   initTable(&vm.strings);
@@ -127,16 +332,52 @@ void initVM() {
   vm.initString = NULL;
 //< null-init-string
   vm.initString = copyString("init", 4);
+//> Optimization omit
+  initValueArray(&vm.selectors);
+  selectorOf(vm.initString);
+//< Optimization omit
 //< Methods and Initializers init-init-string
 //> Calls and Functions define-native-clock
 
+/* Calls and Functions define-native-clock < Optimization omit
   defineNative("clock", clockNative);
+*/
+//> Optimization omit
+  defineNative("clock", clockNative, 0, NULL, NATIVE_NO_GC);
+//< Optimization omit
 //< Calls and Functions define-native-clock
+//> Optimization omit
+
+  vm.hotCallThreshold = HOT_CALL_THRESHOLD;
+  vm.hotLoopThreshold = HOT_LOOP_THRESHOLD;
+  vm.onHotFunction = NULL;
+  vm.onHotLoop = NULL;
+  vm.budget = NO_BUDGET;
+  vm.onBudgetExhausted = NULL;
+#ifdef DEBUG_TRACE_EXECUTION
+  vm.traceExecution = true;
+#else
+  vm.traceExecution = false;
+#endif
+#ifdef BASELINE_JIT
+  vm.onHotFunction = jitCompile;
+#endif
+#ifdef TRACE_JIT
+  vm.onHotLoop = traceLoop;
+#endif
+//< Optimization omit
 }
 
 void freeVM() {
 //> Global Variables free-globals
+/* Global Variables free-globals < Optimization omit
   freeTable(&vm.globals);
+*/
+//> Optimization omit
+  freeTable(&vm.globalSlots);
+  freeValueArray(&vm.globalNames);
+  freeValueArray(&vm.globalValues);
+//< Optimization omit
 //< Global Variables free-globals
 //> Hash Tables free-strings
   freeTable(&vm.strings);
@@ -144,9 +385,26 @@ void freeVM() {
 //> Methods and Initializers clear-init-string
   vm.initString = NULL;
 //< Methods and Initializers clear-init-string
+//> Optimization omit
+  freeValueArray(&vm.selectors);
+//< Optimization omit
 //> Strings call-free-objects
   freeObjects();
 //< Strings call-free-objects
+//> Optimization omit
+  resetStack();
+  free(vm.stackSegment);
+  free(vm.spareStackSegment);
+  int frameSegmentCount =
+      (vm.frameCapacity + FRAME_SEGMENT_SIZE - 1) / FRAME_SEGMENT_SIZE;
+  for (int i = 0; i < frameSegmentCount; i++) {
+    free(vm.frameSegments[i]);
+  }
+  free(vm.frameSegments);
+#ifdef BASELINE_JIT
+  jitFreeCode();
+#endif
+//< Optimization omit
 }
 //> push
 void push(Value value) {
@@ -160,11 +418,70 @@ Value pop() {
   return *vm.stackTop;
 }
 //< pop
+//> Optimization omit
+// Returns the slot of the global variable [name], giving it a new,
+// undefined slot the first time the name is seen. Returns -1 if the
+// program already has GLOBALS_MAX globals.
+int globalSlot(ObjString* name) {
+  Value slot;
+  if (tableGet(&vm.globalSlots, name, &slot)) return (int)AS_NUMBER(slot);
+  if (vm.globalNames.count == GLOBALS_MAX) return -1;
+
+  push(OBJ_VAL(name));
+  writeValueArray(&vm.globalNames, OBJ_VAL(name));
+  writeValueArray(&vm.globalValues, UNDEFINED_VAL);
+  tableSet(&vm.globalSlots, name, NUMBER_VAL(vm.globalNames.count - 1));
+  pop();
+  return vm.globalNames.count - 1;
+}
+
+// The name of the global variable in [slot].
+static ObjString* globalName(int slot) {
+  return AS_STRING(vm.globalNames.values[slot]);
+}
+//< Optimization omit
 //> Types of Values peek
 static Value peek(int distance) {
   return vm.stackTop[-1 - distance];
 }
 //< Types of Values peek
+//> Optimization omit
+// Calls the tier-up hooks when a function or loop gets hot.
+static void hotFunction(ObjFunction* function) {
+#ifdef DEBUG_LOG_TIERING
+  printf("-- hot function %s after %u calls\n",
+         function->name == NULL ? "script" : function->name->chars,
+         function->callCount - 1);
+#endif
+  if (vm.onHotFunction != NULL) vm.onHotFunction(function);
+}
+
+static bool hotLoop(Loop* loop) {
+#ifdef DEBUG_LOG_TIERING
+  if (loop->optimized == NULL) {
+    ObjFunction* function = FRAME_AT(vm.frameCount - 1)->closure->function;
+    printf("-- hot loop at %d in %s after %u back-edges\n", loop->header,
+           function->name == NULL ? "script" : function->name->chars,
+           loop->backEdges);
+  }
+#endif
+  return vm.onHotLoop == NULL || vm.onHotLoop(loop);
+}
+
+// Asks the budget hook what to do now that the budget has run out, with
+// the frame's ip stored. Returns INTERPRET_OK to carry on.
+static InterpretResult budgetExhausted() {
+  BudgetAction action = vm.onBudgetExhausted == NULL
+      ? BUDGET_ABORT : vm.onBudgetExhausted();
+  switch (action) {
+    case BUDGET_CONTINUE: return INTERPRET_OK;
+    case BUDGET_SUSPEND: return INTERPRET_SUSPENDED;
+    default:
+      runtimeError("Execution budget exhausted.");
+      return INTERPRET_RUNTIME_ERROR;
+  }
+}
+//< Optimization omit
 /* Calls and Functions call < Closures call-signature
 static bool call(ObjFunction* function, int argCount) {
 */
@@ -188,13 +505,34 @@ static bool call(ObjClosure* closure, int argCount) {
 
 //< check-arity
 //> check-overflow
+/* Calls and Functions check-overflow < Optimization omit
   if (vm.frameCount == FRAMES_MAX) {
+*/
+//> Optimization omit
+  if (vm.frameCount == vm.frameCapacity && !growFrames()) {
+//< Optimization omit
     runtimeError("Stack overflow.");
     return false;
   }
 
 //< check-overflow
+/* Calls and Functions call < Optimization omit
   CallFrame* frame = &vm.frames[vm.frameCount++];
+*/
+//> Optimization omit
+  ObjFunction* function = closure->function;
+  if (function->callCount++ == vm.hotCallThreshold) hotFunction(function);
+
+  // This is the only check that the stack has room. The function never has
+  // more on the stack than this.
+  int size = function->maxSlots + STACK_HEADROOM;
+  if (vm.stackLimit - (vm.stackTop - argCount - 1) < size) {
+    growStack(argCount, size);
+  }
+
+  CallFrame* frame = FRAME_AT(vm.frameCount);
+  vm.frameCount++;
+//< Optimization omit
 /* Calls and Functions call < Closures call-init-closure
   frame->function = function;
   frame->ip = function->chunk.code;
@@ -205,9 +543,37 @@ static bool call(ObjClosure* closure, int argCount) {
 //< Closures call-init-closure
 
   frame->slots = vm.stackTop - argCount - 1;
+//> Optimization omit
+#ifdef REGISTER_VM
+  RegisterChunk* registers = closure->function->chunk.registers;
+  if (registers != NULL) {
+    frame->registerIp = registers->code;
+
+    // The registers past the arguments may hold values left behind by
+    // earlier calls that the GC has since freed.
+    Value* frameTop = frame->slots + registers->registerCount;
+    for (Value* slot = vm.stackTop; slot < frameTop; slot++) {
+      *slot = NIL_VAL;
+    }
+  }
+#endif
+//< Optimization omit
   return true;
 }
 //< Calls and Functions call
+//> Optimization omit
+// Calls [native] with the [argCount] arguments at [args], where they are on
+// the stack, and leaves the result in the callee's slot before them.
+static bool callNative(ObjNative* native, int argCount, Value* args) {
+  if (native->arity != NATIVE_VARIADIC && argCount != native->arity) {
+    runtimeError("Expected %d arguments but got %d.",
+        native->arity, argCount);
+    return false;
+  }
+
+  return native->function(argCount, args, native->context, &args[-1]);
+}
+//< Optimization omit
 //> Calls and Functions call-value
 static bool callValue(Value callee, int argCount) {
   if (IS_OBJ(callee)) {
@@ -227,9 +593,16 @@ static bool callValue(Value callee, int argCount) {
         ObjClass* klass = AS_CLASS(callee);
         vm.stackTop[-argCount - 1] = OBJ_VAL(newInstance(klass));
 //> Methods and Initializers call-init
+/* Methods and Initializers call-init < Optimization omit
         Value initializer;
         if (tableGet(&klass->methods, vm.initString, &initializer)) {
           return call(AS_CLOSURE(initializer), argCount);
+*/
+//> Optimization omit
+        ObjClosure* initializer = klass->initializer;
+        if (initializer != NULL) {
+          return call(initializer, argCount);
+//< Optimization omit
 //> no-init-arity-error
         } else if (argCount != 0) {
           runtimeError("Expected 0 arguments but got %d.", argCount);
@@ -252,10 +625,17 @@ static bool callValue(Value callee, int argCount) {
 //> call-native
         
       case OBJ_NATIVE: {
+/* Calls and Functions call-native < Optimization omit
         NativeFn native = AS_NATIVE(callee);
         Value result = native(argCount, vm.stackTop - argCount);
         vm.stackTop -= argCount + 1;
         push(result);
+*/
+//> Optimization omit
+        Value* args = vm.stackTop - argCount;
+        if (!callNative(AS_NATIVE(callee), argCount, args)) return false;
+        vm.stackTop = args;
+//< Optimization omit
         return true;
       }
 //< call-native
@@ -270,16 +650,87 @@ static bool callValue(Value callee, int argCount) {
   return false;
 }
 //< Calls and Functions call-value
+//> Optimization omit
+// Returns the property cache at [index] in the chunk [frame] is running, or
+// NULL if the instruction is uncached.
+static PropertyCache* framePropertyCache(CallFrame* frame, uint8_t index) {
+  if (index == PROPERTY_UNCACHED) return NULL;
+  return &frame->closure->function->chunk.propertyCaches[index];
+}
+
+// Looks up the field [name] of [instance], trying the instruction's [cache]
+// first and filling it in if the field is found.
+static bool getField(PropertyCache* cache, ObjInstance* instance,
+                     ObjString* name, Value* value) {
+  if (cache != NULL && cache->shape == instance->shape) {
+    *value = instance->fields[cache->slot];
+    return true;
+  }
+
+  int slot = shapeSlot(instance->shape, name);
+  if (slot == -1) return false;
+
+  if (cache != NULL) {
+    cache->shape = instance->shape;
+    cache->slot = slot;
+    cache->transition = NULL;
+  }
+  *value = instance->fields[slot];
+  return true;
+}
+
+// Stores [value] in the field [name] of [instance], adding the field if it
+// doesn't have one yet. The value must be somewhere the GC can see it.
+static void setField(PropertyCache* cache, ObjInstance* instance,
+                     ObjString* name, Value value) {
+  ObjShape* shape = instance->shape;
+  if (cache != NULL && cache->shape == shape) {
+    if (cache->transition == NULL) {
+      instance->fields[cache->slot] = value;
+    } else {
+      addField(instance, cache->transition, value);
+    }
+    return;
+  }
+
+  int slot = shapeSlot(shape, name);
+  ObjShape* transition = NULL;
+  if (slot == -1) {
+    slot = shape->fieldCount;
+    transition = shapeTransition(shape, name);
+    addField(instance, transition, value);
+  } else {
+    instance->fields[slot] = value;
+  }
+
+  if (cache != NULL) {
+    cache->shape = shape;
+    cache->slot = slot;
+    cache->transition = transition;
+  }
+}
+//< Optimization omit
 //> Methods and Initializers invoke-from-class
 static bool invokeFromClass(ObjClass* klass, ObjString* name,
                             int argCount) {
+/* Methods and Initializers invoke-from-class < Optimization omit
   Value method;
   if (!tableGet(&klass->methods, name, &method)) {
+*/
+//> Optimization omit
+  ObjClosure* method = findMethod(klass, name);
+  if (method == NULL) {
+//< Optimization omit
     runtimeError("Undefined property '%s'.", name->chars);
     return false;
   }
 
+/* Methods and Initializers invoke-from-class < Optimization omit
   return call(AS_CLOSURE(method), argCount);
+*/
+//> Optimization omit
+  return call(method, argCount);
+//< Optimization omit
 }
 //< Methods and Initializers invoke-from-class
 //> Methods and Initializers invoke
@@ -297,7 +748,12 @@ static bool invoke(ObjString* name, int argCount) {
 //> invoke-field
 
   Value value;
+/* Methods and Initializers invoke-field < Optimization omit
   if (tableGet(&instance->fields, name, &value)) {
+*/
+//> Optimization omit
+  if (getField(NULL, instance, name, &value)) {
+//< Optimization omit
     vm.stackTop[-argCount - 1] = value;
     return callValue(value, argCount);
   }
@@ -306,15 +762,143 @@ static bool invoke(ObjString* name, int argCount) {
   return invokeFromClass(instance->klass, name, argCount);
 }
 //< Methods and Initializers invoke
+//> Optimization omit
+// Returns the method [cache] holds for [klass], or NULL if it doesn't hold
+// one.
+static ObjClosure* findCachedMethod(InvokeCache* cache, ObjClass* klass) {
+  if (cache->epoch != vm.methodEpoch) {
+    cache->count = 0;
+    cache->epoch = vm.methodEpoch;
+  }
+
+  for (int i = 0; i < cache->count; i++) {
+    if (cache->classes[i] == klass) return cache->methods[i];
+  }
+  return NULL;
+}
+
+static void cacheMethod(InvokeCache* cache, ObjClass* klass,
+                        ObjClosure* method) {
+  if (cache->count == INVOKE_CACHE_SIZE) return;
+  cache->classes[cache->count] = klass;
+  cache->methods[cache->count] = method;
+  cache->count++;
+}
+
+// Calls [method] with the receiver, an instance, and [argCount] arguments
+// on the stack. A method that only gets or sets a field of the receiver has
+// that done here instead of running in a frame of its own.
+static bool callMethod(ObjClosure* method, int argCount) {
+  ObjFunction* function = method->function;
+  if (function->accessor == ACCESSOR_NONE || argCount != function->arity) {
+    return call(method, argCount);
+  }
+
+  ObjInstance* instance = AS_INSTANCE(peek(argCount));
+  PropertyCache* cache = function->accessorCache == PROPERTY_UNCACHED
+      ? NULL : &function->chunk.propertyCaches[function->accessorCache];
+  if (function->accessor == ACCESSOR_GET) {
+    // Without the field, the getter binds a method or reports the error.
+    Value value;
+    if (!getField(cache, instance, function->accessorField, &value)) {
+      return call(method, argCount);
+    }
+    vm.stackTop[-1] = value;
+    return true;
+  }
+
+  Value value = peek(0);
+  setField(cache, instance, function->accessorField, value);
+  vm.stackTop--;
+  vm.stackTop[-1] = function->accessor == ACCESSOR_SET ? NIL_VAL : value;
+  return true;
+}
+
+// Does what invoke() does, using and filling in the call site's [cache],
+// which is NULL if the site is uncached.
+static bool invokeCached(InvokeCache* cache, ObjString* name,
+                         int argCount) {
+  Value receiver = peek(argCount);
+  if (cache == NULL || !IS_INSTANCE(receiver)) {
+    return invoke(name, argCount);
+  }
+
+  ObjClass* klass = AS_INSTANCE(receiver)->klass;
+  ObjClosure* method = findCachedMethod(cache, klass);
+  if (method != NULL) return callMethod(method, argCount);
+
+  // Only a class whose instances have never shadowed one of its methods
+  // with a field can skip the instance's fields.
+  if (klass->hasShadowingField ||
+      (method = findMethod(klass, name)) == NULL) {
+    return invoke(name, argCount);
+  }
+
+  cacheMethod(cache, klass, method);
+  return callMethod(method, argCount);
+}
+
+static bool superInvokeCached(InvokeCache* cache, ObjClass* superclass,
+                              ObjString* name, int argCount) {
+  if (cache == NULL) return invokeFromClass(superclass, name, argCount);
+
+  ObjClosure* method = findCachedMethod(cache, superclass);
+  if (method != NULL) return callMethod(method, argCount);
+
+  method = findMethod(superclass, name);
+  if (method == NULL) return invokeFromClass(superclass, name, argCount);
+
+  cacheMethod(cache, superclass, method);
+  return callMethod(method, argCount);
+}
+
+// Returns the inline cache at [index] in the chunk [frame] is running, or
+// NULL if the call site is uncached.
+static InvokeCache* frameInvokeCache(CallFrame* frame, uint8_t index) {
+  if (index == INVOKE_UNCACHED) return NULL;
+  return &frame->closure->function->chunk.invokeCaches[index];
+}
+
+static CallCache* frameCallCache(CallFrame* frame, uint8_t index) {
+  if (index == CALL_UNCACHED) return NULL;
+  return &frame->closure->function->chunk.callCaches[index];
+}
+
+// Calls a function read from a global variable. The site remembers the
+// closure it last called, so calling it again skips the type dispatch
+// callValue() does.
+static bool callGlobal(CallCache* cache, Value callee, int argCount) {
+  if (cache != NULL && IS_OBJ(callee) &&
+      AS_OBJ(callee) == (Obj*)cache->closure) {
+    return call(cache->closure, argCount);
+  }
+
+  if (cache != NULL && IS_CLOSURE(callee)) {
+    cache->closure = AS_CLOSURE(callee);
+  }
+  return callValue(callee, argCount);
+}
+//< Optimization omit
 //> Methods and Initializers bind-method
 static bool bindMethod(ObjClass* klass, ObjString* name) {
+/* Methods and Initializers bind-method < Optimization omit
   Value method;
   if (!tableGet(&klass->methods, name, &method)) {
+*/
+//> Optimization omit
+  ObjClosure* method = findMethod(klass, name);
+  if (method == NULL) {
+//< Optimization omit
     runtimeError("Undefined property '%s'.", name->chars);
     return false;
   }
 
+/* Methods and Initializers bind-method < Optimization omit
   ObjBoundMethod* bound = newBoundMethod(peek(0), AS_CLOSURE(method));
+*/
+//> Optimization omit
+  ObjBoundMethod* bound = newBoundMethod(peek(0), method);
+//< Optimization omit
   pop();
   push(OBJ_VAL(bound));
   return true;
@@ -322,29 +906,61 @@ static bool bindMethod(ObjClass* klass, ObjString* name) {
 //< Methods and Initializers bind-method
 //> Closures capture-upvalue
 static ObjUpvalue* captureUpvalue(Value* local) {
+//> Optimization omit
+  // The local is almost always in the segment the top of the stack is in,
+  // where the open upvalues are in vm.openUpvalues.
+  StackSegment* segment = vm.stackSegment;
+  ObjUpvalue** openUpvalues = &vm.openUpvalues;
+  while (local < segment->values || local >= segment->end) {
+    segment = segment->previous;
+    openUpvalues = &segment->openUpvalues;
+  }
+
+  ObjUpvalue** slotUpvalue = &segment->slotUpvalues[local - segment->values];
+  if (*slotUpvalue != NULL) return *slotUpvalue;
+
+//< Optimization omit
 //> look-for-existing-upvalue
+/* Closures look-for-existing-upvalue < Optimization omit
   ObjUpvalue* prevUpvalue = NULL;
   ObjUpvalue* upvalue = vm.openUpvalues;
+*/
+//> Optimization omit
+  // The list is sorted from the top of the stack down, so a new upvalue
+  // only goes past those capturing higher slots of the segment.
+  ObjUpvalue* prevUpvalue = NULL;
+  ObjUpvalue* upvalue = *openUpvalues;
+//< Optimization omit
 
   while (upvalue != NULL && upvalue->location > local) {
     prevUpvalue = upvalue;
     upvalue = upvalue->next;
   }
 
+/* Closures look-for-existing-upvalue < Optimization omit
   if (upvalue != NULL && upvalue->location == local) return upvalue;
 
+*/
 //< look-for-existing-upvalue
   ObjUpvalue* createdUpvalue = newUpvalue(local);
 //> insert-upvalue-in-list
   createdUpvalue->next = upvalue;
 
   if (prevUpvalue == NULL) {
+/* Closures insert-upvalue-in-list < Optimization omit
     vm.openUpvalues = createdUpvalue;
+*/
+//> Optimization omit
+    *openUpvalues = createdUpvalue;
+//< Optimization omit
   } else {
     prevUpvalue->next = createdUpvalue;
   }
 
 //< insert-upvalue-in-list
+//> Optimization omit
+  *slotUpvalue = createdUpvalue;
+//< Optimization omit
   return createdUpvalue;
 }
 //< Closures capture-upvalue
@@ -353,17 +969,97 @@ static void closeUpvalues(Value* last) {
   while (vm.openUpvalues != NULL &&
          vm.openUpvalues->location >= last) {
     ObjUpvalue* upvalue = vm.openUpvalues;
+//> Optimization omit
+    vm.stackSegment->slotUpvalues[upvalue->location - vm.stack] = NULL;
+//< Optimization omit
     upvalue->closed = *upvalue->location;
     upvalue->location = &upvalue->closed;
     vm.openUpvalues = upvalue->next;
   }
 }
 //< Closures close-upvalues
+//> Optimization omit
+// Captures the local in [slot] as [closure]'s upvalue at [index]. A closure
+// that can't outlive the frame creating it points straight at the slot.
+static ObjUpvalue* captureLocal(ObjClosure* closure, int index, Value* slot) {
+  if (closure->stackUpvalues == NULL) return captureUpvalue(slot);
+
+  ObjUpvalue* upvalue = &closure->stackUpvalues[index];
+  upvalue->location = slot;
+  return upvalue;
+}
+
+// Shares [enclosing]'s upvalue at [index] with [closure]. A closure that
+// may escape can't share one kept on the stack by a closure that doesn't,
+// so it gets a real upvalue for the slot instead.
+static ObjUpvalue* inheritUpvalue(ObjClosure* closure, ObjClosure* enclosing,
+                                  int index) {
+  ObjUpvalue* upvalue = enclosing->upvalues[index];
+  if (closure->function->escapes && !enclosing->function->escapes &&
+      upvalue->location != &upvalue->closed) {
+    return captureUpvalue(upvalue->location);
+  }
+  return upvalue;
+}
+//< Optimization omit
+//> Optimization omit
+// Calls [closure] for a call in tail position, reusing the frame on top of
+// the call stack instead of pushing a new one. The callee and its arguments
+// are moved down over the caller's slots, so upvalues still pointing at them
+// are closed first.
+static bool tailCall(ObjClosure* closure, int argCount) {
+  if (argCount != closure->function->arity) {
+    runtimeError("Expected %d arguments but got %d.",
+        closure->function->arity, argCount);
+    return false;
+  }
+
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  closeUpvalues(frame->slots);
+
+  Value* callee = vm.stackTop - argCount - 1;
+  memmove(frame->slots, callee, sizeof(Value) * (argCount + 1));
+  vm.stackTop = frame->slots + argCount + 1;
+
+  vm.frameCount--;
+  return call(closure, argCount);
+}
+
+// Like callValue(), but for a call in tail position. Callees that run in a
+// frame of their own get the caller's. Natives, and classes without an
+// initializer, don't need one, and leave their result on the stack as usual.
+static bool tailCallValue(Value callee, int argCount) {
+  if (IS_CLOSURE(callee)) return tailCall(AS_CLOSURE(callee), argCount);
+
+  if (IS_BOUND_METHOD(callee)) {
+    ObjBoundMethod* bound = AS_BOUND_METHOD(callee);
+    vm.stackTop[-argCount - 1] = bound->receiver;
+    return tailCall(bound->method, argCount);
+  }
+
+  ObjClosure* initializer;
+  if (IS_CLASS(callee) &&
+      (initializer = AS_CLASS(callee)->initializer) != NULL) {
+    vm.stackTop[-argCount - 1] = OBJ_VAL(newInstance(AS_CLASS(callee)));
+    return tailCall(initializer, argCount);
+  }
+
+  return callValue(callee, argCount);
+}
+//< Optimization omit
 //> Methods and Initializers define-method
 static void defineMethod(ObjString* name) {
   Value method = peek(0);
   ObjClass* klass = AS_CLASS(peek(1));
+/* Methods and Initializers define-method < Optimization omit
   tableSet(&klass->methods, name, method);
+*/
+//> Optimization omit
+  setMethod(klass, name, AS_CLOSURE(method));
+//< Optimization omit
+//> Optimization omit
+  vm.methodEpoch++;
+//< Optimization omit
   pop();
 }
 //< Methods and Initializers define-method
@@ -398,10 +1094,314 @@ static void concatenate() {
 }
 //< Strings concatenate
 //> run
+//> Optimization omit
+#ifdef DISPATCH_THREADED
+static void threadHandlers(Chunk* chunk, void** dispatchTable) {
+  for (int offset = 0; offset < chunk->count;
+       offset += instructionLength(chunk, offset)) {
+    chunk->threaded[offset].handler = dispatchTable[chunk->code[offset]];
+  }
+}
+
+static void threadChunk(Chunk* chunk, void** dispatchTable) {
+  chunk->threaded = ALLOCATE(ThreadedCode, chunk->count);
+  for (int offset = 0; offset < chunk->count;) {
+    int length = instructionLength(chunk, offset);
+    for (int i = 1; i < length; i++) {
+      chunk->threaded[offset + i].operand = chunk->code[offset + i];
+    }
+
+    offset += length;
+  }
+  threadHandlers(chunk, dispatchTable);
+}
+
+// Points the handlers of all the threaded code there is into
+// [dispatchTable].
+static void rethreadChunks(void** dispatchTable) {
+  for (Obj* object = vm.objects; object != NULL; object = object->next) {
+    if (object->type != OBJ_FUNCTION) continue;
+
+    Chunk* chunk = &((ObjFunction*)object)->chunk;
+    if (chunk->threaded != NULL) threadHandlers(chunk, dispatchTable);
+  }
+}
+#endif
+//< Optimization omit
 static InterpretResult run() {
 //> Calls and Functions run
+/* Calls and Functions run < Optimization omit
   CallFrame* frame = &vm.frames[vm.frameCount - 1];
 
+*/
+//> Optimization omit
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+
+  static void* dispatchTable[] = {
+    [OP_CONSTANT]            = &&code_OP_CONSTANT,
+    [OP_NIL]                 = &&code_OP_NIL,
+    [OP_TRUE]                = &&code_OP_TRUE,
+    [OP_FALSE]               = &&code_OP_FALSE,
+    [OP_POP]                 = &&code_OP_POP,
+    [OP_GET_LOCAL]           = &&code_OP_GET_LOCAL,
+    [OP_SET_LOCAL]           = &&code_OP_SET_LOCAL,
+    [OP_GET_GLOBAL]          = &&code_OP_GET_GLOBAL,
+    [OP_DEFINE_GLOBAL]       = &&code_OP_DEFINE_GLOBAL,
+    [OP_SET_GLOBAL]          = &&code_OP_SET_GLOBAL,
+    [OP_GET_UPVALUE]         = &&code_OP_GET_UPVALUE,
+    [OP_SET_UPVALUE]         = &&code_OP_SET_UPVALUE,
+    [OP_GET_CAPTURE]         = &&code_OP_GET_CAPTURE,
+    [OP_GET_PROPERTY]        = &&code_OP_GET_PROPERTY,
+    [OP_SET_PROPERTY]        = &&code_OP_SET_PROPERTY,
+    [OP_GET_LOCAL_PROPERTY]  = &&code_OP_GET_LOCAL_PROPERTY,
+    [OP_GET_FIELD]           = &&code_OP_GET_FIELD,
+    [OP_GET_LOCAL_FIELD]     = &&code_OP_GET_LOCAL_FIELD,
+    [OP_GET_SUPER]           = &&code_OP_GET_SUPER,
+    [OP_EQUAL]               = &&code_OP_EQUAL,
+    [OP_GREATER]             = &&code_OP_GREATER,
+    [OP_LESS]                = &&code_OP_LESS,
+    [OP_ADD]                 = &&code_OP_ADD,
+    [OP_ADD_NUMBER]          = &&code_OP_ADD_NUMBER,
+    [OP_ADD_STRING]          = &&code_OP_ADD_STRING,
+    [OP_SUBTRACT]            = &&code_OP_SUBTRACT,
+    [OP_SUBTRACT_CONSTANT]   = &&code_OP_SUBTRACT_CONSTANT,
+    [OP_MULTIPLY]            = &&code_OP_MULTIPLY,
+    [OP_DIVIDE]              = &&code_OP_DIVIDE,
+    [OP_NOT]                 = &&code_OP_NOT,
+    [OP_NEGATE]              = &&code_OP_NEGATE,
+    [OP_PRINT]               = &&code_OP_PRINT,
+    [OP_JUMP]                = &&code_OP_JUMP,
+    [OP_JUMP_IF_FALSE]       = &&code_OP_JUMP_IF_FALSE,
+    [OP_JUMP_IF_NOT_LESS]    = &&code_OP_JUMP_IF_NOT_LESS,
+    [OP_JUMP_IF_NOT_GREATER] = &&code_OP_JUMP_IF_NOT_GREATER,
+    [OP_JUMP_IF_NOT_EQUAL]   = &&code_OP_JUMP_IF_NOT_EQUAL,
+    [OP_LOOP]                = &&code_OP_LOOP,
+    [OP_CALL]                = &&code_OP_CALL,
+    [OP_TAIL_CALL]           = &&code_OP_TAIL_CALL,
+    [OP_CALL_GLOBAL]         = &&code_OP_CALL_GLOBAL,
+    [OP_INVOKE]              = &&code_OP_INVOKE,
+    [OP_SUPER_INVOKE]        = &&code_OP_SUPER_INVOKE,
+    [OP_CLOSURE]             = &&code_OP_CLOSURE,
+    [OP_CLOSE_UPVALUE]       = &&code_OP_CLOSE_UPVALUE,
+    [OP_RETURN]              = &&code_OP_RETURN,
+    [OP_CLASS]               = &&code_OP_CLASS,
+    [OP_INHERIT]             = &&code_OP_INHERIT,
+    [OP_METHOD]              = &&code_OP_METHOD,
+  };
+
+  // While tracing, every instruction is sent to traceInstruction instead.
+  static void* traceTable[] = {
+    [0 ... sizeof(dispatchTable) / sizeof(void*) - 1] = &&traceInstruction
+  };
+#endif
+#ifdef DISPATCH_THREADED
+  // Whether the handlers in threaded code were taken from traceTable.
+  static bool threadedTracing = false;
+#endif
+
+  // The interpreter's hot state lives in locals so the C compiler can keep it
+  // in registers instead of reloading it through the CallFrame and the
+  // global VM on every instruction:
+  //
+  // - ip is written back to the CallFrame before anything that reads it from
+  //   there: calling another function and reporting a runtime error.
+  // - slots and constants are only read, so they just need reloading when
+  //   the current frame changes.
+  // - stackTop is written back to the VM before calls and before anything
+  //   that might allocate, since that can trigger a collection and the GC
+  //   marks the stack from vm.stackTop. Any helper that pushes or pops
+  //   through vm.stackTop must be followed by reloading it.
+  // - With CACHE_TOP_OF_STACK, the topmost value lives in top and only
+  //   reaches vm.stack when the stack is written back. stackTop then points
+  //   at the slot top will be spilled to, so everything below it is in
+  //   memory. The stack is never empty while run() executes (slot zero holds
+  //   the running closure), so top always holds a value.
+#ifdef DISPATCH_THREADED
+  ThreadedCode* ip;
+#else
+  uint8_t* ip;
+#endif
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+  void** table = dispatchTable;
+#else
+  uint8_t instruction;
+  uint8_t traceBit = 0;
+#endif
+  Value* slots;
+  Value* constants;
+  Value* stackTop;
+#ifdef CACHE_TOP_OF_STACK
+  Value top;
+  Value popped;
+#endif
+
+#ifdef DISPATCH_THREADED
+#define CODE_START() (frame->closure->function->chunk.threaded)
+#define STORE_IP() \
+    (frame->ip = frame->closure->function->chunk.code + \
+        (ip - CODE_START()))
+#define LOAD_IP() \
+    do { \
+      Chunk* chunk = &frame->closure->function->chunk; \
+      if (chunk->threaded == NULL) threadChunk(chunk, table); \
+      ip = chunk->threaded + (frame->ip - chunk->code); \
+    } while (false)
+#else
+#define CODE_START() (frame->closure->function->chunk.code)
+#define STORE_IP() (frame->ip = ip)
+#define LOAD_IP() (ip = frame->ip)
+#endif
+
+#ifdef CACHE_TOP_OF_STACK
+#define STORE_STACK() (*stackTop = top, vm.stackTop = stackTop + 1)
+#define LOAD_STACK() (stackTop = vm.stackTop - 1, top = *stackTop)
+#else
+#define STORE_STACK() (vm.stackTop = stackTop)
+#define LOAD_STACK() (stackTop = vm.stackTop)
+#endif
+
+  // Frames with register code are run by runRegisters(), so run() returns
+  // to let interpret() switch over when one ends up on top.
+#ifdef REGISTER_VM
+#define LEAVE_IF_REGISTER_FRAME() \
+    if (frame->closure->function->chunk.registers != NULL) { \
+      return INTERPRET_OK; \
+    }
+#else
+#define LEAVE_IF_REGISTER_FRAME() do { } while (false)
+#endif
+
+  // A frame that can resume in machine code is run there instead. jitRun()
+  // returns once the frame on top is one that it can't run.
+#ifdef BASELINE_JIT
+#define RUN_COMPILED_FRAMES() \
+    while (frame->closure->function->jitCode != NULL && \
+           jitEntry(frame) != NULL) { \
+      InterpretResult result = jitRun(frame); \
+      if (result != INTERPRET_OK) return result; \
+      if (vm.frameCount == 0) return INTERPRET_OK; \
+      frame = FRAME_AT(vm.frameCount - 1); \
+    }
+#else
+#define RUN_COMPILED_FRAMES() do { } while (false)
+#endif
+
+  // Tracing is switched by changing where instructions are dispatched to,
+  // so while it's off, dispatch costs exactly what it did without it. A
+  // change to vm.traceExecution is picked up when a frame is loaded and at
+  // back-edges. Threaded code has its handlers in the code itself, so every
+  // threaded chunk is rewritten. With a switch, traceBit moves every opcode
+  // off its own case and onto the default one.
+#if defined(DISPATCH_THREADED)
+#define SYNC_TRACING() \
+    do { \
+      bool tracing = vm.traceExecution; \
+      table = tracing ? traceTable : dispatchTable; \
+      if (tracing != threadedTracing) { \
+        threadedTracing = tracing; \
+        rethreadChunks(table); \
+      } \
+    } while (false)
+#elif defined(DISPATCH_COMPUTED_GOTO)
+#define SYNC_TRACING() \
+    (table = vm.traceExecution ? traceTable : dispatchTable)
+#else
+#define SYNC_TRACING() (traceBit = vm.traceExecution ? 0x80 : 0)
+#endif
+
+#define STORE_FRAME() \
+    do { \
+      STORE_IP(); \
+      STORE_STACK(); \
+    } while (false)
+#define LOAD_FRAME() \
+    do { \
+      frame = FRAME_AT(vm.frameCount - 1); \
+      LEAVE_IF_REGISTER_FRAME(); \
+      RUN_COMPILED_FRAMES(); \
+      SYNC_TRACING(); \
+      LOAD_IP(); \
+      slots = frame->slots; \
+      constants = frame->closure->function->chunk.constants.values; \
+      LOAD_STACK(); \
+    } while (false)
+
+  // TOP is the topmost value as an lvalue so handlers that replace it can
+  // do so in place. PUSH() spills the old top before evaluating its argument,
+  // so pushing a copy of a local that was on top still reads the right value.
+#ifdef CACHE_TOP_OF_STACK
+#define PUSH(value) (*stackTop++ = top, top = (value))
+#define POP() (popped = top, top = *--stackTop, popped)
+#define DROP() (top = *--stackTop)
+#define TOP top
+#define PEEK(distance) ((distance) == 0 ? top : stackTop[-(distance)])
+#else
+#define PUSH(value) (*stackTop++ = (value))
+#define POP() (*--stackTop)
+#define DROP() (stackTop--)
+#define TOP (stackTop[-1])
+#define PEEK(distance) (stackTop[-1 - (distance)])
+#endif
+
+  // Natives never push a frame, so a call to one doesn't reload the frame
+  // afterwards, and the stack is only written back for one that may
+  // allocate. SPILL_ARGS() returns where the [argCount] arguments on top of
+  // the stack are in memory, and DROP_ARGS() leaves the result on top.
+#ifdef CACHE_TOP_OF_STACK
+#define SPILL_ARGS(argCount) (*stackTop = top, stackTop + 1 - (argCount))
+#define DROP_ARGS(argCount) (stackTop -= (argCount), top = *stackTop)
+#else
+#define SPILL_ARGS(argCount) (stackTop - (argCount))
+#define DROP_ARGS(argCount) (stackTop -= (argCount))
+#endif
+#define CALL_NATIVE(argCount) \
+    do { \
+      ObjNative* native = AS_NATIVE(PEEK(argCount)); \
+      Value* args = SPILL_ARGS(argCount); \
+      STORE_IP(); \
+      if (!(native->flags & NATIVE_NO_GC)) vm.stackTop = args + (argCount); \
+      if (!callNative(native, argCount, args)) { \
+        return INTERPRET_RUNTIME_ERROR; \
+      } \
+      DROP_ARGS(argCount); \
+    } while (false)
+
+  // Spends one of the budget's back-edges or calls, once the instruction is
+  // done, so a suspended VM carries on with the next one.
+#define SPEND_BUDGET() \
+    do { \
+      if (--vm.budget <= 0) { \
+        STORE_FRAME(); \
+        InterpretResult result = budgetExhausted(); \
+        if (result != INTERPRET_OK) return result; \
+      } \
+    } while (false)
+
+  // Quickening rewrites the instruction whose opcode is [distance] bytes
+  // behind ip into [instruction]. Generic instructions specialize themselves
+  // this way based on the operands they see. When a specialized form's guard
+  // fails, it rewrites itself back to the generic form, backs ip up to the
+  // opcode, and dispatches again. In threaded mode, both the threaded code
+  // and the bytecode are rewritten so that they stay in sync.
+#ifdef DISPATCH_THREADED
+#define QUICKEN(distance, instruction) \
+    do { \
+      ip[-(distance)].handler = table[instruction]; \
+      frame->closure->function->chunk.code[ \
+          ip - (distance) - CODE_START()] = (instruction); \
+    } while (false)
+#else
+#define QUICKEN(distance, instruction) (ip[-(distance)] = (instruction))
+#endif
+
+#define RUNTIME_ERROR(...) \
+    do { \
+      STORE_FRAME(); \
+      runtimeError(__VA_ARGS__); \
+      return INTERPRET_RUNTIME_ERROR; \
+    } while (false)
+//< Optimization omit
 /* A Virtual Machine run < Calls and Functions run
 #define READ_BYTE() (*vm.ip++)
 */
@@ -412,17 +1412,36 @@ static InterpretResult run() {
 #define READ_SHORT() \
     (vm.ip += 2, (uint16_t)((vm.ip[-2] << 8) | vm.ip[-1]))
 */
+/* Calls and Functions run < Optimization omit
 #define READ_BYTE() (*frame->ip++)
 #define READ_SHORT() \
     (frame->ip += 2, (uint16_t)((frame->ip[-2] << 8) | frame->ip[-1]))
+*/
+//> Optimization omit
+
+#ifdef DISPATCH_THREADED
+#define READ_BYTE() ((ip++)->operand)
+#define READ_SHORT() \
+    (ip += 2, (uint16_t)((ip[-2].operand << 8) | ip[-1].operand))
+#else
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() \
+    (ip += 2, (uint16_t)((ip[-2] << 8) | ip[-1]))
+#endif
+//< Optimization omit
 //< Calls and Functions run
 /* Calls and Functions run < Closures read-constant
 #define READ_CONSTANT() \
     (frame->function->chunk.constants.values[READ_BYTE()])
 */
 //> Closures read-constant
+/* Closures read-constant < Optimization omit
 #define READ_CONSTANT() \
     (frame->closure->function->chunk.constants.values[READ_BYTE()])
+*/
+//> Optimization omit
+#define READ_CONSTANT() (constants[READ_BYTE()])
+//< Optimization omit
 //< Closures read-constant
 //> Global Variables read-string
 #define READ_STRING() AS_STRING(READ_CONSTANT())
@@ -439,6 +1458,7 @@ static InterpretResult run() {
     } while (false)
 */
 //> Types of Values binary-op
+/* Types of Values binary-op < Optimization omit
 #define BINARY_OP(valueType, op) \
     do { \
       if (!IS_NUMBER(peek(0)) || !IS_NUMBER(peek(1))) { \
@@ -449,12 +1469,84 @@ static InterpretResult run() {
       double a = AS_NUMBER(pop()); \
       push(valueType(a op b)); \
     } while (false)
+*/
+//> Optimization omit
+#define BINARY_OP(valueType, op) \
+    do { \
+      if (!IS_NUMBER(PEEK(0)) || !IS_NUMBER(PEEK(1))) { \
+        RUNTIME_ERROR("Operands must be numbers."); \
+      } \
+      double b = AS_NUMBER(POP()); \
+      TOP = valueType(AS_NUMBER(TOP) op b); \
+    } while (false)
+
+  // A comparison fused with the OP_JUMP_IF_FALSE and OP_POP that follow it.
+  // The operands are checked before reading the offset so that a runtime
+  // error reports the comparison's line.
+#define JUMP_UNLESS(op) \
+    do { \
+      if (!IS_NUMBER(PEEK(0)) || !IS_NUMBER(PEEK(1))) { \
+        RUNTIME_ERROR("Operands must be numbers."); \
+      } \
+      double b = AS_NUMBER(POP()); \
+      double a = AS_NUMBER(POP()); \
+      uint16_t offset = READ_SHORT(); \
+      if (!(a op b)) { \
+        PUSH(BOOL_VAL(false)); \
+        ip += offset; \
+      } \
+    } while (false)
+
+#define TRACE_INSTRUCTION() \
+    do { \
+      printf("          "); \
+      STORE_STACK(); \
+      printStack(vm.stackSegment, vm.stackTop); \
+      printf("\n"); \
+      disassembleInstruction(&frame->closure->function->chunk, \
+          (int)(ip - CODE_START())); \
+    } while (false)
+
+  // Every handler ends by jumping straight to the next instruction's handler.
+  // With computed goto, that is one indirect branch per handler, which gives
+  // the CPU's branch predictor much more to work with than the single shared
+  // branch at the top of a switch. Direct-threaded code goes further and
+  // skips the table lookup by storing the handler addresses in the code.
+#if defined(DISPATCH_THREADED)
+#define INTERPRET_LOOP DISPATCH();
+#define CASE(name) code_##name
+#define TRACE_CASE traceInstruction
+#define DISPATCH() goto *(ip++)->handler
+#elif defined(DISPATCH_COMPUTED_GOTO)
+#define INTERPRET_LOOP DISPATCH();
+#define CASE(name) code_##name
+#define TRACE_CASE traceInstruction
+#define DISPATCH() goto *table[READ_BYTE()]
+#else
+// DISPATCH() is a plain continue here, so a handler must not use it from
+// inside a nested loop.
+#define INTERPRET_LOOP \
+    instruction = READ_BYTE() | traceBit; \
+  dispatchInstruction: \
+    switch (instruction)
+#define CASE(name) case name
+#define TRACE_CASE default
+#define DISPATCH() continue
+#endif
+//< Optimization omit
 //< Types of Values binary-op
 
+//> Optimization omit
+  LOAD_FRAME();
+
+//< Optimization omit
   for (;;) {
 //> trace-execution
+/* A Virtual Machine trace-execution < Optimization omit
 #ifdef DEBUG_TRACE_EXECUTION
+*/
 //> trace-stack
+/* A Virtual Machine trace-stack < Optimization omit
     printf("          ");
     for (Value* slot = vm.stack; slot < vm.stackTop; slot++) {
       printf("[ ");
@@ -462,6 +1554,7 @@ static InterpretResult run() {
       printf(" ]");
     }
     printf("\n");
+*/
 //< trace-stack
 /* A Virtual Machine trace-execution < Calls and Functions trace-execution
     disassembleInstruction(vm.chunk, (int)(vm.ip - vm.chunk->code));
@@ -471,62 +1564,125 @@ static InterpretResult run() {
         (int)(frame->ip - frame->function->chunk.code));
 */
 //> Closures disassemble-instruction
+/* Closures disassemble-instruction < Optimization omit
     disassembleInstruction(&frame->closure->function->chunk,
         (int)(frame->ip - frame->closure->function->chunk.code));
+*/
 //< Closures disassemble-instruction
+/* A Virtual Machine trace-execution < Optimization omit
 #endif
 
+*/
 //< trace-execution
+/* A Virtual Machine run < Optimization omit
     uint8_t instruction;
     switch (instruction = READ_BYTE()) {
+*/
+//> Optimization omit
+    INTERPRET_LOOP {
+//< Optimization omit
 //> op-constant
+/* A Virtual Machine op-constant < Optimization omit
       case OP_CONSTANT: {
         Value constant = READ_CONSTANT();
+*/
+//> Optimization omit
+      CASE(OP_CONSTANT): {
+        Value constant = READ_CONSTANT();
+        PUSH(constant);
+        DISPATCH();
+      }
+//< Optimization omit
 /* A Virtual Machine op-constant < A Virtual Machine push-constant
         printValue(constant);
         printf("\n");
 */
 //> push-constant
+/* A Virtual Machine push-constant < Optimization omit
         push(constant);
+*/
 //< push-constant
+/* A Virtual Machine op-constant < Optimization omit
         break;
       }
+*/
 //< op-constant
 //> Types of Values interpret-literals
+/* Types of Values interpret-literals < Optimization omit
       case OP_NIL: push(NIL_VAL); break;
       case OP_TRUE: push(BOOL_VAL(true)); break;
       case OP_FALSE: push(BOOL_VAL(false)); break;
+*/
+//> Optimization omit
+      CASE(OP_NIL): PUSH(NIL_VAL); DISPATCH();
+      CASE(OP_TRUE): PUSH(BOOL_VAL(true)); DISPATCH();
+      CASE(OP_FALSE): PUSH(BOOL_VAL(false)); DISPATCH();
+//< Optimization omit
 //< Types of Values interpret-literals
 //> Global Variables interpret-pop
+/* Global Variables interpret-pop < Optimization omit
       case OP_POP: pop(); break;
+*/
+//> Optimization omit
+      CASE(OP_POP): DROP(); DISPATCH();
+//< Optimization omit
 //< Global Variables interpret-pop
 //> Local Variables interpret-get-local
+/* Local Variables interpret-get-local < Optimization omit
 
       case OP_GET_LOCAL: {
         uint8_t slot = READ_BYTE();
+*/
+//> Optimization omit
+
+      CASE(OP_GET_LOCAL): {
+        uint8_t slot = READ_BYTE();
+        PUSH(slots[slot]);
+        DISPATCH();
+      }
+//< Optimization omit
 /* Local Variables interpret-get-local < Calls and Functions push-local
         push(vm.stack[slot]); // [slot]
 */
 //> Calls and Functions push-local
+/* Calls and Functions push-local < Optimization omit
         push(frame->slots[slot]);
+*/
 //< Calls and Functions push-local
+/* Local Variables interpret-get-local < Optimization omit
         break;
       }
+*/
 //< Local Variables interpret-get-local
 //> Local Variables interpret-set-local
+/* Local Variables interpret-set-local < Optimization omit
 
       case OP_SET_LOCAL: {
         uint8_t slot = READ_BYTE();
+*/
+//> Optimization omit
+
+      CASE(OP_SET_LOCAL): {
+        uint8_t slot = READ_BYTE();
+        slots[slot] = PEEK(0);
+        DISPATCH();
+      }
+//< Optimization omit
 /* Local Variables interpret-set-local < Calls and Functions set-local
         vm.stack[slot] = peek(0);
 */
 //> Calls and Functions set-local
+/* Calls and Functions set-local < Optimization omit
         frame->slots[slot] = peek(0);
+*/
 //< Calls and Functions set-local
+/* Local Variables interpret-set-local < Optimization omit
         break;
       }
+*/
 //< Local Variables interpret-set-local
 //> Global Variables interpret-get-global
+/* Global Variables interpret-get-global < Optimization omit
 
       case OP_GET_GLOBAL: {
         ObjString* name = READ_STRING();
@@ -538,8 +1694,22 @@ static InterpretResult run() {
         push(value);
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_GET_GLOBAL): {
+        uint16_t slot = READ_SHORT();
+        Value value = vm.globalValues.values[slot];
+        if (IS_UNDEFINED(value)) {
+          RUNTIME_ERROR("Undefined variable '%s'.", globalName(slot)->chars);
+        }
+        PUSH(value);
+        DISPATCH();
+      }
+//< Optimization omit
 //< Global Variables interpret-get-global
 //> Global Variables interpret-define-global
+/* Global Variables interpret-define-global < Optimization omit
 
       case OP_DEFINE_GLOBAL: {
         ObjString* name = READ_STRING();
@@ -547,8 +1717,19 @@ static InterpretResult run() {
         pop();
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_DEFINE_GLOBAL): {
+        uint16_t slot = READ_SHORT();
+        vm.globalValues.values[slot] = PEEK(0);
+        DROP();
+        DISPATCH();
+      }
+//< Optimization omit
 //< Global Variables interpret-define-global
 //> Global Variables interpret-set-global
+/* Global Variables interpret-set-global < Optimization omit
 
       case OP_SET_GLOBAL: {
         ObjString* name = READ_STRING();
@@ -559,33 +1740,156 @@ static InterpretResult run() {
         }
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_SET_GLOBAL): {
+        uint16_t slot = READ_SHORT();
+        if (IS_UNDEFINED(vm.globalValues.values[slot])) {
+          RUNTIME_ERROR("Undefined variable '%s'.", globalName(slot)->chars);
+        }
+        vm.globalValues.values[slot] = PEEK(0);
+        DISPATCH();
+      }
+//< Optimization omit
 //< Global Variables interpret-set-global
 //> Closures interpret-get-upvalue
+/* Closures interpret-get-upvalue < Optimization omit
 
       case OP_GET_UPVALUE: {
         uint8_t slot = READ_BYTE();
         push(*frame->closure->upvalues[slot]->location);
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_GET_UPVALUE): {
+        uint8_t slot = READ_BYTE();
+        PUSH(*frame->closure->upvalues[slot]->location);
+        DISPATCH();
+      }
+//< Optimization omit
 //< Closures interpret-get-upvalue
 //> Closures interpret-set-upvalue
+/* Closures interpret-set-upvalue < Optimization omit
 
       case OP_SET_UPVALUE: {
         uint8_t slot = READ_BYTE();
         *frame->closure->upvalues[slot]->location = peek(0);
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_SET_UPVALUE): {
+        uint8_t slot = READ_BYTE();
+        *frame->closure->upvalues[slot]->location = PEEK(0);
+        DISPATCH();
+      }
+
+      CASE(OP_GET_CAPTURE):
+        PUSH(frame->closure->captures[READ_BYTE()]);
+        DISPATCH();
+//< Optimization omit
 //< Closures interpret-set-upvalue
 //> Classes and Instances interpret-get-property
+/* Classes and Instances interpret-get-property < Optimization omit
 
       case OP_GET_PROPERTY: {
+*/
+//> Optimization omit
+
+      CASE(OP_GET_LOCAL_PROPERTY): {
+        PUSH(slots[READ_BYTE()]);
+        if (!IS_INSTANCE(TOP)) {
+          RUNTIME_ERROR("Only instances have properties.");
+        }
+
+        ObjInstance* instance = AS_INSTANCE(TOP);
+        ObjString* name = READ_STRING();
+        PropertyCache* cache = framePropertyCache(frame, READ_BYTE());
+        Value value;
+        if (getField(cache, instance, name, &value)) {
+          QUICKEN(4, OP_GET_LOCAL_FIELD);
+          TOP = value; // Replace the instance.
+          DISPATCH();
+        }
+
+        STORE_FRAME();
+        if (!bindMethod(instance->klass, name)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_STACK();
+        DISPATCH();
+      }
+
+      CASE(OP_GET_LOCAL_FIELD): {
+        PUSH(slots[READ_BYTE()]);
+        ObjString* name = READ_STRING();
+        PropertyCache* cache = framePropertyCache(frame, READ_BYTE());
+        Value value;
+        if (IS_INSTANCE(TOP) &&
+            getField(cache, AS_INSTANCE(TOP), name, &value)) {
+          TOP = value; // Replace the instance.
+          DISPATCH();
+        }
+
+        DROP();
+        QUICKEN(4, OP_GET_LOCAL_PROPERTY);
+        ip -= 4;
+        DISPATCH();
+      }
+
+      CASE(OP_GET_FIELD): {
+        ObjString* name = READ_STRING();
+        PropertyCache* cache = framePropertyCache(frame, READ_BYTE());
+        Value value;
+        if (IS_INSTANCE(TOP) &&
+            getField(cache, AS_INSTANCE(TOP), name, &value)) {
+          TOP = value; // Replace the instance.
+          DISPATCH();
+        }
+
+        QUICKEN(3, OP_GET_PROPERTY);
+        ip -= 3;
+        DISPATCH();
+      }
+
+      CASE(OP_GET_PROPERTY): {
+        if (!IS_INSTANCE(PEEK(0))) {
+          RUNTIME_ERROR("Only instances have properties.");
+        }
+
+        ObjInstance* instance = AS_INSTANCE(PEEK(0));
+        ObjString* name = READ_STRING();
+        PropertyCache* cache = framePropertyCache(frame, READ_BYTE());
+
+        Value value;
+        if (getField(cache, instance, name, &value)) {
+          QUICKEN(3, OP_GET_FIELD);
+          TOP = value; // Replace the instance.
+          DISPATCH();
+        }
+
+        STORE_FRAME();
+        if (!bindMethod(instance->klass, name)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_STACK();
+        DISPATCH();
+      }
+//< Optimization omit
 //> get-not-instance
+/* Classes and Instances get-not-instance < Optimization omit
         if (!IS_INSTANCE(peek(0))) {
           runtimeError("Only instances have properties.");
           return INTERPRET_RUNTIME_ERROR;
         }
 
+*/
 //< get-not-instance
+/* Classes and Instances interpret-get-property < Optimization omit
         ObjInstance* instance = AS_INSTANCE(peek(0));
         ObjString* name = READ_STRING();
         
@@ -595,31 +1899,61 @@ static InterpretResult run() {
           push(value);
           break;
         }
+*/
 //> get-undefined
+/* Classes and Instances get-undefined < Optimization omit
 
+*/
 //< get-undefined
 /* Classes and Instances get-undefined < Methods and Initializers get-method
         runtimeError("Undefined property '%s'.", name->chars);
         return INTERPRET_RUNTIME_ERROR;
 */
 //> Methods and Initializers get-method
+/* Methods and Initializers get-method < Optimization omit
         if (!bindMethod(instance->klass, name)) {
           return INTERPRET_RUNTIME_ERROR;
         }
         break;
+*/
 //< Methods and Initializers get-method
+/* Classes and Instances interpret-get-property < Optimization omit
       }
+*/
 //< Classes and Instances interpret-get-property
 //> Classes and Instances interpret-set-property
+/* Classes and Instances interpret-set-property < Optimization omit
 
       case OP_SET_PROPERTY: {
+*/
+//> Optimization omit
+
+      CASE(OP_SET_PROPERTY): {
+        if (!IS_INSTANCE(PEEK(1))) {
+          RUNTIME_ERROR("Only instances have fields.");
+        }
+
+        ObjInstance* instance = AS_INSTANCE(PEEK(1));
+        ObjString* name = READ_STRING();
+        PropertyCache* cache = framePropertyCache(frame, READ_BYTE());
+        STORE_STACK();
+        setField(cache, instance, name, PEEK(0));
+
+        Value value = POP();
+        TOP = value; // Replace the instance.
+        DISPATCH();
+      }
+//< Optimization omit
 //> set-not-instance
+/* Classes and Instances set-not-instance < Optimization omit
         if (!IS_INSTANCE(peek(1))) {
           runtimeError("Only instances have fields.");
           return INTERPRET_RUNTIME_ERROR;
         }
 
+*/
 //< set-not-instance
+/* Classes and Instances interpret-set-property < Optimization omit
         ObjInstance* instance = AS_INSTANCE(peek(1));
         tableSet(&instance->fields, READ_STRING(), peek(0));
         
@@ -628,8 +1962,10 @@ static InterpretResult run() {
         push(value);
         break;
       }
+*/
 //< Classes and Instances interpret-set-property
 //> Superclasses interpret-get-super
+/* Superclasses interpret-get-super < Optimization omit
 
       case OP_GET_SUPER: {
         ObjString* name = READ_STRING();
@@ -639,8 +1975,23 @@ static InterpretResult run() {
         }
         break;
       }
+*/
+//> Optimization omit
+
+      CASE(OP_GET_SUPER): {
+        ObjString* name = READ_STRING();
+        ObjClass* superclass = AS_CLASS(POP());
+        STORE_FRAME();
+        if (!bindMethod(superclass, name)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_STACK();
+        DISPATCH();
+      }
+//< Optimization omit
 //< Superclasses interpret-get-super
 //> Types of Values interpret-equal
+/* Types of Values interpret-equal < Optimization omit
 
       case OP_EQUAL: {
         Value b = pop();
@@ -649,10 +2000,26 @@ static InterpretResult run() {
         break;
       }
 
+*/
+//> Optimization omit
+
+      CASE(OP_EQUAL): {
+        Value b = POP();
+        TOP = BOOL_VAL(valuesEqual(TOP, b));
+        DISPATCH();
+      }
+//< Optimization omit
 //< Types of Values interpret-equal
 //> Types of Values interpret-comparison
+/* Types of Values interpret-comparison < Optimization omit
       case OP_GREATER:  BINARY_OP(BOOL_VAL, >); break;
       case OP_LESS:     BINARY_OP(BOOL_VAL, <); break;
+*/
+//> Optimization omit
+
+      CASE(OP_GREATER):  BINARY_OP(BOOL_VAL, >); DISPATCH();
+      CASE(OP_LESS):     BINARY_OP(BOOL_VAL, <); DISPATCH();
+//< Optimization omit
 //< Types of Values interpret-comparison
 /* A Virtual Machine op-binary < Types of Values op-arithmetic
       case OP_ADD:      BINARY_OP(+); break;
@@ -667,6 +2034,7 @@ static InterpretResult run() {
       case OP_ADD:      BINARY_OP(NUMBER_VAL, +); break;
 */
 //> Strings add-strings
+/* Strings add-strings < Optimization omit
       case OP_ADD: {
         if (IS_STRING(peek(0)) && IS_STRING(peek(1))) {
           concatenate();
@@ -680,18 +2048,83 @@ static InterpretResult run() {
         }
         break;
       }
+*/
+//> Optimization omit
+      CASE(OP_ADD): {
+        if (IS_STRING(PEEK(0)) && IS_STRING(PEEK(1))) {
+          QUICKEN(1, OP_ADD_STRING);
+          STORE_STACK();
+          concatenate();
+          LOAD_STACK();
+        } else if (IS_NUMBER(PEEK(0)) && IS_NUMBER(PEEK(1))) {
+          QUICKEN(1, OP_ADD_NUMBER);
+          double b = AS_NUMBER(POP());
+          TOP = NUMBER_VAL(AS_NUMBER(TOP) + b);
+        } else {
+          RUNTIME_ERROR("Operands must be two numbers or two strings.");
+        }
+        DISPATCH();
+      }
+      CASE(OP_ADD_NUMBER): {
+        if (!IS_NUMBER(PEEK(0)) || !IS_NUMBER(PEEK(1))) {
+          QUICKEN(1, OP_ADD);
+          ip--;
+          DISPATCH();
+        }
+
+        double b = AS_NUMBER(POP());
+        TOP = NUMBER_VAL(AS_NUMBER(TOP) + b);
+        DISPATCH();
+      }
+
+      CASE(OP_ADD_STRING):
+        if (!IS_STRING(PEEK(0)) || !IS_STRING(PEEK(1))) {
+          QUICKEN(1, OP_ADD);
+          ip--;
+          DISPATCH();
+        }
+
+        STORE_STACK();
+        concatenate();
+        LOAD_STACK();
+        DISPATCH();
+//< Optimization omit
 //< Strings add-strings
 //> Types of Values op-arithmetic
+/* Types of Values op-arithmetic < Optimization omit
       case OP_SUBTRACT: BINARY_OP(NUMBER_VAL, -); break;
       case OP_MULTIPLY: BINARY_OP(NUMBER_VAL, *); break;
       case OP_DIVIDE:   BINARY_OP(NUMBER_VAL, /); break;
+*/
+//> Optimization omit
+      CASE(OP_SUBTRACT): BINARY_OP(NUMBER_VAL, -); DISPATCH();
+      CASE(OP_MULTIPLY): BINARY_OP(NUMBER_VAL, *); DISPATCH();
+      CASE(OP_DIVIDE):   BINARY_OP(NUMBER_VAL, /); DISPATCH();
+      CASE(OP_SUBTRACT_CONSTANT): {
+        Value b = READ_CONSTANT();
+        if (!IS_NUMBER(TOP) || !IS_NUMBER(b)) {
+          RUNTIME_ERROR("Operands must be numbers.");
+        }
+
+        TOP = NUMBER_VAL(AS_NUMBER(TOP) - AS_NUMBER(b));
+        DISPATCH();
+      }
+//< Optimization omit
 //< Types of Values op-arithmetic
 //> Types of Values op-not
+/* Types of Values op-not < Optimization omit
       case OP_NOT:
         push(BOOL_VAL(isFalsey(pop())));
         break;
+*/
+//> Optimization omit
+      CASE(OP_NOT):
+        TOP = BOOL_VAL(isFalsey(TOP));
+        DISPATCH();
+//< Optimization omit
 //< Types of Values op-not
 //> Types of Values op-negate
+/* Types of Values op-negate < Optimization omit
       case OP_NEGATE:
         if (!IS_NUMBER(peek(0))) {
           runtimeError("Operand must be a number.");
@@ -700,8 +2133,19 @@ static InterpretResult run() {
 
         push(NUMBER_VAL(-AS_NUMBER(pop())));
         break;
+*/
+//> Optimization omit
+      CASE(OP_NEGATE):
+        if (!IS_NUMBER(PEEK(0))) {
+          RUNTIME_ERROR("Operand must be a number.");
+        }
+
+        TOP = NUMBER_VAL(-AS_NUMBER(TOP));
+        DISPATCH();
+//< Optimization omit
 //< Types of Values op-negate
 //> Global Variables interpret-print
+/* Global Variables interpret-print < Optimization omit
 
       case OP_PRINT: {
         printValue(pop());
@@ -709,60 +2153,187 @@ static InterpretResult run() {
         break;
       }
 
+*/
+//> Optimization omit
+
+      CASE(OP_PRINT): {
+        printValue(POP());
+        printf("\n");
+        DISPATCH();
+      }
+//< Optimization omit
 //< Global Variables interpret-print
 //> Jumping Back and Forth op-jump
+/* Jumping Back and Forth op-jump < Optimization omit
       case OP_JUMP: {
         uint16_t offset = READ_SHORT();
+*/
+//> Optimization omit
+
+      CASE(OP_JUMP): {
+        uint16_t offset = READ_SHORT();
+        ip += offset;
+        DISPATCH();
+      }
+//< Optimization omit
 /* Jumping Back and Forth op-jump < Calls and Functions jump
         vm.ip += offset;
 */
 //> Calls and Functions jump
+/* Calls and Functions jump < Optimization omit
         frame->ip += offset;
+*/
 //< Calls and Functions jump
+/* Jumping Back and Forth op-jump < Optimization omit
         break;
       }
 
+*/
 //< Jumping Back and Forth op-jump
 //> Jumping Back and Forth op-jump-if-false
+/* Jumping Back and Forth op-jump-if-false < Optimization omit
       case OP_JUMP_IF_FALSE: {
         uint16_t offset = READ_SHORT();
+*/
+//> Optimization omit
+
+      CASE(OP_JUMP_IF_FALSE): {
+        uint16_t offset = READ_SHORT();
+        if (isFalsey(PEEK(0))) ip += offset;
+        DISPATCH();
+      }
+      CASE(OP_JUMP_IF_NOT_LESS):    JUMP_UNLESS(<); DISPATCH();
+      CASE(OP_JUMP_IF_NOT_GREATER): JUMP_UNLESS(>); DISPATCH();
+      CASE(OP_JUMP_IF_NOT_EQUAL): {
+        Value b = POP();
+        Value a = POP();
+        uint16_t offset = READ_SHORT();
+        if (!valuesEqual(a, b)) {
+          PUSH(BOOL_VAL(false));
+          ip += offset;
+        }
+        DISPATCH();
+      }
+//< Optimization omit
 /* Jumping Back and Forth op-jump-if-false < Calls and Functions jump-if-false
         if (isFalsey(peek(0))) vm.ip += offset;
 */
 //> Calls and Functions jump-if-false
+/* Calls and Functions jump-if-false < Optimization omit
         if (isFalsey(peek(0))) frame->ip += offset;
+*/
 //< Calls and Functions jump-if-false
+/* Jumping Back and Forth op-jump-if-false < Optimization omit
         break;
       }
+*/
 //< Jumping Back and Forth op-jump-if-false
 //> Jumping Back and Forth op-loop
+/* Jumping Back and Forth op-loop < Optimization omit
 
       case OP_LOOP: {
         uint16_t offset = READ_SHORT();
+*/
+//> Optimization omit
+
+      CASE(OP_LOOP): {
+        uint16_t offset = READ_SHORT();
+        uint8_t loopIndex = READ_BYTE();
+        ip -= offset;
+        if (loopIndex != LOOP_UNTRACKED) {
+          Loop* loop = &frame->closure->function->chunk.loops[loopIndex];
+          if (loop->optimized != NULL || ++loop->backEdges == loop->hotAt) {
+            STORE_FRAME();
+            if (!hotLoop(loop)) return INTERPRET_RUNTIME_ERROR;
+            LOAD_FRAME();
+          }
+        }
+        SYNC_TRACING();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+//< Optimization omit
 /* Jumping Back and Forth op-loop < Calls and Functions loop
         vm.ip -= offset;
 */
 //> Calls and Functions loop
+/* Calls and Functions loop < Optimization omit
         frame->ip -= offset;
+*/
 //< Calls and Functions loop
+/* Jumping Back and Forth op-loop < Optimization omit
         break;
       }
+*/
 //< Jumping Back and Forth op-loop
 //> Calls and Functions interpret-call
+/* Calls and Functions interpret-call < Optimization omit
 
       case OP_CALL: {
         int argCount = READ_BYTE();
         if (!callValue(peek(argCount), argCount)) {
           return INTERPRET_RUNTIME_ERROR;
         }
+*/
+//> Optimization omit
+
+      CASE(OP_CALL): {
+        int argCount = READ_BYTE();
+        if (IS_NATIVE(PEEK(argCount))) {
+          CALL_NATIVE(argCount);
+          SPEND_BUDGET();
+          DISPATCH();
+        }
+        STORE_FRAME();
+        if (!callValue(PEEK(argCount), argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(OP_CALL_GLOBAL): {
+        int argCount = READ_BYTE();
+        CallCache* cache = frameCallCache(frame, READ_BYTE());
+        if (IS_NATIVE(PEEK(argCount))) {
+          CALL_NATIVE(argCount);
+          SPEND_BUDGET();
+          DISPATCH();
+        }
+        STORE_FRAME();
+        if (!callGlobal(cache, PEEK(argCount), argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(OP_TAIL_CALL): {
+        int argCount = READ_BYTE();
+        STORE_FRAME();
+        if (!tailCallValue(PEEK(argCount), argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+//< Optimization omit
 //> update-frame-after-call
+/* Calls and Functions update-frame-after-call < Optimization omit
         frame = &vm.frames[vm.frameCount - 1];
+*/
 //< update-frame-after-call
+/* Calls and Functions interpret-call < Optimization omit
         break;
       }
 
+*/
 //< Calls and Functions interpret-call
 //> Methods and Initializers interpret-invoke
+/* Methods and Initializers interpret-invoke < Optimization omit
       case OP_INVOKE: {
         ObjString* method = READ_STRING();
         int argCount = READ_BYTE();
@@ -773,8 +2344,25 @@ static InterpretResult run() {
         break;
       }
       
+*/
+//> Optimization omit
+
+      CASE(OP_INVOKE): {
+        ObjString* method = READ_STRING();
+        int argCount = READ_BYTE();
+        InvokeCache* cache = frameInvokeCache(frame, READ_BYTE());
+        STORE_FRAME();
+        if (!invokeCached(cache, method, argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+//< Optimization omit
 //< Methods and Initializers interpret-invoke
 //> Superclasses interpret-super-invoke
+/* Superclasses interpret-super-invoke < Optimization omit
       case OP_SUPER_INVOKE: {
         ObjString* method = READ_STRING();
         int argCount = READ_BYTE();
@@ -786,13 +2374,60 @@ static InterpretResult run() {
         break;
       }
 
+*/
+//> Optimization omit
+
+      CASE(OP_SUPER_INVOKE): {
+        ObjString* method = READ_STRING();
+        int argCount = READ_BYTE();
+        InvokeCache* cache = frameInvokeCache(frame, READ_BYTE());
+        ObjClass* superclass = AS_CLASS(POP());
+        STORE_FRAME();
+        if (!superInvokeCached(cache, superclass, method, argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+//< Optimization omit
 //< Superclasses interpret-super-invoke
 //> Closures interpret-closure
+/* Closures interpret-closure < Optimization omit
       case OP_CLOSURE: {
         ObjFunction* function = AS_FUNCTION(READ_CONSTANT());
         ObjClosure* closure = newClosure(function);
         push(OBJ_VAL(closure));
+*/
+//> Optimization omit
+
+      CASE(OP_CLOSURE): {
+        ObjFunction* function = AS_FUNCTION(READ_CONSTANT());
+        STORE_STACK();
+        ObjClosure* closure = newClosure(function);
+        PUSH(OBJ_VAL(closure));
+        STORE_STACK();
+        for (int i = 0; i < closure->upvalueCount; i++) {
+          uint8_t isLocal = READ_BYTE();
+          uint8_t index = READ_BYTE();
+          if (isLocal) {
+            closure->upvalues[i] = captureLocal(closure, i, slots + index);
+          } else {
+            closure->upvalues[i] =
+                inheritUpvalue(closure, frame->closure, index);
+          }
+        }
+        for (int i = 0; i < closure->captureCount; i++) {
+          uint8_t isLocal = READ_BYTE();
+          uint8_t index = READ_BYTE();
+          closure->captures[i] = isLocal ? slots[index]
+                                         : frame->closure->captures[index];
+        }
+        DISPATCH();
+      }
+//< Optimization omit
 //> interpret-capture-upvalues
+/* Closures interpret-capture-upvalues < Optimization omit
         for (int i = 0; i < closure->upvalueCount; i++) {
           uint8_t isLocal = READ_BYTE();
           uint8_t index = READ_BYTE();
@@ -802,19 +2437,54 @@ static InterpretResult run() {
             closure->upvalues[i] = frame->closure->upvalues[index];
           }
         }
+*/
 //< interpret-capture-upvalues
+/* Closures interpret-closure < Optimization omit
         break;
       }
 
+*/
 //< Closures interpret-closure
 //> Closures interpret-close-upvalue
+/* Closures interpret-close-upvalue < Optimization omit
       case OP_CLOSE_UPVALUE:
         closeUpvalues(vm.stackTop - 1);
         pop();
         break;
 
+*/
+//> Optimization omit
+
+      CASE(OP_CLOSE_UPVALUE):
+        STORE_STACK();
+        closeUpvalues(vm.stackTop - 1);
+        DROP();
+        DISPATCH();
+//< Optimization omit
 //< Closures interpret-close-upvalue
+/* A Virtual Machine run < Optimization omit
       case OP_RETURN: {
+*/
+//> Optimization omit
+
+      CASE(OP_RETURN): {
+        Value result = POP();
+
+        closeUpvalues(slots);
+
+        vm.frameCount--;
+        if (vm.frameCount == 0) {
+          STORE_STACK();
+          pop();
+          return INTERPRET_OK;
+        }
+
+        dropSlots(slots);
+        push(result);
+        LOAD_FRAME();
+        DISPATCH();
+      }
+//< Optimization omit
 /* Global Variables op-return < Calls and Functions interpret-return
         // Exit interpreter.
 */
@@ -826,11 +2496,16 @@ static InterpretResult run() {
         return INTERPRET_OK;
 */
 //> Calls and Functions interpret-return
+/* Calls and Functions interpret-return < Optimization omit
         Value result = pop();
+*/
 //> Closures return-close-upvalues
+/* Closures return-close-upvalues < Optimization omit
 
         closeUpvalues(frame->slots);
+*/
 //< Closures return-close-upvalues
+/* Calls and Functions interpret-return < Optimization omit
 
         vm.frameCount--;
         if (vm.frameCount == 0) {
@@ -843,37 +2518,97 @@ static InterpretResult run() {
 
         frame = &vm.frames[vm.frameCount - 1];
         break;
+*/
 //< Calls and Functions interpret-return
+/* A Virtual Machine run < Optimization omit
       }
+*/
 //> Classes and Instances interpret-class
+/* Classes and Instances interpret-class < Optimization omit
 
       case OP_CLASS:
         push(OBJ_VAL(newClass(READ_STRING())));
         break;
+*/
+//> Optimization omit
+
+      CASE(OP_CLASS):
+        STORE_STACK();
+        PUSH(OBJ_VAL(newClass(READ_STRING())));
+        DISPATCH();
+//< Optimization omit
 //< Classes and Instances interpret-class
 //> Superclasses interpret-inherit
+/* Superclasses interpret-inherit < Optimization omit
 
       case OP_INHERIT: {
         Value superclass = peek(1);
+*/
+//> Optimization omit
+
+      CASE(OP_INHERIT): {
+        Value superclass = PEEK(1);
+        if (!IS_CLASS(superclass)) {
+          RUNTIME_ERROR("Superclass must be a class.");
+        }
+
+        ObjClass* subclass = AS_CLASS(PEEK(0));
+        STORE_STACK();
+        inheritMethods(AS_CLASS(superclass), subclass);
+        DROP(); // Subclass.
+        DISPATCH();
+      }
+//< Optimization omit
 //> inherit-non-class
+/* Superclasses inherit-non-class < Optimization omit
         if (!IS_CLASS(superclass)) {
           runtimeError("Superclass must be a class.");
           return INTERPRET_RUNTIME_ERROR;
         }
 
+*/
 //< inherit-non-class
+/* Superclasses interpret-inherit < Optimization omit
         ObjClass* subclass = AS_CLASS(peek(0));
         tableAddAll(&AS_CLASS(superclass)->methods, &subclass->methods);
         pop(); // Subclass.
         break;
       }
+*/
 //< Superclasses interpret-inherit
 //> Methods and Initializers interpret-method
+/* Methods and Initializers interpret-method < Optimization omit
 
       case OP_METHOD:
         defineMethod(READ_STRING());
         break;
+*/
+//> Optimization omit
+
+      CASE(OP_METHOD):
+        STORE_STACK();
+        defineMethod(READ_STRING());
+        LOAD_STACK();
+        DISPATCH();
+//< Optimization omit
 //< Methods and Initializers interpret-method
+//> Optimization omit
+
+      TRACE_CASE: {
+        ip--;
+        TRACE_INSTRUCTION();
+#if defined(DISPATCH_THREADED)
+        uint8_t opcode = frame->closure->function->chunk.code[
+            ip++ - CODE_START()];
+        goto *dispatchTable[opcode];
+#elif defined(DISPATCH_COMPUTED_GOTO)
+        goto *dispatchTable[READ_BYTE()];
+#else
+        instruction = READ_BYTE();
+        goto dispatchInstruction;
+#endif
+      }
+//< Optimization omit
     }
   }
 
@@ -890,6 +2625,35 @@ static InterpretResult run() {
 //> undef-binary-op
 #undef BINARY_OP
 //< undef-binary-op
+//> Optimization omit
+#undef CODE_START
+#undef STORE_IP
+#undef LOAD_IP
+#undef STORE_STACK
+#undef LOAD_STACK
+#undef STORE_FRAME
+#undef LOAD_FRAME
+#undef LEAVE_IF_REGISTER_FRAME
+#undef RUN_COMPILED_FRAMES
+#undef SYNC_TRACING
+#undef PUSH
+#undef POP
+#undef DROP
+#undef TOP
+#undef PEEK
+#undef SPILL_ARGS
+#undef DROP_ARGS
+#undef CALL_NATIVE
+#undef SPEND_BUDGET
+#undef QUICKEN
+#undef RUNTIME_ERROR
+#undef JUMP_UNLESS
+#undef TRACE_INSTRUCTION
+#undef INTERPRET_LOOP
+#undef CASE
+#undef TRACE_CASE
+#undef DISPATCH
+//< Optimization omit
 }
 //< run
 //> omit
@@ -900,6 +2664,857 @@ void hack(bool b) {
   if (b) hack(false);
 }
 //< omit
+//> Optimization omit
+#if defined(BASELINE_JIT) || defined(AOT_RUNTIME)
+// The helpers compiled code calls, declared in jit.h. Each does what run()
+// does for its instruction, operating on vm.stackTop and the frame on top
+// of the call stack. Those that can fail report the runtime error and
+// return false.
+
+// Compiled code stores the frame's ip before calling a helper, so the
+// index of the instruction's inline cache is the operand just behind it.
+static InvokeCache* siteInvokeCache() {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  return frameInvokeCache(frame, frame->ip[-1]);
+}
+
+static CallCache* siteCallCache() {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  return frameCallCache(frame, frame->ip[-1]);
+}
+
+static PropertyCache* sitePropertyCache() {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  return framePropertyCache(frame, frame->ip[-1]);
+}
+
+bool jitGetGlobal(int slot) {
+  Value value = vm.globalValues.values[slot];
+  if (IS_UNDEFINED(value)) {
+    runtimeError("Undefined variable '%s'.", globalName(slot)->chars);
+    return false;
+  }
+  push(value);
+  return true;
+}
+
+void jitDefineGlobal(int slot) {
+  vm.globalValues.values[slot] = pop();
+}
+
+bool jitSetGlobal(int slot) {
+  if (IS_UNDEFINED(vm.globalValues.values[slot])) {
+    runtimeError("Undefined variable '%s'.", globalName(slot)->chars);
+    return false;
+  }
+  vm.globalValues.values[slot] = peek(0);
+  return true;
+}
+
+bool jitGetProperty(ObjString* name) {
+  if (!IS_INSTANCE(peek(0))) {
+    runtimeError("Only instances have properties.");
+    return false;
+  }
+
+  ObjInstance* instance = AS_INSTANCE(peek(0));
+  Value value;
+  if (getField(sitePropertyCache(), instance, name, &value)) {
+    vm.stackTop[-1] = value; // Replace the instance.
+    return true;
+  }
+
+  return bindMethod(instance->klass, name);
+}
+
+bool jitSetProperty(ObjString* name) {
+  if (!IS_INSTANCE(peek(1))) {
+    runtimeError("Only instances have fields.");
+    return false;
+  }
+
+  ObjInstance* instance = AS_INSTANCE(peek(1));
+  setField(sitePropertyCache(), instance, name, peek(0));
+  Value value = pop();
+  vm.stackTop[-1] = value; // Replace the instance.
+  return true;
+}
+
+bool jitGetSuper(ObjString* name) {
+  ObjClass* superclass = AS_CLASS(pop());
+  return bindMethod(superclass, name);
+}
+
+// Compiled code handles numbers itself, so this is mostly here for adding
+// strings and reporting errors.
+bool jitBinaryOp(int instruction) {
+  Value b = peek(0);
+  Value a = peek(1);
+  if (instruction == OP_ADD && IS_STRING(a) && IS_STRING(b)) {
+    concatenate();
+    return true;
+  }
+
+  if (!IS_NUMBER(a) || !IS_NUMBER(b)) {
+    runtimeError(instruction == OP_ADD
+        ? "Operands must be two numbers or two strings."
+        : "Operands must be numbers.");
+    return false;
+  }
+
+  Value result;
+  switch (instruction) {
+    case OP_GREATER:
+      result = BOOL_VAL(AS_NUMBER(a) > AS_NUMBER(b));
+      break;
+    case OP_LESS:
+      result = BOOL_VAL(AS_NUMBER(a) < AS_NUMBER(b));
+      break;
+    case OP_ADD:
+      result = NUMBER_VAL(AS_NUMBER(a) + AS_NUMBER(b));
+      break;
+    case OP_SUBTRACT:
+      result = NUMBER_VAL(AS_NUMBER(a) - AS_NUMBER(b));
+      break;
+    case OP_MULTIPLY:
+      result = NUMBER_VAL(AS_NUMBER(a) * AS_NUMBER(b));
+      break;
+    default:
+      result = NUMBER_VAL(AS_NUMBER(a) / AS_NUMBER(b));
+      break;
+  }
+
+  vm.stackTop -= 2;
+  push(result);
+  return true;
+}
+
+bool jitNegate() {
+  if (!IS_NUMBER(peek(0))) {
+    runtimeError("Operand must be a number.");
+    return false;
+  }
+
+  push(NUMBER_VAL(-AS_NUMBER(pop())));
+  return true;
+}
+
+void jitPrint() {
+  printValue(pop());
+  printf("\n");
+}
+
+#ifdef BASELINE_JIT
+// Tells compiled code whether a call left a new frame to run. A callee that
+// has been compiled is run right here, so that calls between compiled
+// functions don't have to go back through run(). Only the first FRAMES_MAX
+// frames do that, though, since maxFrames can be more than the C stack has
+// room for.
+static int callResult(bool success, int frameCount) {
+  if (!success) return JIT_CALL_ERROR;
+  if (vm.frameCount == frameCount) return JIT_CALL_RETURNED;
+
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  if (vm.frameCount > FRAMES_MAX || jitEntry(frame) == NULL) {
+    return JIT_CALL_ENTERED;
+  }
+  InterpretResult result = jitRun(frame);
+  if (result == INTERPRET_SUSPENDED) return JIT_CALL_SUSPENDED;
+  if (result != INTERPRET_OK) return JIT_CALL_ERROR;
+
+  // The callee may have called something the interpreter has to run.
+  return vm.frameCount > frameCount ? JIT_CALL_ENTERED : JIT_CALL_RETURNED;
+}
+
+int jitCall(int argCount) {
+  int frameCount = vm.frameCount;
+  return callResult(callValue(peek(argCount), argCount), frameCount);
+}
+
+int jitCallGlobal(int argCount) {
+  int frameCount = vm.frameCount;
+  CallCache* cache = siteCallCache();
+  return callResult(callGlobal(cache, peek(argCount), argCount), frameCount);
+}
+
+int jitInvoke(ObjString* name, int argCount) {
+  int frameCount = vm.frameCount;
+  InvokeCache* cache = siteInvokeCache();
+  return callResult(invokeCached(cache, name, argCount), frameCount);
+}
+
+int jitSuperInvoke(ObjString* name, int argCount) {
+  int frameCount = vm.frameCount;
+  InvokeCache* cache = siteInvokeCache();
+  ObjClass* superclass = AS_CLASS(pop());
+  return callResult(superInvokeCached(cache, superclass, name, argCount),
+                    frameCount);
+}
+
+// A callee that took over the caller's frame starts that frame over at its
+// own code, which run() picks up from there. The caller's compiled code is
+// done with the frame either way.
+int jitTailCall(int argCount) {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  uint8_t* ip = frame->ip;
+  if (!tailCallValue(peek(argCount), argCount)) return JIT_CALL_ERROR;
+  return frame->ip == ip ? JIT_CALL_RETURNED : JIT_CALL_ENTERED;
+}
+
+InterpretResult jitBudget() {
+  return budgetExhausted();
+}
+#endif
+#ifdef AOT_RUNTIME
+// Code compiled ahead of time calls these instead. Every function has been
+// compiled, so the callee's C function runs right away, nested on the C
+// stack as deeply as the call frames are.
+static bool runCallee(bool success, int frameCount) {
+  if (!success) return false;
+
+  // A function that tail calls returns early, leaving its frame to the
+  // callee, which runs next.
+  while (vm.frameCount > frameCount) {
+    if (!FRAME_AT(vm.frameCount - 1)->closure->function->aotCode()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool aotCall(int argCount) {
+  int frameCount = vm.frameCount;
+  return runCallee(callValue(peek(argCount), argCount), frameCount);
+}
+
+bool aotCallGlobal(int argCount) {
+  int frameCount = vm.frameCount;
+  CallCache* cache = siteCallCache();
+  return runCallee(callGlobal(cache, peek(argCount), argCount), frameCount);
+}
+
+bool aotInvoke(ObjString* name, int argCount) {
+  int frameCount = vm.frameCount;
+  InvokeCache* cache = siteInvokeCache();
+  return runCallee(invokeCached(cache, name, argCount), frameCount);
+}
+
+bool aotSuperInvoke(ObjString* name, int argCount) {
+  int frameCount = vm.frameCount;
+  InvokeCache* cache = siteInvokeCache();
+  ObjClass* superclass = AS_CLASS(pop());
+  return runCallee(superInvokeCached(cache, superclass, name, argCount),
+                   frameCount);
+}
+
+bool aotTailCall(int argCount) {
+  return tailCallValue(peek(argCount), argCount);
+}
+
+// Runs the top-level code of a program compiled ahead of time, as
+// interpret() would run it in the interpreter.
+InterpretResult aotInterpret(ObjFunction* function) {
+  push(OBJ_VAL(function));
+  ObjClosure* closure = newClosure(function);
+  pop();
+  push(OBJ_VAL(closure));
+  return aotCall(0) ? INTERPRET_OK : INTERPRET_RUNTIME_ERROR;
+}
+#endif
+
+// [upvalues] points to the OP_CLOSURE instruction's (isLocal, index) pairs.
+void jitClosure(ObjFunction* function, uint8_t* upvalues) {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  ObjClosure* closure = newClosure(function);
+  push(OBJ_VAL(closure));
+  for (int i = 0; i < closure->upvalueCount; i++) {
+    uint8_t isLocal = upvalues[i * 2];
+    uint8_t index = upvalues[i * 2 + 1];
+    if (isLocal) {
+      closure->upvalues[i] = captureLocal(closure, i, frame->slots + index);
+    } else {
+      closure->upvalues[i] = inheritUpvalue(closure, frame->closure, index);
+    }
+  }
+
+  upvalues += closure->upvalueCount * 2;
+  for (int i = 0; i < closure->captureCount; i++) {
+    uint8_t isLocal = upvalues[i * 2];
+    uint8_t index = upvalues[i * 2 + 1];
+    closure->captures[i] = isLocal ? frame->slots[index]
+                                   : frame->closure->captures[index];
+  }
+}
+
+void jitCloseUpvalue() {
+  closeUpvalues(vm.stackTop - 1);
+  pop();
+}
+
+void jitReturn() {
+  CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+  Value result = pop();
+  closeUpvalues(frame->slots);
+
+  vm.frameCount--;
+  if (vm.frameCount == 0) {
+    pop();
+    return;
+  }
+
+  dropSlots(frame->slots);
+  push(result);
+}
+
+void jitClass(ObjString* name) {
+  push(OBJ_VAL(newClass(name)));
+}
+
+bool jitInherit() {
+  Value superclass = peek(1);
+  if (!IS_CLASS(superclass)) {
+    runtimeError("Superclass must be a class.");
+    return false;
+  }
+
+  ObjClass* subclass = AS_CLASS(peek(0));
+  inheritMethods(AS_CLASS(superclass), subclass);
+  pop(); // Subclass.
+  return true;
+}
+
+void jitMethod(ObjString* name) {
+  defineMethod(name);
+}
+#endif
+#ifdef TRACE_JIT
+// The trace recorder makes calls with these instead of jitCall() and its
+// friends, since it steps into the callee instead of running it.
+bool traceCall(int argCount) {
+  return callValue(peek(argCount), argCount);
+}
+
+bool traceInvoke(ObjString* name, int argCount) {
+  return invoke(name, argCount);
+}
+
+bool traceSuperInvoke(ObjString* name, int argCount) {
+  ObjClass* superclass = AS_CLASS(pop());
+  return invokeFromClass(superclass, name, argCount);
+}
+
+// Replaces the class being called with a new instance of it, for a trace
+// that runs the class's initializer inline.
+void traceInstantiate(int argCount) {
+  ObjClass* klass = AS_CLASS(peek(argCount));
+  vm.stackTop[-argCount - 1] = OBJ_VAL(newInstance(klass));
+}
+#endif
+//< Optimization omit
+//> Optimization omit
+#ifdef REGISTER_VM
+// Runs register code for the frame on top of the call stack and whatever it
+// calls, until the outermost frame returns, a runtime error occurs, or the
+// frame on top is one that only has stack bytecode. interpret() then hands
+// that frame to run(), which hands frames back the same way.
+//
+// A register frame's registers are its stack slots, and vm.stackTop sits
+// just past the last one so that anything pushed by the helpers shared with
+// run(), and the window the GC marks, both cover them. Calls set vm.stackTop
+// to just past the arguments, as the stack VM would have it, since that is
+// where callValue() expects it.
+static InterpretResult runRegisters() {
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+  static void* dispatchTable[] = {
+    [REG_MOVE]                  = &&code_REG_MOVE,
+    [REG_LOAD_CONSTANT]         = &&code_REG_LOAD_CONSTANT,
+    [REG_LOAD_NIL]              = &&code_REG_LOAD_NIL,
+    [REG_LOAD_TRUE]             = &&code_REG_LOAD_TRUE,
+    [REG_LOAD_FALSE]            = &&code_REG_LOAD_FALSE,
+    [REG_GET_GLOBAL]            = &&code_REG_GET_GLOBAL,
+    [REG_DEFINE_GLOBAL]         = &&code_REG_DEFINE_GLOBAL,
+    [REG_SET_GLOBAL]            = &&code_REG_SET_GLOBAL,
+    [REG_GET_UPVALUE]           = &&code_REG_GET_UPVALUE,
+    [REG_SET_UPVALUE]           = &&code_REG_SET_UPVALUE,
+    [REG_GET_CAPTURE]           = &&code_REG_GET_CAPTURE,
+    [REG_GET_PROPERTY]          = &&code_REG_GET_PROPERTY,
+    [REG_SET_PROPERTY]          = &&code_REG_SET_PROPERTY,
+    [REG_GET_SUPER]             = &&code_REG_GET_SUPER,
+    [REG_EQUAL]                 = &&code_REG_EQUAL,
+    [REG_GREATER]               = &&code_REG_GREATER,
+    [REG_LESS]                  = &&code_REG_LESS,
+    [REG_ADD]                   = &&code_REG_ADD,
+    [REG_SUBTRACT]              = &&code_REG_SUBTRACT,
+    [REG_MULTIPLY]              = &&code_REG_MULTIPLY,
+    [REG_DIVIDE]                = &&code_REG_DIVIDE,
+    [REG_EQUAL_K]               = &&code_REG_EQUAL_K,
+    [REG_GREATER_K]             = &&code_REG_GREATER_K,
+    [REG_LESS_K]                = &&code_REG_LESS_K,
+    [REG_ADD_K]                 = &&code_REG_ADD_K,
+    [REG_SUBTRACT_K]            = &&code_REG_SUBTRACT_K,
+    [REG_MULTIPLY_K]            = &&code_REG_MULTIPLY_K,
+    [REG_DIVIDE_K]              = &&code_REG_DIVIDE_K,
+    [REG_NOT]                   = &&code_REG_NOT,
+    [REG_NEGATE]                = &&code_REG_NEGATE,
+    [REG_PRINT]                 = &&code_REG_PRINT,
+    [REG_JUMP]                  = &&code_REG_JUMP,
+    [REG_JUMP_IF_FALSE]         = &&code_REG_JUMP_IF_FALSE,
+    [REG_JUMP_IF_NOT_LESS]      = &&code_REG_JUMP_IF_NOT_LESS,
+    [REG_JUMP_IF_NOT_GREATER]   = &&code_REG_JUMP_IF_NOT_GREATER,
+    [REG_JUMP_IF_NOT_EQUAL]     = &&code_REG_JUMP_IF_NOT_EQUAL,
+    [REG_JUMP_IF_NOT_LESS_K]    = &&code_REG_JUMP_IF_NOT_LESS_K,
+    [REG_JUMP_IF_NOT_GREATER_K] = &&code_REG_JUMP_IF_NOT_GREATER_K,
+    [REG_JUMP_IF_NOT_EQUAL_K]   = &&code_REG_JUMP_IF_NOT_EQUAL_K,
+    [REG_CALL]                  = &&code_REG_CALL,
+    [REG_TAIL_CALL]             = &&code_REG_TAIL_CALL,
+    [REG_INVOKE]                = &&code_REG_INVOKE,
+    [REG_SUPER_INVOKE]          = &&code_REG_SUPER_INVOKE,
+    [REG_CLOSURE]               = &&code_REG_CLOSURE,
+    [REG_CLOSE_UPVALUE]         = &&code_REG_CLOSE_UPVALUE,
+    [REG_RETURN]                = &&code_REG_RETURN,
+    [REG_CLASS]                 = &&code_REG_CLASS,
+    [REG_INHERIT]               = &&code_REG_INHERIT,
+    [REG_METHOD]                = &&code_REG_METHOD,
+  };
+
+  static void* traceTable[] = {
+    [0 ... sizeof(dispatchTable) / sizeof(void*) - 1] = &&traceInstruction
+  };
+  void** table = dispatchTable;
+#else
+  int opcode;
+  int traceBit = 0;
+#endif
+
+  CallFrame* frame;
+  Instruction* ip;
+  Instruction instruction;
+  Value* slots;
+  Value* constants;
+
+  // As in run(), tracing swaps the dispatch table or sets traceBit.
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+#define SYNC_TRACING() \
+    (table = vm.traceExecution ? traceTable : dispatchTable)
+#else
+#define SYNC_TRACING() (traceBit = vm.traceExecution ? 0x80 : 0)
+#endif
+
+#define STORE_IP() (frame->registerIp = ip)
+#define LOAD_FRAME() \
+    do { \
+      frame = FRAME_AT(vm.frameCount - 1); \
+      RegisterChunk* registers = frame->closure->function->chunk.registers; \
+      if (registers == NULL) return INTERPRET_OK; \
+      SYNC_TRACING(); \
+      ip = frame->registerIp; \
+      slots = frame->slots; \
+      constants = frame->closure->function->chunk.constants.values; \
+      vm.stackTop = slots + registers->registerCount; \
+    } while (false)
+
+#define RA (slots[REG_A(instruction)])
+#define RB (slots[REG_B(instruction)])
+#define RC (slots[REG_C(instruction)])
+#define KB (constants[REG_B(instruction)])
+#define KC (constants[REG_C(instruction)])
+#define READ_JUMP() ((int32_t)*ip++)
+
+#define RUNTIME_ERROR(...) \
+    do { \
+      STORE_IP(); \
+      runtimeError(__VA_ARGS__); \
+      return INTERPRET_RUNTIME_ERROR; \
+    } while (false)
+
+  // As in run(), after backward jumps and calls.
+#define SPEND_BUDGET() \
+    do { \
+      if (--vm.budget <= 0) { \
+        STORE_IP(); \
+        InterpretResult result = budgetExhausted(); \
+        if (result != INTERPRET_OK) return result; \
+      } \
+    } while (false)
+
+  // The operands are copied out first since A is often the same register
+  // as B.
+#define BINARY_OP(valueType, op, right) \
+    do { \
+      Value a = RB; \
+      Value b = (right); \
+      if (!IS_NUMBER(a) || !IS_NUMBER(b)) { \
+        RUNTIME_ERROR("Operands must be numbers."); \
+      } \
+      RA = valueType(AS_NUMBER(a) op AS_NUMBER(b)); \
+    } while (false)
+#define ADD(right) \
+    do { \
+      Value a = RB; \
+      Value b = (right); \
+      if (IS_NUMBER(a) && IS_NUMBER(b)) { \
+        RA = NUMBER_VAL(AS_NUMBER(a) + AS_NUMBER(b)); \
+      } else if (IS_STRING(a) && IS_STRING(b)) { \
+        push(a); \
+        push(b); \
+        concatenate(); \
+        RA = pop(); \
+      } else { \
+        RUNTIME_ERROR("Operands must be two numbers or two strings."); \
+      } \
+    } while (false)
+#define JUMP_UNLESS(op, right) \
+    do { \
+      Value a = RB; \
+      Value b = (right); \
+      if (!IS_NUMBER(a) || !IS_NUMBER(b)) { \
+        RUNTIME_ERROR("Operands must be numbers."); \
+      } \
+      int32_t offset = READ_JUMP(); \
+      if (!(AS_NUMBER(a) op AS_NUMBER(b))) { \
+        RA = BOOL_VAL(false); \
+        ip += offset; \
+      } \
+    } while (false)
+#define JUMP_UNLESS_EQUAL(right) \
+    do { \
+      Value a = RB; \
+      Value b = (right); \
+      int32_t offset = READ_JUMP(); \
+      if (!valuesEqual(a, b)) { \
+        RA = BOOL_VAL(false); \
+        ip += offset; \
+      } \
+    } while (false)
+
+#define TRACE_INSTRUCTION() \
+    do { \
+      printf("          "); \
+      printStack(vm.stackSegment, vm.stackTop); \
+      printf("\n"); \
+      disassembleRegisterInstruction(&frame->closure->function->chunk, \
+          (int)(ip - frame->closure->function->chunk.registers->code)); \
+    } while (false)
+
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+#define INTERPRET_LOOP DISPATCH();
+#define CASE(name) code_##name
+#define TRACE_CASE traceInstruction
+#define DISPATCH() \
+    do { \
+      instruction = *ip++; \
+      goto *table[REG_OP(instruction)]; \
+    } while (false)
+#else
+#define INTERPRET_LOOP \
+    instruction = *ip++; \
+    opcode = REG_OP(instruction) | traceBit; \
+  dispatchInstruction: \
+    switch (opcode)
+#define CASE(name) case name
+#define TRACE_CASE default
+#define DISPATCH() continue
+#endif
+
+  LOAD_FRAME();
+
+  for (;;) {
+    INTERPRET_LOOP {
+      CASE(REG_MOVE):          RA = RB; DISPATCH();
+      CASE(REG_LOAD_CONSTANT): RA = KB; DISPATCH();
+      CASE(REG_LOAD_NIL):      RA = NIL_VAL; DISPATCH();
+      CASE(REG_LOAD_TRUE):     RA = BOOL_VAL(true); DISPATCH();
+      CASE(REG_LOAD_FALSE):    RA = BOOL_VAL(false); DISPATCH();
+
+      CASE(REG_GET_GLOBAL): {
+        Value value = vm.globalValues.values[REG_BC(instruction)];
+        if (IS_UNDEFINED(value)) {
+          RUNTIME_ERROR("Undefined variable '%s'.",
+                        globalName(REG_BC(instruction))->chars);
+        }
+        RA = value;
+        DISPATCH();
+      }
+
+      CASE(REG_DEFINE_GLOBAL):
+        vm.globalValues.values[REG_BC(instruction)] = RA;
+        DISPATCH();
+
+      CASE(REG_SET_GLOBAL): {
+        if (IS_UNDEFINED(vm.globalValues.values[REG_BC(instruction)])) {
+          RUNTIME_ERROR("Undefined variable '%s'.",
+                        globalName(REG_BC(instruction))->chars);
+        }
+        vm.globalValues.values[REG_BC(instruction)] = RA;
+        DISPATCH();
+      }
+
+      CASE(REG_GET_UPVALUE):
+        RA = *frame->closure->upvalues[REG_B(instruction)]->location;
+        DISPATCH();
+
+      CASE(REG_SET_UPVALUE):
+        *frame->closure->upvalues[REG_B(instruction)]->location = RA;
+        DISPATCH();
+
+      CASE(REG_GET_CAPTURE):
+        RA = frame->closure->captures[REG_B(instruction)];
+        DISPATCH();
+
+      CASE(REG_GET_PROPERTY): {
+        Value receiver = RB;
+        PropertyCache* cache = framePropertyCache(frame, *ip++);
+        if (!IS_INSTANCE(receiver)) {
+          RUNTIME_ERROR("Only instances have properties.");
+        }
+
+        ObjInstance* instance = AS_INSTANCE(receiver);
+        ObjString* name = AS_STRING(KC);
+        Value value;
+        if (getField(cache, instance, name, &value)) {
+          RA = value;
+          DISPATCH();
+        }
+
+        STORE_IP();
+        push(receiver);
+        if (!bindMethod(instance->klass, name)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        RA = pop();
+        DISPATCH();
+      }
+
+      CASE(REG_SET_PROPERTY): {
+        if (!IS_INSTANCE(RA)) {
+          RUNTIME_ERROR("Only instances have fields.");
+        }
+
+        Value value = RC;
+        setField(framePropertyCache(frame, *ip++), AS_INSTANCE(RA),
+                 AS_STRING(KB), value);
+        RA = value;
+        DISPATCH();
+      }
+
+      CASE(REG_GET_SUPER): {
+        ObjClass* superclass = AS_CLASS(RB);
+        STORE_IP();
+        push(RA);
+        if (!bindMethod(superclass, AS_STRING(KC))) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        RA = pop();
+        DISPATCH();
+      }
+
+      CASE(REG_EQUAL):   RA = BOOL_VAL(valuesEqual(RB, RC)); DISPATCH();
+      CASE(REG_EQUAL_K): RA = BOOL_VAL(valuesEqual(RB, KC)); DISPATCH();
+      CASE(REG_GREATER):    BINARY_OP(BOOL_VAL, >, RC); DISPATCH();
+      CASE(REG_GREATER_K):  BINARY_OP(BOOL_VAL, >, KC); DISPATCH();
+      CASE(REG_LESS):       BINARY_OP(BOOL_VAL, <, RC); DISPATCH();
+      CASE(REG_LESS_K):     BINARY_OP(BOOL_VAL, <, KC); DISPATCH();
+      CASE(REG_ADD):        ADD(RC); DISPATCH();
+      CASE(REG_ADD_K):      ADD(KC); DISPATCH();
+      CASE(REG_SUBTRACT):   BINARY_OP(NUMBER_VAL, -, RC); DISPATCH();
+      CASE(REG_SUBTRACT_K): BINARY_OP(NUMBER_VAL, -, KC); DISPATCH();
+      CASE(REG_MULTIPLY):   BINARY_OP(NUMBER_VAL, *, RC); DISPATCH();
+      CASE(REG_MULTIPLY_K): BINARY_OP(NUMBER_VAL, *, KC); DISPATCH();
+      CASE(REG_DIVIDE):     BINARY_OP(NUMBER_VAL, /, RC); DISPATCH();
+      CASE(REG_DIVIDE_K):   BINARY_OP(NUMBER_VAL, /, KC); DISPATCH();
+
+      CASE(REG_NOT):
+        RA = BOOL_VAL(isFalsey(RB));
+        DISPATCH();
+
+      CASE(REG_NEGATE):
+        if (!IS_NUMBER(RB)) {
+          RUNTIME_ERROR("Operand must be a number.");
+        }
+        RA = NUMBER_VAL(-AS_NUMBER(RB));
+        DISPATCH();
+
+      CASE(REG_PRINT):
+        printValue(RA);
+        printf("\n");
+        DISPATCH();
+
+      CASE(REG_JUMP): {
+        int32_t offset = READ_JUMP();
+        ip += offset;
+        if (offset < 0) {
+          uint8_t loopIndex = REG_A(instruction);
+          if (loopIndex != LOOP_UNTRACKED) {
+            Loop* loop = &frame->closure->function->chunk.loops[loopIndex];
+            if (loop->optimized != NULL || ++loop->backEdges == loop->hotAt) {
+              STORE_IP();
+              if (!hotLoop(loop)) return INTERPRET_RUNTIME_ERROR;
+              LOAD_FRAME();
+            }
+          }
+          SYNC_TRACING();
+          SPEND_BUDGET();
+        }
+        DISPATCH();
+      }
+
+      CASE(REG_JUMP_IF_FALSE): {
+        int32_t offset = READ_JUMP();
+        if (isFalsey(RA)) ip += offset;
+        DISPATCH();
+      }
+
+      CASE(REG_JUMP_IF_NOT_LESS):      JUMP_UNLESS(<, RC); DISPATCH();
+      CASE(REG_JUMP_IF_NOT_LESS_K):    JUMP_UNLESS(<, KC); DISPATCH();
+      CASE(REG_JUMP_IF_NOT_GREATER):   JUMP_UNLESS(>, RC); DISPATCH();
+      CASE(REG_JUMP_IF_NOT_GREATER_K): JUMP_UNLESS(>, KC); DISPATCH();
+      CASE(REG_JUMP_IF_NOT_EQUAL):     JUMP_UNLESS_EQUAL(RC); DISPATCH();
+      CASE(REG_JUMP_IF_NOT_EQUAL_K):   JUMP_UNLESS_EQUAL(KC); DISPATCH();
+
+      CASE(REG_CALL): {
+        int argCount = REG_B(instruction);
+        vm.stackTop = &RA + argCount + 1;
+        STORE_IP();
+        if (!callValue(RA, argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(REG_TAIL_CALL): {
+        int argCount = REG_B(instruction);
+        vm.stackTop = &RA + argCount + 1;
+        STORE_IP();
+        if (!tailCallValue(RA, argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(REG_INVOKE): {
+        int argCount = REG_C(instruction);
+        InvokeCache* cache = frameInvokeCache(frame, *ip++);
+        vm.stackTop = &RA + argCount + 1;
+        STORE_IP();
+        if (!invokeCached(cache, AS_STRING(KB), argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(REG_SUPER_INVOKE): {
+        int argCount = REG_C(instruction);
+        ObjClass* superclass = AS_CLASS((&RA)[argCount + 1]);
+        InvokeCache* cache = frameInvokeCache(frame, *ip++);
+        vm.stackTop = &RA + argCount + 1;
+        STORE_IP();
+        if (!superInvokeCached(cache, superclass, AS_STRING(KB), argCount)) {
+          return INTERPRET_RUNTIME_ERROR;
+        }
+        LOAD_FRAME();
+        SPEND_BUDGET();
+        DISPATCH();
+      }
+
+      CASE(REG_CLOSURE): {
+        ObjClosure* closure = newClosure(AS_FUNCTION(KB));
+        RA = OBJ_VAL(closure);
+        for (int i = 0; i < closure->upvalueCount; i++) {
+          Instruction upvalue = *ip++;
+          int index = upvalue >> 8;
+          if (upvalue & 0xff) {
+            closure->upvalues[i] = captureLocal(closure, i, slots + index);
+          } else {
+            closure->upvalues[i] =
+                inheritUpvalue(closure, frame->closure, index);
+          }
+        }
+        for (int i = 0; i < closure->captureCount; i++) {
+          Instruction capture = *ip++;
+          int index = capture >> 8;
+          closure->captures[i] = (capture & 0xff)
+              ? slots[index] : frame->closure->captures[index];
+        }
+        DISPATCH();
+      }
+
+      CASE(REG_CLOSE_UPVALUE):
+        closeUpvalues(&RA);
+        DISPATCH();
+
+      CASE(REG_RETURN): {
+        Value result = RA;
+        closeUpvalues(slots);
+        vm.frameCount--;
+        dropSlots(slots);
+        if (vm.frameCount == 0) return INTERPRET_OK;
+
+        push(result);
+        LOAD_FRAME();
+        DISPATCH();
+      }
+
+      CASE(REG_CLASS):
+        RA = OBJ_VAL(newClass(AS_STRING(KB)));
+        DISPATCH();
+
+      CASE(REG_INHERIT): {
+        Value superclass = RA;
+        if (!IS_CLASS(superclass)) {
+          RUNTIME_ERROR("Superclass must be a class.");
+        }
+        inheritMethods(AS_CLASS(superclass), AS_CLASS(RB));
+        DISPATCH();
+      }
+
+      CASE(REG_METHOD):
+        setMethod(AS_CLASS(RA), AS_STRING(KB), AS_CLOSURE(RC));
+        vm.methodEpoch++;
+        DISPATCH();
+
+      TRACE_CASE: {
+        ip--;
+        TRACE_INSTRUCTION();
+        ip++;
+#if defined(DISPATCH_COMPUTED_GOTO) || defined(DISPATCH_THREADED)
+        goto *dispatchTable[REG_OP(instruction)];
+#else
+        opcode = REG_OP(instruction);
+        goto dispatchInstruction;
+#endif
+      }
+    }
+  }
+
+#undef SYNC_TRACING
+#undef STORE_IP
+#undef LOAD_FRAME
+#undef RA
+#undef RB
+#undef RC
+#undef KB
+#undef KC
+#undef READ_JUMP
+#undef RUNTIME_ERROR
+#undef SPEND_BUDGET
+#undef BINARY_OP
+#undef ADD
+#undef JUMP_UNLESS
+#undef JUMP_UNLESS_EQUAL
+#undef TRACE_INSTRUCTION
+#undef INTERPRET_LOOP
+#undef CASE
+#undef TRACE_CASE
+#undef DISPATCH
+}
+#endif
+//< Optimization omit
 //> interpret
 /* A Virtual Machine interpret < Scanning on Demand vm-interpret-c
 InterpretResult interpret(Chunk* chunk) {
@@ -907,6 +3522,23 @@ InterpretResult interpret(Chunk* chunk) {
   vm.ip = vm.chunk->code;
   return run();
 */
+//> Optimization omit
+InterpretResult resumeVM() {
+#ifdef REGISTER_VM
+  // Each loop returns when the frame on top belongs to the other one.
+  InterpretResult result = INTERPRET_OK;
+  while (result == INTERPRET_OK && vm.frameCount > 0) {
+    CallFrame* frame = FRAME_AT(vm.frameCount - 1);
+    result = frame->closure->function->chunk.registers != NULL
+        ? runRegisters() : run();
+  }
+  return result;
+#else
+  return run();
+#endif
+}
+
+//< Optimization omit
 //> Scanning on Demand vm-interpret-c
 InterpretResult interpret(const char* source) {
 /* Scanning on Demand vm-interpret-c < Compiling Expressions interpret-chunk
@@ -928,6 +3560,11 @@ InterpretResult interpret(const char* source) {
 //> Calls and Functions interpret-stub
   ObjFunction* function = compile(source);
   if (function == NULL) return INTERPRET_COMPILE_ERROR;
+//> Optimization omit
+
+  // Abandon a script the budget hook suspended.
+  if (vm.frameCount > 0) resetStack();
+//< Optimization omit
 
   push(OBJ_VAL(function));
 //< Calls and Functions interpret-stub
@@ -955,9 +3592,17 @@ InterpretResult interpret(const char* source) {
   freeChunk(&chunk);
   return result;
 */
+//> Optimization omit
+#ifdef REGISTER_VM
+  return resumeVM();
+#else
+//< Optimization omit
 //> Calls and Functions end-interpret
   return run();
 //< Calls and Functions end-interpret
+//> Optimization omit
+#endif
+//< Optimization omit
 //< Compiling Expressions interpret-chunk
 }
 //< interpret
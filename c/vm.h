@@ -5,6 +5,10 @@
 /* A Virtual Machine vm-h < Calls and Functions vm-include-object
 #include "chunk.h"
 */
+//> Optimization omit
+#include <signal.h>
+
+//< Optimization omit
 //> Calls and Functions vm-include-object
 #include "object.h"
 //< Calls and Functions vm-include-object
@@ -21,9 +25,74 @@
 #define STACK_MAX 256
 */
 //> Calls and Functions frame-max
+/* Calls and Functions frame-max < Optimization omit
 #define FRAMES_MAX 64
 #define STACK_MAX (FRAMES_MAX * UINT8_COUNT)
+*/
+//> Optimization omit
+// How deep calls can go, unless the VM's maxFrames is set to something
+// else.
+#define FRAMES_MAX 10000
+//< Optimization omit
 //< Calls and Functions frame-max
+//> Optimization omit
+
+// The call stack and the value stack grow a segment at a time, and
+// segments are never moved, so pointers to frames and values stay valid.
+// FRAME_SEGMENT_SIZE is a power of two so that finding a frame's segment is
+// a shift. A function that needs more of the value stack than
+// STACK_SEGMENT_SIZE gets a segment of its own that big.
+#define FRAME_SEGMENT_SIZE 64
+#define STACK_SEGMENT_SIZE (FRAME_SEGMENT_SIZE * UINT8_COUNT)
+
+// Room a call needs past the values its function does for the ones the
+// runtime pushes for a moment, like the string allocateString() keeps from
+// being collected or the operands the register VM pushes for concatenate().
+#define STACK_HEADROOM 4
+
+// What a global variable's slot holds until the variable is defined. No
+// value the program can see is an object pointer to NULL.
+#define UNDEFINED_VAL OBJ_VAL(NULL)
+#define IS_UNDEFINED(value) (IS_OBJ(value) && AS_OBJ(value) == NULL)
+
+// The most global variables a program can have, since instructions name
+// them by a two-byte slot.
+#define GLOBALS_MAX (UINT16_MAX + 1)
+//< Optimization omit
+//> Optimization omit
+
+// Tier-up hooks, which the VM calls when code gets hot. Either can be NULL.
+//
+// A hot function hook can install an optimized variant of the function,
+// like its jitCode, which calls enter from then on.
+//
+// A hot loop hook is called at a back-edge, with the loop's frame on top of
+// the call stack and its ip at the loop header. It can run the rest of the
+// loop in optimized code, replacing the interpreter on the stack, and leave
+// the VM wherever that code stops. If it installs code in the loop, it is
+// called at every back-edge from then on, to enter it. Returns false if a
+// runtime error occurs. In register code, the frame's registerIp is at the
+// loop header instead.
+typedef void (*HotFunctionHook)(ObjFunction* function);
+typedef bool (*HotLoopHook)(Loop* loop);
+
+// What the VM does once the budget hook returns.
+typedef enum {
+  // Carry on. Until the hook sets a new budget, it is called again at
+  // every back-edge and call.
+  BUDGET_CONTINUE,
+  // Stop with a runtime error.
+  BUDGET_ABORT,
+  // Return INTERPRET_SUSPENDED, to carry on where it left off when
+  // resumeVM() is called.
+  BUDGET_SUSPEND
+} BudgetAction;
+
+typedef BudgetAction (*BudgetHook)();
+
+// The budget when there isn't one. It never runs out.
+#define NO_BUDGET INT64_MAX
+//< Optimization omit
 //> Calls and Functions call-frame
 
 typedef struct {
@@ -35,8 +104,34 @@ typedef struct {
 //< Closures call-frame-closure
   uint8_t* ip;
   Value* slots;
+//> Optimization omit
+#ifdef REGISTER_VM
+  // Where a frame running register code is, in place of ip.
+  Instruction* registerIp;
+#endif
+//< Optimization omit
 } CallFrame;
 //< Calls and Functions call-frame
+//> Optimization omit
+
+// A segment of the value stack. When a call doesn't have room for the
+// values it needs in the segment the top of the stack is in, its callee and
+// arguments are copied to the start of the next segment, and the call runs
+// there.
+typedef struct StackSegment {
+  struct StackSegment* previous;
+  // Where the callee was in the previous segment, which is where the call's
+  // result goes when it returns.
+  Value* callerTop;
+  Value* end;
+  // The open upvalue capturing each of the segment's values, or NULL.
+  ObjUpvalue** slotUpvalues;
+  // The segment's open upvalues while it isn't the one the top of the stack
+  // is in. They are in vm.openUpvalues while it is.
+  ObjUpvalue* openUpvalues;
+  Value values[];
+} StackSegment;
+//< Optimization omit
 
 typedef struct {
 /* A Virtual Machine vm-h < Calls and Functions frame-array
@@ -46,16 +141,51 @@ typedef struct {
   uint8_t* ip;
 */
 //> Calls and Functions frame-array
+/* Calls and Functions frame-array < Optimization omit
   CallFrame frames[FRAMES_MAX];
+*/
+//> Optimization omit
+  // Use FRAME_AT() to find a frame.
+  CallFrame** frameSegments;
+//< Optimization omit
   int frameCount;
+//> Optimization omit
+  // How many frames the segments have room for, up to maxFrames.
+  int frameCapacity;
+  // How deep calls can go before a stack overflow.
+  int maxFrames;
+//< Optimization omit
   
 //< Calls and Functions frame-array
 //> vm-stack
+/* A Virtual Machine vm-stack < Optimization omit
   Value stack[STACK_MAX];
+*/
+//> Optimization omit
+  // The bottom of the segment the top of the stack is in.
+  Value* stack;
+  // And where the segment ends.
+  Value* stackLimit;
+//< Optimization omit
   Value* stackTop;
 //< vm-stack
+//> Optimization omit
+  StackSegment* stackSegment;
+  // The last segment the stack shrank out of, kept to grow into again.
+  StackSegment* spareStackSegment;
+//< Optimization omit
 //> Global Variables vm-globals
+/* Global Variables vm-globals < Optimization omit
   Table globals;
+*/
+//> Optimization omit
+  // Global variables live in slots the compiler gives them the first time
+  // it sees their names. globalSlots maps each name to its slot, and
+  // globalNames and globalValues are indexed by slot.
+  Table globalSlots;
+  ValueArray globalNames;
+  ValueArray globalValues;
+//< Optimization omit
 //< Global Variables vm-globals
 //> Hash Tables vm-strings
   Table strings;
@@ -80,13 +210,49 @@ typedef struct {
   int grayCapacity;
   Obj** grayStack;
 //< Garbage Collection vm-gray-stack
+//> Optimization omit
+
+  // When functions and loops get hot, and what to do with them then.
+  // Changing the loop threshold only affects loops compiled afterwards.
+  unsigned int hotCallThreshold;
+  unsigned int hotLoopThreshold;
+  HotFunctionHook onHotFunction;
+  HotLoopHook onHotLoop;
+
+  // How many more loop back-edges and calls the VM runs before it calls
+  // onBudgetExhausted, or NO_BUDGET. Without a hook, running out is a
+  // runtime error. Compiled code spends it a whole trace iteration at a
+  // time and only resumes after calls, so it may call the hook a little
+  // later than the interpreter would.
+  int64_t budget;
+  BudgetHook onBudgetExhausted;
+
+  // Whether the interpreter prints the stack and each instruction before
+  // running it. It can be flipped at any time, even from a signal handler,
+  // and takes effect at the next call, return or back-edge. Code the JITs
+  // compiled runs untraced.
+  volatile sig_atomic_t traceExecution;
+
+  // Bumped whenever a method a call site may have cached could have
+  // changed, which empties every inline cache.
+  unsigned int methodEpoch;
+
+  // The name of each method selector, indexed by selector.
+  ValueArray selectors;
+//< Optimization omit
 } VM;
 
 //> interpret-result
 typedef enum {
   INTERPRET_OK,
   INTERPRET_COMPILE_ERROR,
+/* A Virtual Machine interpret-result < Optimization omit
   INTERPRET_RUNTIME_ERROR
+*/
+//> Optimization omit
+  INTERPRET_RUNTIME_ERROR,
+  INTERPRET_SUSPENDED
+//< Optimization omit
 } InterpretResult;
 
 //< interpret-result
@@ -94,6 +260,14 @@ typedef enum {
 extern VM vm;
 
 //< Strings extern-vm
+//> Optimization omit
+// The frame [index] calls deep in the call stack, where the script's frame
+// is zero.
+#define FRAME_AT(index) \
+    (&vm.frameSegments[(unsigned int)(index) / FRAME_SEGMENT_SIZE] \
+                      [(unsigned int)(index) % FRAME_SEGMENT_SIZE])
+
+//< Optimization omit
 void initVM();
 void freeVM();
 /* A Virtual Machine interpret-h < Scanning on Demand vm-interpret-h
@@ -102,9 +276,26 @@ InterpretResult interpret(Chunk* chunk);
 //> Scanning on Demand vm-interpret-h
 InterpretResult interpret(const char* source);
 //< Scanning on Demand vm-interpret-h
+//> Optimization omit
+// Carries on running the script the budget hook suspended. Interpreting
+// something else instead abandons it.
+InterpretResult resumeVM();
+//< Optimization omit
 //> push-pop
 void push(Value value);
 Value pop();
 //< push-pop
+//> Optimization omit
+int globalSlot(ObjString* name);
+
+// Defines a global variable [name] holding a native function. Calls have to
+// pass [arity] arguments, unless it is NATIVE_VARIADIC, and [function] gets
+// [context] with them. [flags] are the NativeFlags that hold for it.
+void defineNative(const char* name, NativeFn function, int arity,
+                  void* context, int flags);
+
+// Reports a runtime error from a native, which returns what this does.
+bool nativeError(const char* format, ...);
+//< Optimization omit
 
 #endif
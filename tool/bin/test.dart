@@ -12,6 +12,7 @@ final _expectedOutputPattern = RegExp(r"// expect: ?(.*)");
 final _expectedErrorPattern = RegExp(r"// (Error.*)");
 final _errorLinePattern = RegExp(r"// \[((java|c) )?line (\d+)\] (Error.*)");
 final _expectedRuntimeErrorPattern = RegExp(r"// expect runtime error: (.+)");
+final _argsPattern = RegExp(r"// args: (.+)");
 final _syntaxErrorPattern = RegExp(r"\[.*line (\d+)\] (Error.+)");
 final _stackTracePattern = RegExp(r"\[line (\d+)\]");
 final _nonTestPattern = RegExp(r"// nontest");
@@ -155,6 +156,9 @@ class Test {
 
   int _expectedExitCode = 0;
 
+  /// Command-line options the interpreter is run with, before the path.
+  final _args = <String>[];
+
   /// The list of failure message lines.
   final _failures = <String>[];
 
@@ -227,6 +231,12 @@ class Test {
         continue;
       }
 
+      match = _argsPattern.firstMatch(line);
+      if (match != null) {
+        _args.addAll(match[1].split(" "));
+        continue;
+      }
+
       match = _expectedRuntimeErrorPattern.firstMatch(line);
       if (match != null) {
         _runtimeErrorLine = lineNum;
@@ -250,7 +260,7 @@ class Test {
 
   /// Invoke the interpreter and run the test.
   List<String> run() {
-    var args = [..._interpreter.args, _path];
+    var args = [..._interpreter.args, ..._args, _path];
     var result = Process.runSync(_interpreter.executable, args);
 
     // Normalize Windows line endings.
@@ -380,7 +390,10 @@ class Test {
 
 void _defineTestSuites() {
   void c(String name, Map<String, String> tests) {
-    var executable = name == "clox" ? "build/cloxd" : "build/$name";
+    // The final clox suites run its debug builds.
+    var executable = name.startsWith("clox")
+        ? "build/cloxd${name.substring(4)}"
+        : "build/$name";
     _allSuites[name] = Interpreter(name, "c", executable, [], tests);
     _cSuites.add(name);
   }
@@ -413,6 +426,9 @@ void _defineTestSuites() {
 
     // Rely on JVM for stack overflow checking.
     "test/limit/stack_overflow.lox": "skip",
+
+    // Recurses deeper than the JVM's stack goes.
+    "test/closure/capture_from_deep_call.lox": "skip",
   };
 
   // No classes in Java yet.
@@ -421,8 +437,10 @@ void _defineTestSuites() {
     "test/call/object.lox": "skip",
     "test/class": "skip",
     "test/closure/close_over_method_parameter.lox": "skip",
+    "test/closure/copied_values.lox": "skip",
     "test/constructor": "skip",
     "test/field": "skip",
+    "test/function/reassigned_global.lox": "skip",
     "test/inheritance": "skip",
     "test/method": "skip",
     "test/number/decimal_point_at_eof.lox": "skip",
@@ -434,7 +452,9 @@ void _defineTestSuites() {
     "test/super": "skip",
     "test/this": "skip",
     "test/return/in_method.lox": "skip",
+    "test/return/tail_call.lox": "skip",
     "test/variable/local_from_method.lox": "skip",
+    "test/while/hot_loop_guards.lox": "skip",
   };
 
   // No functions in Java yet.
@@ -446,10 +466,13 @@ void _defineTestSuites() {
     "test/for/return_inside.lox": "skip",
     "test/for/syntax.lox": "skip",
     "test/function": "skip",
+    "test/operator/add_changing_types.lox": "skip",
     "test/operator/not.lox": "skip",
     "test/regression/40.lox": "skip",
     "test/return": "skip",
     "test/unexpected_character.lox": "skip",
+    "test/variable/copy_then_reassign.lox": "skip",
+    "test/variable/global_defined_after_use.lox": "skip",
     "test/while/closure_in_body.lox": "skip",
     "test/while/return_closure.lox": "skip",
     "test/while/return_inside.lox": "skip",
@@ -494,12 +517,15 @@ void _defineTestSuites() {
     "test/limit/too_many_constants.lox": "skip",
     "test/limit/too_many_locals.lox": "skip",
     "test/limit/too_many_upvalues.lox": "skip",
+    "test/operator/add_changing_types.lox": "skip",
     "test/regression/40.lox": "skip",
     "test/return": "skip",
     "test/unexpected_character.lox": "skip",
     "test/variable/collide_with_parameter.lox": "skip",
+    "test/variable/copy_then_reassign.lox": "skip",
     "test/variable/duplicate_parameter.lox": "skip",
     "test/variable/early_bound.lox": "skip",
+    "test/variable/global_defined_after_use.lox": "skip",
     "test/while/closure_in_body.lox": "skip",
     "test/while/return_closure.lox": "skip",
     "test/while/return_inside.lox": "skip",
@@ -511,8 +537,10 @@ void _defineTestSuites() {
     "test/call/object.lox": "skip",
     "test/class": "skip",
     "test/closure/close_over_method_parameter.lox": "skip",
+    "test/closure/copied_values.lox": "skip",
     "test/constructor": "skip",
     "test/field": "skip",
+    "test/function/reassigned_global.lox": "skip",
     "test/inheritance": "skip",
     "test/method": "skip",
     "test/number/decimal_point_at_eof.lox": "skip",
@@ -526,6 +554,7 @@ void _defineTestSuites() {
     "test/super": "skip",
     "test/this": "skip",
     "test/variable/local_from_method.lox": "skip",
+    "test/while/hot_loop_guards.lox": "skip",
   };
 
   // No inheritance in C yet.
@@ -535,13 +564,31 @@ void _defineTestSuites() {
     "test/class/inherit_self.lox": "skip",
     "test/class/inherited_method.lox": "skip",
     "test/inheritance": "skip",
+    "test/method/accessors.lox": "skip",
+    "test/method/polymorphic_call_site.lox": "skip",
     "test/regression/394.lox": "skip",
     "test/super": "skip",
   };
 
+  // The book's chapters don't have these optimizations.
+  var noCOptimizations = {
+    "test/closure/capture_from_deep_call.lox": "skip",
+    "test/function/deep_recursion.lox": "skip",
+    "test/function/native_arity.lox": "skip",
+    "test/return/tail_call.lox": "skip",
+  };
+
+  // Command-line options only clox has.
+  var cloxOptions = {
+    "test/budget": "skip",
+    "test/trace": "skip",
+    "test/tier_up": "skip",
+  };
+
   java("jlox", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
   });
@@ -569,6 +616,7 @@ void _defineTestSuites() {
   java("chap08_statements", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
     ...noJavaFunctions,
@@ -587,6 +635,7 @@ void _defineTestSuites() {
   java("chap09_control", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
     ...noJavaFunctions,
@@ -597,6 +646,7 @@ void _defineTestSuites() {
   java("chap10_functions", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
     ...noJavaResolution,
@@ -606,6 +656,7 @@ void _defineTestSuites() {
   java("chap11_resolving", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
     ...noJavaClasses,
@@ -614,6 +665,7 @@ void _defineTestSuites() {
   java("chap12_classes", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...noJavaLimits,
     ...javaNaNEquality,
 
@@ -623,6 +675,8 @@ void _defineTestSuites() {
     "test/class/inherit_self.lox": "skip",
     "test/class/inherited_method.lox": "skip",
     "test/inheritance": "skip",
+    "test/method/accessors.lox": "skip",
+    "test/method/polymorphic_call_site.lox": "skip",
     "test/regression/394.lox": "skip",
     "test/super": "skip",
   });
@@ -630,6 +684,7 @@ void _defineTestSuites() {
   java("chap13_inheritance", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
     ...javaNaNEquality,
     ...noJavaLimits,
   });
@@ -639,6 +694,14 @@ void _defineTestSuites() {
     ...earlyChapters,
   });
 
+  c("clox_register", {
+    "test": "pass",
+    ...earlyChapters,
+
+    // Traces register instructions, not the stack VM's bytecode.
+    "test/trace": "skip",
+  });
+
   c("chap17_compiling", {
     // No real interpreter yet.
     "test": "skip",
@@ -666,6 +729,8 @@ void _defineTestSuites() {
   c("chap21_global", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCControlFlow,
     ...noCFunctions,
     ...noCClasses,
@@ -689,6 +754,8 @@ void _defineTestSuites() {
   c("chap22_local", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCControlFlow,
     ...noCFunctions,
     ...noCClasses,
@@ -697,6 +764,8 @@ void _defineTestSuites() {
   c("chap23_jumping", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCFunctions,
     ...noCClasses,
   });
@@ -704,6 +773,8 @@ void _defineTestSuites() {
   c("chap24_calls", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCClasses,
 
     // No closures.
@@ -713,6 +784,7 @@ void _defineTestSuites() {
     "test/function/local_recursion.lox": "skip",
     "test/limit/too_many_upvalues.lox": "skip",
     "test/regression/40.lox": "skip",
+    "test/variable/copy_then_reassign.lox": "skip",
     "test/while/closure_in_body.lox": "skip",
     "test/while/return_closure.lox": "skip",
   });
@@ -720,18 +792,24 @@ void _defineTestSuites() {
   c("chap25_closures", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCClasses,
   });
 
   c("chap26_garbage", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCClasses,
   });
 
   c("chap27_classes", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCInheritance,
 
     // No methods.
@@ -739,31 +817,43 @@ void _defineTestSuites() {
     "test/class/local_reference_self.lox": "skip",
     "test/class/reference_self.lox": "skip",
     "test/closure/close_over_method_parameter.lox": "skip",
+    "test/closure/copied_values.lox": "skip",
     "test/constructor": "skip",
     "test/field/get_and_set_method.lox": "skip",
+    "test/field/get_field_then_method.lox": "skip",
     "test/field/method.lox": "skip",
     "test/field/method_binds_this.lox": "skip",
+    "test/field/presized_instances.lox": "skip",
+    "test/field/shadow_method_after_call.lox": "skip",
+    "test/function/reassigned_global.lox": "skip",
     "test/method": "skip",
     "test/operator/equals_class.lox": "skip",
     "test/operator/equals_method.lox": "skip",
     "test/return/in_method.lox": "skip",
     "test/this": "skip",
     "test/variable/local_from_method.lox": "skip",
+    "test/while/hot_loop_guards.lox": "skip",
   });
 
   c("chap28_methods", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
     ...noCInheritance,
   });
 
   c("chap29_superclasses", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
   });
 
   c("chap30_optimization", {
     "test": "pass",
     ...earlyChapters,
+    ...cloxOptions,
+    ...noCOptimizations,
   });
 }
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# Runs the benchmarks in test/benchmark against one or more builds of an
+# interpreter and reports the best time of several trials for each.
+#
+# Usage: util/benchmark.py [--trials N] [--filter NAME] <interpreter>...
+#
+# Each benchmark prints the elapsed time it measured as its last line of
+# output, so we use that instead of timing the whole process. That keeps
+# startup and compile time out of the numbers. When given more than one
+# interpreter, each time is also shown relative to the first one.
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+BENCHMARK_DIR = os.path.join(
+    os.path.dirname(os.path.realpath(__file__)), "..", "test", "benchmark")
+
+
+def run_trial(interpreter, path):
+  result = subprocess.run([interpreter, path], stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE, universal_newlines=True)
+  if result.returncode != 0:
+    return None
+
+  lines = result.stdout.strip().split("\n")
+  try:
+    return float(lines[-1])
+  except ValueError:
+    return None
+
+
+def run_benchmark(interpreter, path, trials):
+  best = None
+  for _ in range(trials):
+    elapsed = run_trial(interpreter, path)
+    if elapsed is None: return None
+    if best is None or elapsed < best: best = elapsed
+  return best
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument("interpreters", nargs="+")
+  parser.add_argument("--trials", type=int, default=5)
+  parser.add_argument("--filter", default="")
+  args = parser.parse_args()
+
+  paths = sorted(glob.glob(os.path.join(BENCHMARK_DIR, "*.lox")))
+  paths = [path for path in paths if args.filter in os.path.basename(path)]
+
+  names = [os.path.basename(interpreter) for interpreter in args.interpreters]
+  width = max(16, max(len(name) for name in names) + 2)
+
+  print("{:<20}".format("benchmark") +
+        "".join("{:>{}}".format(name, width) for name in names))
+
+  for path in paths:
+    benchmark = os.path.splitext(os.path.basename(path))[0]
+    sys.stdout.write("{:<20}".format(benchmark))
+    sys.stdout.flush()
+
+    baseline = None
+    for interpreter in args.interpreters:
+      elapsed = run_benchmark(interpreter, path, args.trials)
+      if elapsed is None:
+        cell = "error"
+      elif baseline is None:
+        baseline = elapsed
+        cell = "{:.3f}s".format(elapsed)
+      else:
+        cell = "{:.3f}s {:>4.0f}%".format(elapsed, 100 * elapsed / baseline)
+
+      sys.stdout.write("{:>{}}".format(cell, width))
+      sys.stdout.flush()
+
+    print()
+
+
+if __name__ == "__main__":
+  main()